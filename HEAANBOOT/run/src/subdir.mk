@@ -7,17 +7,31 @@ CPP_SRCS += \
 ../src/BootContext.cpp \
 ../src/Ciphertext.cpp \
 ../src/Context.cpp \
+../src/EncryptionPool.cpp \
 ../src/EvaluatorUtils.cpp \
+../src/FftPlan.cpp \
+../src/FlatPoly.cpp \
 ../src/HEAAN.cpp \
 ../src/Key.cpp \
 ../src/NumUtils.cpp \
 ../src/Plaintext.cpp \
+../src/RNSCiphertext.cpp \
+../src/RNSContext.cpp \
+../src/RNSKey.cpp \
+../src/RNSPlaintext.cpp \
+../src/RNSScheme.cpp \
 ../src/Ring2Utils.cpp \
+../src/RingMultiplier.cpp \
+../src/RotationKeyStore.cpp \
+../src/RotationPlan.cpp \
+../src/Sampler.cpp \
 ../src/Scheme.cpp \
 ../src/SchemeAlgo.cpp \
 ../src/SecretKey.cpp \
 ../src/SerializationUtils.cpp \
+../src/SmallPoly.cpp \
 ../src/StringUtils.cpp \
+../src/TernaryPoly.cpp \
 ../src/TestScheme.cpp \
 ../src/TimeUtils.cpp 
 
@@ -25,17 +39,31 @@ OBJS += \
 ./src/BootContext.o \
 ./src/Ciphertext.o \
 ./src/Context.o \
+./src/EncryptionPool.o \
 ./src/EvaluatorUtils.o \
+./src/FftPlan.o \
+./src/FlatPoly.o \
 ./src/HEAAN.o \
 ./src/Key.o \
 ./src/NumUtils.o \
 ./src/Plaintext.o \
+./src/RNSCiphertext.o \
+./src/RNSContext.o \
+./src/RNSKey.o \
+./src/RNSPlaintext.o \
+./src/RNSScheme.o \
 ./src/Ring2Utils.o \
+./src/RingMultiplier.o \
+./src/RotationKeyStore.o \
+./src/RotationPlan.o \
+./src/Sampler.o \
 ./src/Scheme.o \
 ./src/SchemeAlgo.o \
 ./src/SecretKey.o \
 ./src/SerializationUtils.o \
+./src/SmallPoly.o \
 ./src/StringUtils.o \
+./src/TernaryPoly.o \
 ./src/TestScheme.o \
 ./src/TimeUtils.o 
 
@@ -43,17 +71,31 @@ CPP_DEPS += \
 ./src/BootContext.d \
 ./src/Ciphertext.d \
 ./src/Context.d \
+./src/EncryptionPool.d \
 ./src/EvaluatorUtils.d \
+./src/FftPlan.d \
+./src/FlatPoly.d \
 ./src/HEAAN.d \
 ./src/Key.d \
 ./src/NumUtils.d \
 ./src/Plaintext.d \
+./src/RNSCiphertext.d \
+./src/RNSContext.d \
+./src/RNSKey.d \
+./src/RNSPlaintext.d \
+./src/RNSScheme.d \
 ./src/Ring2Utils.d \
+./src/RingMultiplier.d \
+./src/RotationKeyStore.d \
+./src/RotationPlan.d \
+./src/Sampler.d \
 ./src/Scheme.d \
 ./src/SchemeAlgo.d \
 ./src/SecretKey.d \
 ./src/SerializationUtils.d \
+./src/SmallPoly.d \
 ./src/StringUtils.d \
+./src/TernaryPoly.d \
 ./src/TestScheme.d \
 ./src/TimeUtils.d 
 
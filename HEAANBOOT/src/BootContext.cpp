@@ -7,4 +7,4 @@
 */
 #include "BootContext.h"
 
-BootContext::BootContext(ZZX* pvec, ZZX* pvecInv, ZZX p1, ZZX p2, long logp) : pvec(pvec), pvecInv(pvecInv), p1(p1), p2(p2), logp(logp) {}
+BootContext::BootContext(SmallPoly* pvec, SmallPoly* pvecInv, SmallPoly p1, SmallPoly p2, long logp) : pvec(pvec), pvecInv(pvecInv), p1(p1), p2(p2), logp(logp) {}
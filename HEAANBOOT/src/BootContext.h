@@ -10,21 +10,23 @@
 
 #include <NTL/ZZX.h>
 
+#include "SmallPoly.h"
+
 using namespace NTL;
 
 class BootContext {
 
 public:
 
-	ZZX* pvec; ///< encodings of "diagonal" values of CoeffToSlot matrix
-	ZZX* pvecInv; ///< encodings of "diagonal" values of SlotToCoeff matrix
+	SmallPoly* pvec; ///< encodings of "diagonal" values of CoeffToSlot matrix
+	SmallPoly* pvecInv; ///< encodings of "diagonal" values of SlotToCoeff matrix
 
-	ZZX p1; ///< auxiliary encoding for EvalExp
-	ZZX p2; ///< auxiliary encoding for EvalExp
+	SmallPoly p1; ///< auxiliary encoding for EvalExp
+	SmallPoly p2; ///< auxiliary encoding for EvalExp
 
 	long logp; ///< number of quantized bits
 
-	BootContext(ZZX* pvec = NULL, ZZX* pvecInv = NULL, ZZX p1 = ZZX::zero(), ZZX p2 = ZZX::zero(), long logp = 0);
+	BootContext(SmallPoly* pvec = NULL, SmallPoly* pvecInv = NULL, SmallPoly p1 = SmallPoly(), SmallPoly p2 = SmallPoly(), long logp = 0);
 
 };
 
@@ -6,3 +6,10 @@
 * work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
 */
 #include "Ciphertext.h"
+
+bool Ciphertext::hasValidSeed() {
+	if(!isSeeded) return false;
+	FlatPoly expanded;
+	NumUtils::sampleUniform2(expanded, seed, bx.N, logq);
+	return expanded == ax;
+}
@@ -10,6 +10,11 @@
 
 #include <NTL/ZZ.h>
 #include <NTL/ZZX.h>
+#include <algorithm>
+#include <utility>
+
+#include "FlatPoly.h"
+#include "NumUtils.h"
 
 using namespace std;
 using namespace NTL;
@@ -20,8 +25,8 @@ using namespace NTL;
 class Ciphertext {
 public:
 
-	ZZX ax; ///< Ciphertext is an RLWE instance (ax, bx = mx + ex - ax * sx) in ring Z_q[X] / (X^N + 1);
-	ZZX bx; ///< Ciphertext is an RLWE instance (ax, bx = mx + ex - ax * sx) in ring Z_q[X] / (X^N + 1);
+	FlatPoly ax; ///< Ciphertext is an RLWE instance (ax, bx = mx + ex - ax * sx) in ring Z_q[X] / (X^N + 1);
+	FlatPoly bx; ///< Ciphertext is an RLWE instance (ax, bx = mx + ex - ax * sx) in ring Z_q[X] / (X^N + 1);
 
 	long logp; ///< number of quantized bits
 	long logq; ///< number of bits in modulus
@@ -29,23 +34,42 @@ public:
 
 	bool isComplex; ///< option of Ciphertext with single real slot
 
+	bool isSeeded; ///< ax was expanded from seed (see Scheme::encryptSymmetric), so it can be serialized as seed
+	unsigned char seed[SEED_BYTES]; ///< seed of ax if isSeeded
+
 	//-----------------------------------------
 
 	/**
 	 * Ciphertext = (ax, bx = mx + ex - ax * sx) for secret key sx and error ex
-	 * @param[in] ax: ZZX polynomial
-	 * @param[in] bx: ZZX polynomial
+	 * @param[in] ax: polynomial with coefficients in [0, 2^logq)
+	 * @param[in] bx: polynomial with coefficients in [0, 2^logq)
 	 * @param[in] logp: number of quantized bits
 	 * @param[in] logq: number of bits in modulus
 	 * @param[in] slots: number of slots in a ciphertext
 	 * @param[in] isComplex: option of Ciphertext with single real slot
 	 */
-	Ciphertext(ZZX ax = ZZX::zero(), ZZX bx = ZZX::zero(), long logp = 0, long logq = 0, long slots = 1, bool isComplex = true) : ax(ax), bx(bx), logp(logp), logq(logq), slots(slots), isComplex(isComplex) {}
+	Ciphertext(FlatPoly ax = FlatPoly(), FlatPoly bx = FlatPoly(), long logp = 0, long logq = 0, long slots = 1, bool isComplex = true) : ax(move(ax)), bx(move(bx)), logp(logp), logq(logq), slots(slots), isComplex(isComplex), isSeeded(false) {}
 
 	/**
 	 * Copy Constructor
 	 */
-	Ciphertext(const Ciphertext& o) : ax(o.ax), bx(o.bx), logp(o.logp), logq(o.logq), slots(o.slots), isComplex(o.isComplex) {}
+	Ciphertext(const Ciphertext& o) : ax(o.ax), bx(o.bx), logp(o.logp), logq(o.logq), slots(o.slots), isComplex(o.isComplex), isSeeded(o.isSeeded) {
+		copy(o.seed, o.seed + SEED_BYTES, seed);
+	}
+
+	/**
+	 * marks ax as expanded from seed by NumUtils::sampleUniform2
+	 * @param[in] seed: SEED_BYTES bytes
+	 */
+	void setSeed(const unsigned char* seed) {
+		isSeeded = true;
+		copy(seed, seed + SEED_BYTES, this->seed);
+	}
+
+	/**
+	 * @return true if seed is set and ax is still its expansion mod 2^logq
+	 */
+	bool hasValidSeed();
 
 };
 
@@ -6,16 +6,21 @@
 * work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
 */
 #include "Context.h"
+
+#include <NTL/BasicThreadPool.h>
 #include "Ring2Utils.h"
 #include "EvaluatorUtils.h"
 
 #include "StringUtils.h"
 
-Context::Context(long logN, long logQ, double sigma, long h) : logN(logN), logQ(logQ), sigma(sigma), h(h) {
+Context::Context(long logN, long logQ, double sigma, long h, long dnum) : logN(logN), logQ(logQ), sigma(sigma), h(h), dnum(dnum) {
+	if(dnum < 1 || dnum > logQ) {
+		throw invalid_argument("dnum must be in [1, logQ]");
+	}
 	init(logN, logQ, sigma, h);
 }
 
-Context::Context(const Context& o) : logN(o.logN), logQ(o.logQ), sigma(o.sigma), h(o.h) {
+Context::Context(const Context& o) : logN(o.logN), logQ(o.logQ), sigma(o.sigma), h(o.h), dnum(o.dnum) {
 	init(logN, logQ, sigma, h);
 }
 
@@ -25,6 +30,8 @@ void Context::init(long logN, long logQ, double sigma, long h) {
 	logNh = logN - 1;
 	M = N << 1;
 	logQQ = logQ << 1;
+	logP = (logQ + dnum - 1) / dnum;
+	logQP = logQ + logP;
 	Q = power2_ZZ(logQ);
 	QQ = power2_ZZ(logQQ);
 
@@ -59,6 +66,12 @@ void Context::init(long logN, long logQ, double sigma, long h) {
 Context::~Context() {
 	delete[] rotGroup;
 	delete[] ksiPows;
+	for (auto& element : inpowerMap) {
+		delete[] element.second;
+	}
+	for (auto& element : fftPlanMap) {
+		delete element.second;
+	}
 }
 
 
@@ -121,6 +134,33 @@ ZZX Context::encodeSingle(double val, long logp) {
 	return mx;
 }
 
+void Context::encode(FlatPoly& mx, complex<double>* vals, long slots, long logp, long logq) {
+	complex<double>* uvals = new complex<double>[slots];
+	copy(vals, vals + slots, uvals);
+	fftSpecialInv(uvals, slots);
+	encodeTransformed(mx, uvals, slots, logp, logq);
+	delete[] uvals;
+}
+
+void Context::encode(FlatPoly& mx, double* vals, long slots, long logp, long logq) {
+	complex<double>* uvals = new complex<double>[slots];
+	for (long i = 0; i < slots; ++i) {
+		uvals[i].real(vals[i]);
+	}
+	fftSpecialInv(uvals, slots);
+	encodeTransformed(mx, uvals, slots, logp, logq);
+	delete[] uvals;
+}
+
+void Context::encodeTransformed(FlatPoly& mx, complex<double>* uvals, long slots, long logp, long logq) {
+	long gap = Nh / slots;
+	mx.reshape(N, limbsFor(logq));
+	fill(mx.words, mx.words + N * mx.limbs, 0);
+	EvaluatorUtils::scaleUpToFlat(mx, 0, gap, (double*) uvals, 2, slots, logp);
+	EvaluatorUtils::scaleUpToFlat(mx, Nh, gap, (double*) uvals + 1, 2, slots, logp);
+	Ring2Utils::modAndEqual(mx, logq, N);
+}
+
 complex<double>* Context::decode(ZZX& mx, long slots, long logp, long logq) {
 	ZZ q = qpowvec[logq];
 	long gap = Nh / slots;
@@ -164,42 +204,91 @@ void Context::addBootContext(long logSlots, long logp) {
 		long logk = logSlots >> 1;
 
 		long k = 1 << logk;
-		long i, pos,  ki, jdx, idx, deg;
 		long gap = Nh >> logSlots;
+		long dgap = gap >> 1;
 
-		ZZX* pvecInv = new ZZX[slots];
-		ZZX* pvec = new ZZX[slots];
+		SmallPoly* pvec = new SmallPoly[slots];
+		SmallPoly* pvecInv = new SmallPoly[slots];
 
+		mutex progressLock;
+		long done = 0;
+
+		NTL_EXEC_RANGE(slots, first, last);
+		// per-thread scratch, coefficients are always written at the same indexes
 		complex<double>* pvals = new complex<double>[dslots];
+		ZZX mx, mxInv;
+		mx.SetLength(N);
+		mxInv.SetLength(N);
+		for (long pos = first; pos < last; ++pos) {
+			long ki = pos - pos % k;
+			long i, idx, jdx, deg;
+			if(logSlots < logNh) {
+				for (i = 0; i < slots - pos; ++i) {
+					deg = ((M - rotGroup[i + pos]) * i * gap) % M;
+					pvals[i] = ksiPows[deg];
+					pvals[i + slots].real(-pvals[i].imag());
+					pvals[i + slots].imag(pvals[i].real());
+				}
+				for (i = slots - pos; i < slots; ++i) {
+					deg =((M - rotGroup[i + pos - slots]) * i * gap) % M;
+					pvals[i] = ksiPows[deg];
+					pvals[i + slots].real(-pvals[i].imag());
+					pvals[i + slots].imag(pvals[i].real());
+				}
+				EvaluatorUtils::rightRotateAndEqual(pvals, dslots, ki);
+				fftSpecialInv(pvals, dslots);
+				for (i = 0, jdx = Nh, idx = 0; i < dslots; ++i, jdx += dgap, idx += dgap) {
+					mx.rep[idx] = EvaluatorUtils::scaleUpToZZ(pvals[i].real(), logp);
+					mx.rep[jdx] = EvaluatorUtils::scaleUpToZZ(pvals[i].imag(), logp);
+				}
+			} else {
+				for (i = 0; i < slots - pos; ++i) {
+					deg = ((M - rotGroup[i + pos]) * i * gap) % M;
+					pvals[i] = ksiPows[deg];
+				}
+				for (i = slots - pos; i < slots; ++i) {
+					deg =((M - rotGroup[i + pos - slots]) * i * gap) % M;
+					pvals[i] = ksiPows[deg];
+				}
+				EvaluatorUtils::rightRotateAndEqual(pvals, slots, ki);
+				fftSpecialInv(pvals, slots);
+				for (i = 0, jdx = Nh, idx = 0; i < slots; ++i, jdx += gap, idx += gap) {
+					mx.rep[idx] = EvaluatorUtils::scaleUpToZZ(pvals[i].real(), logp);
+					mx.rep[jdx] = EvaluatorUtils::scaleUpToZZ(pvals[i].imag(), logp);
+				}
+			}
+			pvec[pos] = SmallPoly(mx, N);
+
+			for (i = 0; i < slots - pos; ++i) {
+				deg = (rotGroup[i] * (i + pos) * gap) % M;
+				pvals[i] = ksiPows[deg];
+			}
+			for (i = slots - pos; i < slots; ++i) {
+				deg = (rotGroup[i] * (i + pos - slots) * gap) % M;
+				pvals[i] = ksiPows[deg];
+			}
+			EvaluatorUtils::rightRotateAndEqual(pvals, slots, ki);
+			fftSpecialInv(pvals, slots);
+			for (i = 0, jdx = Nh, idx = 0; i < slots; ++i, jdx += gap, idx += gap) {
+				mxInv.rep[idx] = EvaluatorUtils::scaleUpToZZ(pvals[i].real(), logp);
+				mxInv.rep[jdx] = EvaluatorUtils::scaleUpToZZ(pvals[i].imag(), logp);
+			}
+			pvecInv[pos] = SmallPoly(mxInv, N);
+
+			if(bootContextProgress) {
+				lock_guard<mutex> guard(progressLock);
+				bootContextProgress(++done, slots);
+			}
+		}
+		delete[] pvals;
+		NTL_EXEC_RANGE_END;
 
 		ZZX p1, p2;
 		double c = 0.25/M_PI;
 
 		if(logSlots < logNh) {
-			long dgap = gap >> 1;
-			for (ki = 0; ki < slots; ki += k) {
-				for (pos = ki; pos < ki + k; ++pos) {
-					for (i = 0; i < slots - pos; ++i) {
-						deg = ((M - rotGroup[i + pos]) * i * gap) % M;
-						pvals[i] = ksiPows[deg];
-						pvals[i + slots].real(-pvals[i].imag());
-						pvals[i + slots].imag(pvals[i].real());
-					}
-					for (i = slots - pos; i < slots; ++i) {
-						deg =((M - rotGroup[i + pos - slots]) * i * gap) % M;
-						pvals[i] = ksiPows[deg];
-						pvals[i + slots].real(-pvals[i].imag());
-						pvals[i + slots].imag(pvals[i].real());
-					}
-					EvaluatorUtils::rightRotateAndEqual(pvals, dslots, ki);
-					fftSpecialInv(pvals, dslots);
-					pvec[pos].SetLength(N);
-					for (i = 0, jdx = Nh, idx = 0; i < dslots; ++i, jdx += dgap, idx += dgap) {
-						pvec[pos].rep[idx] = EvaluatorUtils::scaleUpToZZ(pvals[i].real(), logp);
-						pvec[pos].rep[jdx] = EvaluatorUtils::scaleUpToZZ(pvals[i].imag(), logp);
-					}
-				}
-			}
+			long i, idx, jdx;
+			complex<double>* pvals = new complex<double>[dslots];
 			for (i = 0; i < slots; ++i) {
 				pvals[i] = 0.0;
 				pvals[i + slots].real(0);
@@ -223,52 +312,38 @@ void Context::addBootContext(long logSlots, long logp) {
 				p2.rep[idx] = EvaluatorUtils::scaleUpToZZ(pvals[i].real(), logp);
 				p2.rep[jdx] = EvaluatorUtils::scaleUpToZZ(pvals[i].imag(), logp);
 			}
-		} else {
-			for (ki = 0; ki < slots; ki += k) {
-				for (pos = ki; pos < ki + k; ++pos) {
-					for (i = 0; i < slots - pos; ++i) {
-						deg = ((M - rotGroup[i + pos]) * i * gap) % M;
-						pvals[i] = ksiPows[deg];
-					}
-					for (i = slots - pos; i < slots; ++i) {
-						deg =((M - rotGroup[i + pos - slots]) * i * gap) % M;
-						pvals[i] = ksiPows[deg];
-					}
-					EvaluatorUtils::rightRotateAndEqual(pvals, slots, ki);
-					fftSpecialInv(pvals, slots);
-					pvec[pos].SetLength(N);
-					for (i = 0, jdx = Nh, idx = 0; i < slots; ++i, jdx += gap, idx += gap) {
-						pvec[pos].rep[idx] = EvaluatorUtils::scaleUpToZZ(pvals[i].real(), logp);
-						pvec[pos].rep[jdx] = EvaluatorUtils::scaleUpToZZ(pvals[i].imag(), logp);
-					}
-				}
-			}
+			delete[] pvals;
 		}
 
-		for (ki = 0; ki < slots; ki += k) {
-			for (pos = ki; pos < ki + k; ++pos) {
+		bootContextMap.insert(pair<long, BootContext>(logSlots, BootContext(pvec, pvecInv, SmallPoly(p1, N), SmallPoly(p2, N), logp)));
+	}
+}
 
-				for (i = 0; i < slots - pos; ++i) {
-					deg = (rotGroup[i] * (i + pos) * gap) % M;
-					pvals[i] = ksiPows[deg];
-				}
-				for (i = slots - pos; i < slots; ++i) {
-					deg = (rotGroup[i] * (i + pos - slots) * gap) % M;
-					pvals[i] = ksiPows[deg];
-				}
-				EvaluatorUtils::rightRotateAndEqual(pvals, slots, ki);
-				fftSpecialInv(pvals, slots);
-				pvecInv[pos].SetLength(N);
-				for (i = 0, jdx = Nh, idx = 0; i < slots; ++i, jdx += gap, idx += gap) {
-					pvecInv[pos].rep[idx] = EvaluatorUtils::scaleUpToZZ(pvals[i].real(), logp);
-					pvecInv[pos].rep[jdx] = EvaluatorUtils::scaleUpToZZ(pvals[i].imag(), logp);
-				}
+long* Context::getInpowerTable(long pow) {
+	lock_guard<mutex> guard(inpowerLock);
+	auto it = inpowerMap.find(pow);
+	if(it == inpowerMap.end()) {
+		long* table = new long[N];
+		for (long i = 0; i < N; ++i) {
+			long shift = (i * pow) % M;
+			if(shift < N) {
+				table[shift] = i;
+			} else {
+				table[shift - N] = ~i;
 			}
 		}
+		it = inpowerMap.insert(pair<long, long*>(pow, table)).first;
+	}
+	return it->second;
+}
 
-		delete[] pvals;
-		bootContextMap.insert(pair<long, BootContext>(logSlots, BootContext(pvec, pvecInv, p1, p2, logp)));
+const FftPlan& Context::getFftPlan(long size) {
+	lock_guard<mutex> guard(fftPlanLock);
+	auto it = fftPlanMap.find(size);
+	if(it == fftPlanMap.end()) {
+		it = fftPlanMap.insert(pair<long, FftPlan*>(size, new FftPlan(size, M, rotGroup, ksiPows))).first;
 	}
+	return *it->second;
 }
 
 //----------------------------------------------------------------------------------
@@ -333,44 +408,13 @@ void Context::fftInv(complex<double>* vals, const long size) {
 }
 
 void Context::fftSpecial(complex<double>* vals, const long size) {
-	bitReverse(vals, size);
-	for (long len = 2; len <= size; len <<= 1) {
-		for (long i = 0; i < size; i += len) {
-			long lenh = len >> 1;
-			long lenq = len << 2;
-			for (long j = 0; j < lenh; ++j) {
-				long idx = ((rotGroup[j] % lenq)) * M / lenq;
-				complex<double> u = vals[i + j];
-				complex<double> v = vals[i + j + lenh];
-				v *= ksiPows[idx];
-				vals[i + j] = u + v;
-				vals[i + j + lenh] = u - v;
-			}
-		}
-	}
+	getFftPlan(size).special(vals);
 }
 
 void Context::fftSpecialInvLazy(complex<double>* vals, const long size) {
-	for (long len = size; len >= 1; len >>= 1) {
-		for (long i = 0; i < size; i += len) {
-			long lenh = len >> 1;
-			long lenq = len << 2;
-			for (long j = 0; j < lenh; ++j) {
-				long idx = (lenq - (rotGroup[j] % lenq)) * M / lenq;
-				complex<double> u = vals[i + j] + vals[i + j + lenh];
-				complex<double> v = vals[i + j] - vals[i + j + lenh];
-				v *= ksiPows[idx];
-				vals[i + j] = u;
-				vals[i + j + lenh] = v;
-			}
-		}
-	}
-	bitReverse(vals, size);
+	getFftPlan(size).specialInv(vals, 1.0);
 }
 
 void Context::fftSpecialInv(complex<double>* vals, const long size) {
-	fftSpecialInvLazy(vals, size);
-	for (long i = 0; i < size; ++i) {
-		vals[i] /= size;
-	}
+	getFftPlan(size).specialInv(vals, 1.0 / size);
 }
@@ -11,9 +11,13 @@
 #include <NTL/ZZ.h>
 #include <NTL/RR.h>
 #include <complex>
+#include <functional>
+#include <mutex>
 
 #include "BootContext.h"
 #include "Common.h"
+#include "FftPlan.h"
+#include "FlatPoly.h"
 
 using namespace std;
 using namespace NTL;
@@ -31,15 +35,18 @@ public:
 	long logQ; ///< log of Q
 	double sigma; ///< standard deviation for Gaussian distribution
 	long h; ///< parameter for HWT distribution
+	long dnum; ///< number of digits of ciphertexts in key switching
 
 	long N; ///< N is a power-of-two that corresponds to the ring Z[X]/(X^N + 1)
 	long Nh; ///< Nh = N/2
 	long logNh; ///< logNh = logN - 1
 	long M; ///< M = 2N
-	long logQQ; ///< log of PQ
+	long logQQ; ///< log of Q * Q, modulus of encryption key
+	long logP; ///< log of special modulus P of key switching, logQ / dnum rounded up
+	long logQP; ///< log of PQ, modulus of switching keys
 
 	ZZ Q; ///< Q corresponds to the highest modulus
-	ZZ QQ; ///< PQ = Q * Q
+	ZZ QQ; ///< Q * Q
 
 	long* rotGroup; ///< precomputed rotation group indexes
 	complex<double>* ksiPows; ///< precomputed ksi powers
@@ -48,8 +55,19 @@ public:
 	map<string, double*> taylorCoeffsMap; ///< precomputed taylor coefficients
 
 	map<long, BootContext> bootContextMap; ///< precomputed bootstrapping auxiliary information
+	function<void(long done, long total)> bootContextProgress; ///< if set, called by addBootContext after each pair of encoded diagonals
 
-	Context(long logN, long logQ, double sigma = 3.2, long h = 64);
+	map<long, long*> inpowerMap; ///< precomputed tables of automorphisms X -> X^pow, built on first use
+	mutex inpowerLock; ///< guards inpowerMap
+
+	map<long, FftPlan*> fftPlanMap; ///< precomputed special fft plans by size, built on first use
+	mutex fftPlanLock; ///< guards fftPlanMap
+
+	/**
+	 * @param[in] dnum: key switching splits ax into dnum digits of logP bits, each with its own key part;
+	 * 1 gives P = Q, larger values give smaller P and operands at the cost of dnum times the key size
+	 */
+	Context(long logN, long logQ, double sigma = 3.2, long h = 64, long dnum = 1);
 
 	Context(const Context& o);
 
@@ -93,6 +111,36 @@ public:
 	 */
 	ZZX encodeSingle(double val, long logp);
 
+	/**
+	 * encoding of values directly into words of polynomial, without ZZ coefficients
+	 * @param[out] mx: polynomial with coefficients mod 2^logq
+	 * @param[in] vals: array of values
+	 * @param[in] slots: size of array
+	 * @param[in] logp: number of quantized bits
+	 * @param[in] logq: number of modulus bits
+	 */
+	void encode(FlatPoly& mx, complex<double>* vals, long slots, long logp, long logq);
+
+	/**
+	 * encoding of values directly into words of polynomial, without ZZ coefficients
+	 * @param[out] mx: polynomial with coefficients mod 2^logq
+	 * @param[in] vals: array of values
+	 * @param[in] slots: size of array
+	 * @param[in] logp: number of quantized bits
+	 * @param[in] logq: number of modulus bits
+	 */
+	void encode(FlatPoly& mx, double* vals, long slots, long logp, long logq);
+
+	/**
+	 * second half of encode into FlatPoly, for values already transformed by fftSpecialInv
+	 * @param[out] mx: polynomial with coefficients mod 2^logq, its buffer is reused if the shape allows
+	 * @param[in] uvals: array of transformed values
+	 * @param[in] slots: size of array
+	 * @param[in] logp: number of quantized bits
+	 * @param[in] logq: number of modulus bits
+	 */
+	void encodeTransformed(FlatPoly& mx, complex<double>* uvals, long slots, long logp, long logq);
+
 	/**
 	 * decoding values from a polynomial
 	 * @param[in] mx: polynomial
@@ -112,12 +160,27 @@ public:
 
 
 	/**
-	 * adding information for Bootstrapping
+	 * adding information for Bootstrapping, diagonals are encoded in parallel over the NTL thread pool
 	 * @param[in] logl: log of slots
 	 * @param[in] logp: log of precision
 	 */
 	void addBootContext(long logSlots, long logp);
 
+	/**
+	 * signed permutation of X -> X^pow in Z[X] / (X^N + 1), shared between calls:
+	 * coefficient j of p(X^pow) is p[t[j]] if t[j] >= 0 and -p[~t[j]] otherwise
+	 * @param[in] pow: odd power, e.g. element of rotGroup or M - 1
+	 * @return table t of N source indexes
+	 */
+	long* getInpowerTable(long pow);
+
+	/**
+	 * special fft plan of given size, shared between calls
+	 * @param[in] size: array size, power of two at most Nh
+	 * @return plan
+	 */
+	const FftPlan& getFftPlan(long size);
+
 
 	//----------------------------------------------------------------------------------
 	//   FFT & FFT INVERSE
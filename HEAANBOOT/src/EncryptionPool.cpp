@@ -0,0 +1,62 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "EncryptionPool.h"
+
+#include <stdexcept>
+
+EncryptionPool::EncryptionPool(function<void(FlatPoly&, FlatPoly&)> generator, long size, long threads) : generator(generator), size(size), pending(0), stopped(false) {
+	if(size <= 0 || threads <= 0) {
+		throw invalid_argument("pool size and number of threads must be positive");
+	}
+	for (long i = 0; i < threads; ++i) {
+		workers.push_back(thread(&EncryptionPool::refill, this));
+	}
+}
+
+EncryptionPool::~EncryptionPool() {
+	{
+		lock_guard<mutex> guard(poolLock);
+		stopped = true;
+	}
+	notFull.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+bool EncryptionPool::pop(FlatPoly& ax, FlatPoly& bx) {
+	{
+		lock_guard<mutex> guard(poolLock);
+		if(pool.empty()) return false;
+		ax = move(pool.front().first);
+		bx = move(pool.front().second);
+		pool.pop_front();
+	}
+	notFull.notify_one();
+	return true;
+}
+
+long EncryptionPool::available() {
+	lock_guard<mutex> guard(poolLock);
+	return pool.size();
+}
+
+void EncryptionPool::refill() {
+	unique_lock<mutex> lock(poolLock);
+	while(true) {
+		notFull.wait(lock, [this] { return stopped || (long) pool.size() + pending < size; });
+		if(stopped) return;
+		pending++;
+		lock.unlock();
+		FlatPoly ax, bx;
+		generator(ax, bx);
+		lock.lock();
+		pending--;
+		pool.push_back(make_pair(move(ax), move(bx)));
+	}
+}
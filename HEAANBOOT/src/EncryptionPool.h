@@ -0,0 +1,75 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_ENCRYPTIONPOOL_H_
+#define HEAAN_ENCRYPTIONPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "FlatPoly.h"
+
+using namespace std;
+
+/**
+ * Bounded thread-safe pool of precomputed encryptions of zero (ax, bx), kept full by
+ * background threads, so that public key encryption on the request path is a pop and an addition.
+ * Every pooled encryption is handed out once.
+ */
+class EncryptionPool {
+public:
+
+	/**
+	 * starts refill threads
+	 * @param[in] generator: fresh encryption of zero (ax, bx), called concurrently from refill threads
+	 * @param[in] size: maximum number of pooled encryptions
+	 * @param[in] threads: number of refill threads
+	 */
+	EncryptionPool(function<void(FlatPoly&, FlatPoly&)> generator, long size, long threads = 1);
+
+	/**
+	 * stops and joins refill threads
+	 */
+	~EncryptionPool();
+
+	/**
+	 * takes a pooled encryption of zero without waiting
+	 * @param[out] ax, bx: encryption of zero
+	 * @return false if the pool is empty
+	 */
+	bool pop(FlatPoly& ax, FlatPoly& bx);
+
+	/**
+	 * @return number of pooled encryptions
+	 */
+	long available();
+
+private:
+
+	function<void(FlatPoly&, FlatPoly&)> generator;
+	long size; ///< maximum number of pooled encryptions
+	long pending; ///< encryptions being generated
+	bool stopped;
+
+	deque<pair<FlatPoly, FlatPoly>> pool;
+	mutex poolLock; ///< guards pool, pending and stopped
+	condition_variable notFull;
+	vector<thread> workers;
+
+	void refill();
+
+	EncryptionPool(const EncryptionPool&) = delete;
+	EncryptionPool& operator=(const EncryptionPool&) = delete;
+
+};
+
+#endif
@@ -10,6 +10,8 @@
 #include <cmath>
 #include <complex>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
 
 
 //----------------------------------------------------------------------------------
@@ -66,14 +68,119 @@ complex<double>* EvaluatorUtils::randomCircleArray(long size, double bound) {
 //----------------------------------------------------------------------------------
 
 
+/**
+ * x = m * 2^e with |m| < 2^53, read off the IEEE-754 bits of x
+ */
+static inline void decompose(const double x, int64_t& m, long& e) {
+	uint64_t bits;
+	memcpy(&bits, &x, 8);
+	long exp = (bits >> 52) & 0x7ff;
+	uint64_t frac = bits & (((uint64_t) 1 << 52) - 1);
+	if(exp == 0) {
+		e = -1074;
+	} else {
+		frac |= (uint64_t) 1 << 52;
+		e = exp - 1075;
+	}
+	m = (bits >> 63) ? -(int64_t) frac : (int64_t) frac;
+}
+
+/**
+ * m / 2^k rounded to nearest, ties to even as RoundToZZ
+ */
+static inline int64_t roundShift(const int64_t m, const long k) {
+	if(k > 62) return 0;
+	int64_t q = m >> k;
+	uint64_t r = (uint64_t) m - ((uint64_t) q << k);
+	uint64_t half = (uint64_t) 1 << (k - 1);
+	if(r > half || (r == half && (q & 1))) q++;
+	return q;
+}
+
+/**
+ * unsigned value of words as double, correctly rounded
+ */
+static inline double wordsToDouble(const uint64_t* a, const long limbs) {
+	long k = limbs - 1;
+	while(k >= 0 && a[k] == 0) --k;
+	if(k < 0) return 0;
+	if(k == 0) return (double) a[0];
+	long lz = __builtin_clzll(a[k]);
+	uint64_t top = lz ? (a[k] << lz) | (a[k - 1] >> (64 - lz)) : a[k];
+	bool sticky = lz ? (a[k - 1] << lz) != 0 : a[k - 1] != 0;
+	for (long j = 0; j < k - 1 && !sticky; ++j) {
+		sticky = a[j] != 0;
+	}
+	// 63 bits and a sticky bit, so that the conversion rounds once
+	uint64_t t = (top >> 1) | ((top & 1) || sticky);
+	return ldexp((double) t, 64 * k - lz + 1);
+}
+
 double EvaluatorUtils::scaleDownToReal(const ZZ& x, const long logp) {
-	RR xp = to_RR(x);
-	xp.e -= logp;
-	return to_double(xp);
+	long n = NumBits(x);
+	if(n <= 63) {
+		return ldexp((double) conv<long>(x), -logp);
+	}
+	ZZ ax, t;
+	abs(ax, x);
+	RightShift(t, ax, n - 63);
+	uint64_t top = conv<long>(t);
+	if(NumTwos(ax) < n - 63) top |= 1;
+	double res = ldexp((double) top, n - 63 - logp);
+	return sign(x) < 0 ? -res : res;
+}
+
+void EvaluatorUtils::scaleDownToReal(double* res, const long stride, const FlatPoly& p, const long start, const long gap, const long size, const long logq, const long logp) {
+	uint64_t* w = new uint64_t[p.limbs];
+	for (long i = 0; i < size; ++i) {
+		copy(p.coeff(start + i * gap), p.coeff(start + i * gap) + p.limbs, w);
+		WordUtils::maskWords(w, logq, p.limbs);
+		bool negative = logq > 0 && logq <= 64 * p.limbs && ((w[(logq - 1) >> 6] >> ((logq - 1) & 63)) & 1);
+		if(negative) {
+			WordUtils::negateWords(w, w, p.limbs);
+			WordUtils::maskWords(w, logq, p.limbs);
+		}
+		double val = ldexp(wordsToDouble(w, p.limbs), -logp);
+		res[i * stride] = negative ? -val : val;
+	}
+	delete[] w;
 }
 
 ZZ EvaluatorUtils::scaleUpToZZ(const double x, const long logp) {
-	return scaleUpToZZ(to_RR(x), logp);
+	int64_t m;
+	long e;
+	decompose(x, m, e);
+	long s = e + logp;
+	if(s < 0) {
+		return conv<ZZ>((long) roundShift(m, -s));
+	}
+	ZZ res = conv<ZZ>((long) m);
+	LeftShift(res, res, s);
+	return res;
+}
+
+void EvaluatorUtils::scaleUpToWords(uint64_t* res, const long limbs, const double x, const long logp) {
+	int64_t m;
+	long e;
+	decompose(x, m, e);
+	long s = e + logp;
+	if(s < 0) {
+		m = roundShift(m, -s);
+		s = 0;
+	}
+	uint64_t mag = m < 0 ? -(uint64_t) m : (uint64_t) m;
+	fill(res, res + limbs, 0);
+	long k = s >> 6;
+	long b = s & 63;
+	if(k < limbs) res[k] = mag << b;
+	if(b && k + 1 < limbs) res[k + 1] = mag >> (64 - b);
+	if(m < 0) WordUtils::negateWords(res, res, limbs);
+}
+
+void EvaluatorUtils::scaleUpToFlat(FlatPoly& res, const long start, const long gap, const double* vals, const long stride, const long size, const long logp) {
+	for (long i = 0; i < size; ++i) {
+		scaleUpToWords(res.coeff(start + i * gap), res.limbs, vals[i * stride], logp);
+	}
 }
 
 ZZ EvaluatorUtils::scaleUpToZZ(const RR& x, const long logp) {
@@ -68,6 +68,15 @@ public:
 	 */
 	static double scaleDownToReal(const ZZ& x, const long logp);
 
+	/**
+	 * batched scaleDownToReal of centered coefficients mod 2^logq, read from words without ZZ
+	 * @param[out] res: res[i * stride] = (coefficient start + i * gap of p) >> logp, i < size
+	 * @param[in] p: polynomial
+	 * @param[in] logq: log of modulus
+	 * @param[in] logp: log of precision
+	 */
+	static void scaleDownToReal(double* res, const long stride, const FlatPoly& p, const long start, const long gap, const long size, const long logq, const long logp);
+
 	/**
 	 * evaluates value x << logp
 	 * @param[in] x: double value
@@ -84,6 +93,23 @@ public:
 	 */
 	static ZZ scaleUpToZZ(const RR& x, const long logp);
 
+	/**
+	 * round(x * 2^logp) from the IEEE-754 bits of x, rounding as scaleUpToZZ
+	 * @param[out] res: result in two's complement mod 2^(64 limbs)
+	 * @param[in] limbs: number of words of res
+	 * @param[in] x: double value
+	 * @param[in] logp: log of precision
+	 */
+	static void scaleUpToWords(uint64_t* res, const long limbs, const double x, const long logp);
+
+	/**
+	 * batched scaleUpToWords
+	 * @param[in, out] res: coefficient start + i * gap is set to round(vals[i * stride] * 2^logp), i < size
+	 * @param[in] vals: values, e.g. (double*) of complex array with stride 2
+	 * @param[in] logp: log of precision
+	 */
+	static void scaleUpToFlat(FlatPoly& res, const long start, const long gap, const double* vals, const long stride, const long size, const long logp);
+
 
 	//----------------------------------------------------------------------------------
 	//   ROTATIONS
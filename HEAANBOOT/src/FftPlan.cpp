@@ -0,0 +1,233 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "FftPlan.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HEAAN_FFT_SIMD
+#include <immintrin.h>
+#endif
+
+
+//----------------------------------------------------------------------------------
+//   BUTTERFLY KERNELS
+//----------------------------------------------------------------------------------
+
+
+// complex products are written out as (ac - bd, ad + bc) in every kernel,
+// so that all of them give the same values as the scalar one
+
+static void ditScalar(const complex<double>* a, const complex<double>* b, complex<double>* ra, complex<double>* rb, const complex<double>* w, long n) {
+	const double* pa = (const double*) a;
+	const double* pb = (const double*) b;
+	const double* pw = (const double*) w;
+	double* qa = (double*) ra;
+	double* qb = (double*) rb;
+	for (long j = 0; j < 2 * n; j += 2) {
+		double vr = pb[j] * pw[j] - pb[j + 1] * pw[j + 1];
+		double vi = pb[j] * pw[j + 1] + pb[j + 1] * pw[j];
+		double ur = pa[j], ui = pa[j + 1];
+		qa[j] = ur + vr;
+		qa[j + 1] = ui + vi;
+		qb[j] = ur - vr;
+		qb[j + 1] = ui - vi;
+	}
+}
+
+static void difScalar(const complex<double>* a, const complex<double>* b, complex<double>* ra, complex<double>* rb, const complex<double>* w, long n) {
+	const double* pa = (const double*) a;
+	const double* pb = (const double*) b;
+	const double* pw = (const double*) w;
+	double* qa = (double*) ra;
+	double* qb = (double*) rb;
+	for (long j = 0; j < 2 * n; j += 2) {
+		double ur = pa[j] + pb[j], ui = pa[j + 1] + pb[j + 1];
+		double dr = pa[j] - pb[j], di = pa[j + 1] - pb[j + 1];
+		qa[j] = ur;
+		qa[j + 1] = ui;
+		qb[j] = dr * pw[j] - di * pw[j + 1];
+		qb[j + 1] = dr * pw[j + 1] + di * pw[j];
+	}
+}
+
+#ifdef HEAAN_FFT_SIMD
+
+/**
+ * two complex products, lanes (re, im, re, im)
+ */
+__attribute__((target("avx2")))
+static inline __m256d mulAvx2(__m256d x, __m256d w) {
+	__m256d wr = _mm256_movedup_pd(w);
+	__m256d wi = _mm256_permute_pd(w, 0xF);
+	__m256d xs = _mm256_permute_pd(x, 0x5);
+	return _mm256_addsub_pd(_mm256_mul_pd(x, wr), _mm256_mul_pd(xs, wi));
+}
+
+__attribute__((target("avx2")))
+static void ditAvx2(const complex<double>* a, const complex<double>* b, complex<double>* ra, complex<double>* rb, const complex<double>* w, long n) {
+	if(n & 1) {
+		ditScalar(a, b, ra, rb, w, n);
+		return;
+	}
+	for (long j = 0; j < 2 * n; j += 4) {
+		__m256d u = _mm256_loadu_pd((const double*) a + j);
+		__m256d v = mulAvx2(_mm256_loadu_pd((const double*) b + j), _mm256_loadu_pd((const double*) w + j));
+		_mm256_storeu_pd((double*) ra + j, _mm256_add_pd(u, v));
+		_mm256_storeu_pd((double*) rb + j, _mm256_sub_pd(u, v));
+	}
+}
+
+__attribute__((target("avx2")))
+static void difAvx2(const complex<double>* a, const complex<double>* b, complex<double>* ra, complex<double>* rb, const complex<double>* w, long n) {
+	if(n & 1) {
+		difScalar(a, b, ra, rb, w, n);
+		return;
+	}
+	for (long j = 0; j < 2 * n; j += 4) {
+		__m256d x = _mm256_loadu_pd((const double*) a + j);
+		__m256d y = _mm256_loadu_pd((const double*) b + j);
+		_mm256_storeu_pd((double*) ra + j, _mm256_add_pd(x, y));
+		_mm256_storeu_pd((double*) rb + j, mulAvx2(_mm256_sub_pd(x, y), _mm256_loadu_pd((const double*) w + j)));
+	}
+}
+
+/**
+ * four complex products, lanes (re, im, re, im, ...), real lanes subtract;
+ * masked forms with all lanes set give the source explicitly, the unmasked ones warn in gcc 12
+ */
+__attribute__((target("avx512f")))
+static inline __m512d mulAvx512(__m512d x, __m512d w) {
+	__m512d wr = _mm512_mask_movedup_pd(w, 0xFF, w);
+	__m512d wi = _mm512_mask_permute_pd(w, 0xFF, w, 0xFF);
+	__m512d p = _mm512_mul_pd(x, wr);
+	__m512d q = _mm512_mul_pd(_mm512_mask_permute_pd(x, 0xFF, x, 0x55), wi);
+	return _mm512_mask_sub_pd(_mm512_add_pd(p, q), 0x55, p, q);
+}
+
+__attribute__((target("avx512f")))
+static void ditAvx512(const complex<double>* a, const complex<double>* b, complex<double>* ra, complex<double>* rb, const complex<double>* w, long n) {
+	if(n & 3) {
+		ditScalar(a, b, ra, rb, w, n);
+		return;
+	}
+	for (long j = 0; j < 2 * n; j += 8) {
+		__m512d u = _mm512_loadu_pd((const double*) a + j);
+		__m512d v = mulAvx512(_mm512_loadu_pd((const double*) b + j), _mm512_loadu_pd((const double*) w + j));
+		_mm512_storeu_pd((double*) ra + j, _mm512_add_pd(u, v));
+		_mm512_storeu_pd((double*) rb + j, _mm512_sub_pd(u, v));
+	}
+}
+
+__attribute__((target("avx512f")))
+static void difAvx512(const complex<double>* a, const complex<double>* b, complex<double>* ra, complex<double>* rb, const complex<double>* w, long n) {
+	if(n & 3) {
+		difScalar(a, b, ra, rb, w, n);
+		return;
+	}
+	for (long j = 0; j < 2 * n; j += 8) {
+		__m512d x = _mm512_loadu_pd((const double*) a + j);
+		__m512d y = _mm512_loadu_pd((const double*) b + j);
+		_mm512_storeu_pd((double*) ra + j, _mm512_add_pd(x, y));
+		_mm512_storeu_pd((double*) rb + j, mulAvx512(_mm512_sub_pd(x, y), _mm512_loadu_pd((const double*) w + j)));
+	}
+}
+
+#endif
+
+
+//----------------------------------------------------------------------------------
+//   PLAN
+//----------------------------------------------------------------------------------
+
+
+FftPlan::FftPlan(long size, long M, long* rotGroup, complex<double>* ksiPows) : size(size), rev(new long[size]), twiddles(new complex<double>[size]), twiddlesInv(new complex<double>[size]) {
+	rev[0] = 0;
+	for (long i = 1, j = 0; i < size; ++i) {
+		long bit = size >> 1;
+		for (; j >= bit; bit >>= 1) {
+			j -= bit;
+		}
+		j += bit;
+		rev[i] = j;
+	}
+	for (long lenh = 1; lenh < size; lenh <<= 1) {
+		long lenq = lenh << 3;
+		for (long j = 0; j < lenh; ++j) {
+			long idx = (rotGroup[j] % lenq) * M / lenq;
+			twiddles[lenh - 1 + j] = ksiPows[idx];
+			twiddlesInv[lenh - 1 + j] = ksiPows[M - idx];
+		}
+	}
+
+	dit = ditScalar;
+	dif = difScalar;
+#ifdef HEAAN_FFT_SIMD
+	if(__builtin_cpu_supports("avx512f")) {
+		dit = ditAvx512;
+		dif = difAvx512;
+	} else if(__builtin_cpu_supports("avx2")) {
+		dit = ditAvx2;
+		dif = difAvx2;
+	}
+#endif
+}
+
+FftPlan::~FftPlan() {
+	delete[] rev;
+	delete[] twiddles;
+	delete[] twiddlesInv;
+}
+
+void FftPlan::special(complex<double>* vals, complex<double>* buf) const {
+	if(size == 1) return;
+	bool isOwned = size > 2 && buf == NULL;
+	if(isOwned) buf = new complex<double>[size];
+	if(size == 2) buf = vals;
+
+	// bit reversal fused into the first stage, whose pairs are rev[i], rev[i] + size / 2
+	complex<double> w = twiddles[0];
+	for (long i = 0; i < size; i += 2) {
+		complex<double> u = vals[rev[i]];
+		complex<double> v = vals[rev[i] + (size >> 1)];
+		dit(&u, &v, buf + i, buf + i + 1, &w, 1);
+	}
+
+	for (long lenh = 2; lenh < size; lenh <<= 1) {
+		complex<double>* res = (lenh << 1) == size ? vals : buf;
+		for (long i = 0; i < size; i += lenh << 1) {
+			dit(buf + i, buf + i + lenh, res + i, res + i + lenh, twiddles + lenh - 1, lenh);
+		}
+	}
+	if(isOwned) delete[] buf;
+}
+
+void FftPlan::specialInv(complex<double>* vals, double scale, complex<double>* buf) const {
+	if(size == 1) {
+		vals[0] *= scale;
+		return;
+	}
+	bool isOwned = size > 2 && buf == NULL;
+	if(isOwned) buf = new complex<double>[size];
+	if(size == 2) buf = vals;
+	complex<double>* src = vals;
+	for (long lenh = size >> 1; lenh > 1; lenh >>= 1) {
+		for (long i = 0; i < size; i += lenh << 1) {
+			dif(src + i, src + i + lenh, buf + i, buf + i + lenh, twiddlesInv + lenh - 1, lenh);
+		}
+		src = buf;
+	}
+
+	// last stage with bit reversal and scaling fused
+	complex<double> w = twiddlesInv[0];
+	for (long i = 0; i < size; i += 2) {
+		complex<double> u, v;
+		dif(buf + i, buf + i + 1, &u, &v, &w, 1);
+		vals[rev[i]] = u * scale;
+		vals[rev[i] + (size >> 1)] = v * scale;
+	}
+	if(isOwned) delete[] buf;
+}
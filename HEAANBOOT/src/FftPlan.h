@@ -0,0 +1,68 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_FFTPLAN_H_
+#define HEAAN_FFTPLAN_H_
+
+#include <complex>
+
+using namespace std;
+
+/**
+ * Precomputed special fft of a fixed size for encoding/decoding.
+ * Twiddles of all stages are stored contiguously in the order the butterflies read them,
+ * the bit reversal is fused into the first stage of fft and into the last stage of fft inverse,
+ * and the butterflies run on AVX-512 or AVX2 when the cpu supports it, with a scalar fallback.
+ * A plan is immutable after construction and can be used from several threads.
+ */
+class FftPlan {
+public:
+
+	long size; ///< number of values, power of two
+	long* rev; ///< bit reversal permutation of [0, size)
+	complex<double>* twiddles; ///< stage with half length lenh at offset lenh - 1
+	complex<double>* twiddlesInv; ///< conjugates of twiddles, same layout
+
+	/**
+	 * @param[in] size: number of values
+	 * @param[in] M: 2N
+	 * @param[in] rotGroup: powers of 5 mod M
+	 * @param[in] ksiPows: powers of M-th root of unity
+	 */
+	FftPlan(long size, long M, long* rotGroup, complex<double>* ksiPows);
+
+	~FftPlan();
+
+	/**
+	 * special fft, same values as Context::fftSpecial
+	 * @param[in, out] vals: array of size values
+	 * @param[in] buf: scratch of size values, allocated per call if NULL
+	 */
+	void special(complex<double>* vals, complex<double>* buf = NULL) const;
+
+	/**
+	 * special fft inverse, multiplied by scale, e.g. 1 / size
+	 * @param[in, out] vals: array of size values
+	 * @param[in] scale: factor applied together with the bit reversal
+	 * @param[in] buf: scratch of size values, allocated per call if NULL
+	 */
+	void specialInv(complex<double>* vals, double scale, complex<double>* buf = NULL) const;
+
+private:
+
+	/// out-of-place butterflies ra = a + b * w, rb = a - b * w for n pairs, outputs may alias inputs
+	void (*dit)(const complex<double>* a, const complex<double>* b, complex<double>* ra, complex<double>* rb, const complex<double>* w, long n);
+
+	/// out-of-place butterflies ra = a + b, rb = (a - b) * w for n pairs, outputs may alias inputs
+	void (*dif)(const complex<double>* a, const complex<double>* b, complex<double>* ra, complex<double>* rb, const complex<double>* w, long n);
+
+	FftPlan(const FftPlan&) = delete;
+	FftPlan& operator=(const FftPlan&) = delete;
+
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "FlatPoly.h"
+
+#include <algorithm>
+
+FlatPoly::FlatPoly(long N, long limbs) : N(N), limbs(limbs), words(N > 0 && limbs > 0 ? new uint64_t[N * limbs]() : NULL) {}
+
+FlatPoly::FlatPoly(ZZX& p, const long logq, const long N) : N(N), limbs(0), words(NULL) {
+	fromZZX(p, logq);
+}
+
+FlatPoly::FlatPoly(ZZX& p, const long N) : N(N), limbs(0), words(NULL) {
+	long bits = 0;
+	long len = min(N, p.rep.length());
+	for (long n = 0; n < len; ++n) {
+		bits = max(bits, NumBits(p.rep[n]));
+	}
+	fromZZX(p, 64 * limbsFor(bits + 1));
+}
+
+FlatPoly::FlatPoly(const FlatPoly& o) : N(o.N), limbs(o.limbs), words(o.N > 0 && o.limbs > 0 ? new uint64_t[o.N * o.limbs] : NULL) {
+	copy(o.words, o.words + N * limbs, words);
+}
+
+FlatPoly::FlatPoly(FlatPoly&& o) : N(o.N), limbs(o.limbs), words(o.words) {
+	o.N = 0;
+	o.limbs = 0;
+	o.words = NULL;
+}
+
+FlatPoly& FlatPoly::operator=(const FlatPoly& o) {
+	if(this == &o) return *this;
+	reshape(o.N, o.limbs);
+	copy(o.words, o.words + N * limbs, words);
+	return *this;
+}
+
+FlatPoly& FlatPoly::operator=(FlatPoly&& o) {
+	if(this == &o) return *this;
+	swap(N, o.N);
+	swap(limbs, o.limbs);
+	swap(words, o.words);
+	return *this;
+}
+
+FlatPoly::~FlatPoly() {
+	delete[] words;
+}
+
+void FlatPoly::reshape(const long N, const long limbs) {
+	if(N * limbs != this->N * this->limbs || words == NULL) {
+		delete[] words;
+		words = new uint64_t[N * limbs];
+	}
+	this->N = N;
+	this->limbs = limbs;
+}
+
+void FlatPoly::clear() {
+	fill(words, words + N * limbs, 0);
+}
+
+void FlatPoly::fromZZX(ZZX& p, const long logq) {
+	reshape(N, limbsFor(logq));
+	long len = min(N, p.rep.length());
+	for (long n = 0; n < len; ++n) {
+		WordUtils::fromZZ(coeff(n), p.rep[n], limbs);
+		WordUtils::maskWords(coeff(n), logq, limbs);
+	}
+	fill(words + len * limbs, words + N * limbs, 0);
+}
+
+void FlatPoly::toZZX(ZZX& p) const {
+	unsigned char* bytes = new unsigned char[8 * limbs];
+	p.SetLength(N);
+	for (long n = 0; n < N; ++n) {
+		WordUtils::toZZ(p.rep[n], coeff(n), limbs, bytes);
+	}
+	delete[] bytes;
+}
+
+void FlatPoly::getCoeff(ZZ& x, const long n) const {
+	unsigned char* bytes = new unsigned char[8 * limbs];
+	WordUtils::toZZ(x, coeff(n), limbs, bytes);
+	delete[] bytes;
+}
+
+bool FlatPoly::operator==(const FlatPoly& o) const {
+	return N == o.N && limbs == o.limbs && equal(words, words + N * limbs, o.words);
+}
+
+bool FlatPoly::operator!=(const FlatPoly& o) const {
+	return !(*this == o);
+}
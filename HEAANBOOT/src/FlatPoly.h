@@ -0,0 +1,111 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_FLATPOLY_H_
+#define HEAAN_FLATPOLY_H_
+
+#include <NTL/ZZ.h>
+#include <NTL/ZZX.h>
+#include <cstdint>
+
+#include "WordUtils.h"
+
+using namespace std;
+using namespace NTL;
+
+/**
+ * Polynomial in Z[X] / (X^N + 1) in one contiguous buffer: coefficient n occupies words
+ * [n * limbs, (n + 1) * limbs), least significant word first, in two's complement mod 2^(64 limbs).
+ *
+ * Polynomials of Ciphertext, Plaintext and Key have coefficients in [0, 2^logq) and
+ * limbsFor(logq) words each, so the width follows the modulus and arithmetic mod 2^logq
+ * works on the words directly (see the FlatPoly overloads in Ring2Utils).
+ * Multiplication reads coefficients as centered values, so short signed polynomials
+ * such as encoded constants are stored in two's complement at their own width.
+ */
+class FlatPoly {
+public:
+
+	long N; ///< ring degree
+	long limbs; ///< 64-bit words per coefficient
+	uint64_t* words; ///< N * limbs words
+
+	FlatPoly(long N = 0, long limbs = 0);
+
+	/**
+	 * conversion from polynomial with signed coefficients
+	 * @param[in] p: polynomial
+	 * @param[in] logq: coefficients are reduced mod 2^logq into limbsFor(logq) words
+	 * @param[in] N: ring degree
+	 */
+	FlatPoly(ZZX& p, const long logq, const long N);
+
+	/**
+	 * exact conversion from polynomial with signed coefficients, in two's complement
+	 * at the smallest number of words that holds all of them
+	 * @param[in] p: polynomial
+	 * @param[in] N: ring degree
+	 */
+	FlatPoly(ZZX& p, const long N);
+
+	FlatPoly(const FlatPoly& o);
+
+	FlatPoly(FlatPoly&& o);
+
+	FlatPoly& operator=(const FlatPoly& o);
+
+	FlatPoly& operator=(FlatPoly&& o);
+
+	~FlatPoly();
+
+	/**
+	 * words of n-th coefficient
+	 */
+	inline uint64_t* coeff(const long n) {
+		return words + n * limbs;
+	}
+
+	inline const uint64_t* coeff(const long n) const {
+		return words + n * limbs;
+	}
+
+	/**
+	 * changes shape, contents are undefined if it changes
+	 * @param[in] N: ring degree
+	 * @param[in] limbs: words per coefficient
+	 */
+	void reshape(const long N, const long limbs);
+
+	/**
+	 * sets all coefficients to zero
+	 */
+	void clear();
+
+	/**
+	 * @param[in] p: polynomial with signed coefficients
+	 * @param[in] logq: coefficients are reduced mod 2^logq into limbsFor(logq) words
+	 */
+	void fromZZX(ZZX& p, const long logq);
+
+	/**
+	 * @param[out] p: polynomial of length N with coefficients in [0, 2^(64 limbs))
+	 */
+	void toZZX(ZZX& p) const;
+
+	/**
+	 * @param[out] x: n-th coefficient in [0, 2^(64 limbs))
+	 * @param[in] n: index
+	 */
+	void getCoeff(ZZ& x, const long n) const;
+
+	bool operator==(const FlatPoly& o) const;
+
+	bool operator!=(const FlatPoly& o) const;
+
+};
+
+#endif
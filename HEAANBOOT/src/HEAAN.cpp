@@ -27,12 +27,42 @@ int main() {
 	 */
 //	TestScheme::testEncodeSingle(13, 65, 30);
 
+	/*
+	 * Params: logN, logQ, logp, logSlots, poolSize, poolThreads
+	 * Suggested: 13, 65, 30, 3, 16, 2
+	 */
+//	TestScheme::testEncryptionPool(13, 65, 30, 3, 16, 2);
+
+	/*
+	 * Params: logN, logQ, logp, logSlots, count, numThreads
+	 * Suggested: 13, 65, 30, 12, 64, 4
+	 */
+//	TestScheme::testEncodeMany(13, 65, 30, 12, 64, 4);
+
+	/*
+	 * Params: logN, logQ, numThreads
+	 * Suggested: 16, 1200, 4
+	 */
+//	TestScheme::testSampler(16, 1200, 4);
+
+	/*
+	 * Params: logN, logQ, logp, logSlots
+	 * Suggested: 13, 65, 30, 3
+	 */
+//	TestScheme::testEncryptSymmetric(13, 65, 30, 3);
+
 	/*
 	 * Params: logN, logQ, logp, logSlots
 	 * Suggested: 13, 65, 30, 3
 	 */
 //	TestScheme::testBasic(13, 65, 30, 3);
 
+	/*
+	 * Params: logN, logQ, logp, logSlots, dnum
+	 * Suggested: 13, 600, 30, 3, 3
+	 */
+//	TestScheme::testKeySwitchDigits(13, 600, 30, 3, 3);
+
 	/*
 	 * Params: logN, logQ, logp, logSlots
 	 * Suggested: 13, 65, 30, 3
@@ -57,6 +87,13 @@ int main() {
 //	TestScheme::testRotateByPo2Batch(13, 65, 30, 2, 5, true);
 //	TestScheme::testRotateBatch(13, 65, 30, 17, 5, true);
 
+	/*
+	 * Params: logN, logQ, logp, logSlots, numRots, maxKeys
+	 * Suggested: 13, 65, 30, 8, 40, 16
+	 */
+
+//	TestScheme::testRotatePlanned(13, 65, 30, 8, 40, 16);
+
 	/*
 	 * Params: logN, logQ, logp, logSlots
 	 * Suggested: 13, 65, 30, 3
@@ -163,18 +200,32 @@ int main() {
 	 */
 
 //	TestScheme::testWriteAndRead(15, 620, 30, 3);
+//	TestScheme::testWriteAndReadBinary(15, 620, 30, 3);
+
+	/*
+	 * Params: logN, logQ, logp, logSlots, maxResident
+	 * Suggested: 13, 65, 30, 3, 2
+	 */
+//	TestScheme::testRotationKeyStore(13, 65, 30, 3, 2);
 
 
 	//-----------------------------------------
 
 	/*
-	 * Params: logN, logp, logq, logQ, logSlots, logT
-	 * Suggested: 15, 23, 29, 620, 3, 2
-	 * Suggested: 15, 27, 37, 620, 3, 3
-	 * Suggested: 16, 31, 41, 1240, 3, 3
-	 * Suggested: 16, 39, 54, 1240, 3, 5
+	 * Params: logN, logQ, logSlots, logp
+	 * Suggested: 15, 620, 10, 33
+	 */
+//	TestScheme::testBootContextCache(15, 620, 10, 33);
+
+	/*
+	 * Params: logN, logp, logq, logQ, logSlots, logT, numThreads
+	 * Suggested: 15, 23, 29, 620, 3, 2, 1
+	 * Suggested: 15, 23, 29, 620, 3, 2, 4
+	 * Suggested: 15, 27, 37, 620, 3, 3, 1
+	 * Suggested: 16, 31, 41, 1240, 3, 3, 1
+	 * Suggested: 16, 39, 54, 1240, 3, 5, 1
 	 */
-//	TestScheme::testBootstrap(15, 23, 29, 620, 3, 2);
+//	TestScheme::testBootstrap(15, 23, 29, 620, 3, 2, 4);
 
 	/*
 	 * Params: logN, logp, logq, logQ, logT
@@ -185,5 +236,21 @@ int main() {
 	 */
 //	TestScheme::testBootstrapSingleReal(15, 23, 29, 620, 2);
 
+	//-----------------------------------------
+
+	/*
+	 * Params: logN, logq0, logp, L, logSlots
+	 * Suggested: 13, 40, 30, 4, 3
+	 */
+//	TestScheme::testRNSBasic(13, 40, 30, 4, 3);
+
+	/*
+	 * Params: logN, logq0, logp, L, logSlots, nu, logT, numThreads
+	 * Suggested: 15, 40, 44, 18, 3, 10, 2, 1
+	 * Suggested: 15, 40, 44, 18, 3, 10, 2, 4
+	 * Suggested: 16, 50, 54, 18, 3, 10, 3, 1
+	 */
+//	TestScheme::testRNSBootstrap(15, 40, 44, 18, 3, 10, 2, 4);
+
 	return 0;
 }
@@ -6,3 +6,122 @@
 * work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
 */
 #include "Key.h"
+
+#include <algorithm>
+
+#include "RingMultiplier.h"
+#include "WordUtils.h"
+
+Key::Key(const Key& o) : ax(o.ax), bx(o.bx), rax(NULL), rbx(NULL), np(o.np), N(o.N), isSeeded(o.isSeeded), logq(o.logq), digitKeys(o.digitKeys), keepsReduced(o.keepsReduced) {
+	copy(o.seed, o.seed + SEED_BYTES, seed);
+	if(o.rax != NULL) {
+		rax = new uint64_t[np * N];
+		rbx = new uint64_t[np * N];
+		copy(o.rax, o.rax + np * N, rax);
+		copy(o.rbx, o.rbx + np * N, rbx);
+	}
+}
+
+Key& Key::operator=(const Key& o) {
+	if(this == &o) return *this;
+	delete[] rax;
+	delete[] rbx;
+	ax = o.ax;
+	bx = o.bx;
+	np = o.np;
+	N = o.N;
+	isSeeded = o.isSeeded;
+	logq = o.logq;
+	digitKeys = o.digitKeys;
+	keepsReduced = o.keepsReduced;
+	copy(o.seed, o.seed + SEED_BYTES, seed);
+	rax = NULL;
+	rbx = NULL;
+	reducedMap.clear();
+	if(o.rax != NULL) {
+		rax = new uint64_t[np * N];
+		rbx = new uint64_t[np * N];
+		copy(o.rax, o.rax + np * N, rax);
+		copy(o.rbx, o.rbx + np * N, rbx);
+	}
+	return *this;
+}
+
+void Key::transform(const long np, const long N) {
+	if(rax != NULL && this->np >= np && this->N == N) return;
+	delete[] rax;
+	delete[] rbx;
+	RingMultiplier& multiplier = RingMultiplier::getInstance(N);
+	FlatPoly tmp;
+	rax = new uint64_t[np * N];
+	rbx = new uint64_t[np * N];
+	multiplier.CRT(rax, getAx(tmp, N), np);
+	multiplier.CRT(rbx, bx, np);
+	this->np = np;
+	this->N = N;
+}
+
+void Key::setSeed(const unsigned char* seed, const long logq) {
+	isSeeded = true;
+	this->logq = logq;
+	copy(seed, seed + SEED_BYTES, this->seed);
+}
+
+void Key::releaseAx() {
+	if(isSeeded) ax = FlatPoly();
+}
+
+const FlatPoly& Key::getAx(FlatPoly& tmp, const long N) const {
+	if(!isSeeded || ax.N != 0) return ax;
+	NumUtils::sampleUniform2(tmp, seed, N, logq);
+	return tmp;
+}
+
+void Key::transformReduced(uint64_t* rax, uint64_t* rbx, const long logqQ, const long np, const long N) const {
+	RingMultiplier& multiplier = RingMultiplier::getInstance(N);
+	long limbs = limbsFor(logqQ);
+	FlatPoly tmp;
+	const FlatPoly* parts[2] = {&getAx(tmp, N), &bx};
+	uint64_t* res[2] = {rax, rbx};
+	FlatPoly part(N, limbs);
+	for (long j = 0; j < 2; ++j) {
+		for (long i = 0; i < N; ++i) {
+			WordUtils::copyWords(part.coeff(i), limbs, parts[j]->coeff(i), parts[j]->limbs);
+			WordUtils::maskWords(part.coeff(i), logqQ, limbs);
+			WordUtils::signExtendWords(part.coeff(i), logqQ, limbs);
+		}
+		multiplier.CRT(res[j], part, np);
+	}
+}
+
+const ReducedKey& Key::getReduced(const long logqQ, const long np, const long N) {
+	lock_guard<mutex> guard(reducedLock);
+	auto it = reducedMap.find(logqQ);
+	if(it == reducedMap.end()) {
+		ReducedKey* reduced = new ReducedKey(np, N);
+		transformReduced(reduced->rax, reduced->rbx, logqQ, np, N);
+		it = reducedMap.insert(make_pair(logqQ, unique_ptr<ReducedKey>(reduced))).first;
+	}
+	return *it->second;
+}
+
+void Key::releaseReduced() {
+	lock_guard<mutex> guard(reducedLock);
+	reducedMap.clear();
+	for (Key& digitKey : digitKeys) {
+		digitKey.releaseReduced();
+	}
+}
+
+void Key::setKeepsReduced(const bool keeps) {
+	keepsReduced = keeps;
+	if(!keeps) releaseReduced();
+	for (Key& digitKey : digitKeys) {
+		digitKey.setKeepsReduced(keeps);
+	}
+}
+
+Key::~Key() {
+	delete[] rax;
+	delete[] rbx;
+}
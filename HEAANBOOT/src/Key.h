@@ -9,22 +9,139 @@
 #define HEAAN_KEY_H_
 
 #include <NTL/ZZX.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include "Common.h"
+#include "FlatPoly.h"
+#include "NumUtils.h"
 
 using namespace NTL;
 using namespace std;
 
+/**
+ * switching key reduced mod 2^logqQ for key switching at one level, in ntt form
+ */
+class ReducedKey {
+public:
+
+	uint64_t* rax; ///< centered ax mod 2^logqQ, np * N residues in ntt domain
+	uint64_t* rbx; ///< centered bx mod 2^logqQ, np * N residues in ntt domain
+	long np; ///< number of ntt primes
+
+	ReducedKey(const long np, const long N) : rax(new uint64_t[np * N]), rbx(new uint64_t[np * N]), np(np) {}
+
+	~ReducedKey() {
+		delete[] rax;
+		delete[] rbx;
+	}
+
+private:
+
+	ReducedKey(const ReducedKey&) = delete;
+	ReducedKey& operator=(const ReducedKey&) = delete;
+
+};
+
 /**
  * Key is an RLWE instance (ax, bx = mx + ex - ax * sx) in ring Z_q[X] / (X^N + 1);
+ * switching keys also keep ax and bx in ntt form (see RingMultiplier) for reuse in every key switch.
+ * Keys generated by Scheme have ax expanded from a seed, so once ax is in ntt form it is released
+ * and only the seed is kept; ax is expanded again when it is needed (see getAx).
+ * Key switching at ciphertext level logq needs the key mod 2^(logq + logQ) only, so transformed keys
+ * also keep reductions to the levels in use, which take fewer ntt primes (see getReduced).
+ * A switching key for dnum > 1 (see Context) is the key of digit 0, with the keys of the other digits in digitKeys.
  */
 class Key {
 public:
 
-	ZZX ax;
-	ZZX bx;
+	FlatPoly ax;
+	FlatPoly bx;
+
+	uint64_t* rax; ///< ax mod first np ntt primes in ntt domain, NULL if not transformed
+	uint64_t* rbx; ///< bx mod first np ntt primes in ntt domain, NULL if not transformed
+	long np; ///< number of ntt primes in rax and rbx
+	long N; ///< ring degree of rax and rbx
+
+	bool isSeeded; ///< ax is the expansion of seed mod 2^logq
+	unsigned char seed[SEED_BYTES]; ///< seed of ax if isSeeded
+	long logq; ///< bits of ax expanded from seed
+
+	vector<Key> digitKeys; ///< keys of digits 1, ..., dnum - 1 of switching key, empty for dnum = 1
+
+	bool keepsReduced; ///< reductions are kept by getReduced, otherwise key switching reduces the key on each use
+
+	Key(FlatPoly ax = FlatPoly(), FlatPoly bx = FlatPoly()) : ax(move(ax)), bx(move(bx)), rax(NULL), rbx(NULL), np(0), N(0), isSeeded(false), logq(0), keepsReduced(true) {}
+
+	Key(const Key& o);
+
+	Key& operator=(const Key& o);
+
+	/**
+	 * stores ax and bx in ntt form
+	 * @param[in] np: number of ntt primes
+	 * @param[in] N: ring degree
+	 */
+	void transform(const long np, const long N);
+
+	/**
+	 * marks ax as expanded from seed by NumUtils::sampleUniform2
+	 * @param[in] seed: SEED_BYTES bytes
+	 * @param[in] logq: bits of ax coefficients
+	 */
+	void setSeed(const unsigned char* seed, const long logq);
+
+	/**
+	 * frees ax of seeded key, it is expanded from seed when needed
+	 */
+	void releaseAx();
+
+	/**
+	 * @param[out] tmp: expansion of seed if ax was released
+	 * @param[in] N: ring degree
+	 * @return ax, or tmp
+	 */
+	const FlatPoly& getAx(FlatPoly& tmp, const long N) const;
+
+	/**
+	 * ax and bx mod 2^logqQ, centered, in ntt form
+	 * @param[out] rax, rbx: arrays of np * N residues
+	 * @param[in] logqQ: log of modulus of products with the key
+	 * @param[in] np: number of ntt primes
+	 * @param[in] N: ring degree
+	 */
+	void transformReduced(uint64_t* rax, uint64_t* rbx, const long logqQ, const long np, const long N) const;
+
+	/**
+	 * transformReduced of this key, kept for each logqQ from its first use; safe to call concurrently
+	 * @param[in] logqQ: log of modulus of products with the key
+	 * @param[in] np: number of ntt primes of first use at logqQ
+	 * @param[in] N: ring degree
+	 * @return reduced key, valid until releaseReduced or destruction of the key
+	 */
+	const ReducedKey& getReduced(const long logqQ, const long np, const long N);
+
+	/**
+	 * drops reductions kept by getReduced
+	 */
+	void releaseReduced();
+
+	/**
+	 * sets keepsReduced of this key and its digit keys, dropping kept reductions if false
+	 * @param[in] keeps: whether reductions are kept
+	 */
+	void setKeepsReduced(const bool keeps);
+
+	~Key();
+
+private:
 
-	Key(ZZX ax = ZZX::zero(), ZZX bx = ZZX::zero()) : ax(ax), bx(bx) {}
+	map<long, unique_ptr<ReducedKey>> reducedMap; ///< reductions by logqQ
+	mutex reducedLock; ///< guards reducedMap
 
 };
 
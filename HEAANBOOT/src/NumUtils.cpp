@@ -7,72 +7,89 @@
 */
 #include "NumUtils.h"
 
+#include "Sampler.h"
+
 
 void NumUtils::sampleGauss(ZZX& res, const long size, const double stdev) {
-	static double const Pi = 4.0 * atan(1.0);
-	static long const bignum = 0xfffffff;
+	int64_t* vals = new int64_t[size];
+	Sampler::local().sampleGauss(vals, size, stdev);
 	res.SetLength(size);
-
-	for (long i = 0; i < size; i+=2) {
-		double r1 = (1 + RandomBnd(bignum)) / ((double)bignum + 1);
-		double r2 = (1 + RandomBnd(bignum)) / ((double)bignum + 1);
-		double theta = 2 * Pi * r1;
-		double rr= sqrt(-2.0 * log(r2)) * stdev;
-		assert(rr < 8 * stdev); // sanity-check, no more than 8 standard deviations
-		// Generate two Gaussians RV's, rounded to integers
-		long x1 = (long) floor(rr * cos(theta) + 0.5);
-		res.rep[i] = x1;
-		if(i + 1 < size) {
-			long x2 = (long) floor(rr * sin(theta) + 0.5);
-			res.rep[i + 1] = x2;
-		}
+	for (long i = 0; i < size; ++i) {
+		conv(res.rep[i], (long) vals[i]);
 	}
+	delete[] vals;
+}
+
+void NumUtils::sampleGauss(FlatPoly& res, const long size, const double stdev, const long logq) {
+	Sampler::local().sampleGauss(res, size, stdev, logq);
 }
 
 void NumUtils::sampleHWT(ZZX& res, const long size, const long h) {
+	int64_t* vals = new int64_t[size];
+	Sampler::local().sampleHWT(vals, size, h);
 	res.SetLength(size);
-	long idx = 0;
-	ZZ tmp = RandomBits_ZZ(h);
-	while(idx < h) {
-		long i = RandomBnd(size);
-		if(res.rep[i] == 0) {
-			res.rep[i] = (bit(tmp, idx) == 0) ? ZZ(1) : ZZ(-1);
-			idx++;
-		}
+	for (long i = 0; i < size; ++i) {
+		conv(res.rep[i], (long) vals[i]);
 	}
+	delete[] vals;
 }
 
 void NumUtils::sampleZO(ZZX& res, const long size) {
+	int64_t* vals = new int64_t[size];
+	Sampler::local().sampleZO(vals, size);
 	res.SetLength(size);
-	ZZ tmp = RandomBits_ZZ(2 * size);
 	for (long i = 0; i < size; ++i) {
-		res.rep[i] = (bit(tmp, 2 * i) == 0) ? ZZ(0) : (bit(tmp, 2 * i + 1) == 0) ? ZZ(1) : ZZ(-1);
+		conv(res.rep[i], (long) vals[i]);
 	}
+	delete[] vals;
 }
 
 void NumUtils::sampleBinary(ZZX& res, const long size, const long h) {
+	int64_t* vals = new int64_t[size];
+	Sampler::local().sampleBinary(vals, size, h);
 	res.SetLength(size);
-	long idx = 0;
-	while(idx < h) {
-		long i = RandomBnd(size);
-		if(res.rep[i] == 0) {
-			res.rep[i] = ZZ(1);
-			idx++;
-		}
+	for (long i = 0; i < size; ++i) {
+		conv(res.rep[i], (long) vals[i]);
 	}
+	delete[] vals;
 }
 
 void NumUtils::sampleBinary(ZZX& res, const long size) {
+	int64_t* vals = new int64_t[size];
+	Sampler::local().sampleBinary(vals, size);
 	res.SetLength(size);
-	ZZ tmp = RandomBits_ZZ(size);
 	for (long i = 0; i < size; ++i) {
-		res.rep[i] = (bit(tmp, i) == 0) ? ZZ(0) : ZZ(1);
+		conv(res.rep[i], (long) vals[i]);
 	}
+	delete[] vals;
 }
 
 void NumUtils::sampleUniform2(ZZX& res, const long size, const long bits) {
-	res.SetLength(size);
-	for (long i = 0; i < size; i++) {
-		res.rep[i] = RandomBits_ZZ(bits);
+	FlatPoly tmp;
+	Sampler::local().sampleUniform2(tmp, size, bits);
+	tmp.toZZX(res);
+}
+
+void NumUtils::sampleSeed(unsigned char* seed) {
+	Sampler::local().get(seed, SEED_BYTES);
+}
+
+void NumUtils::sampleUniform2(FlatPoly& res, const unsigned char* seed, const long size, const long bits) {
+	long limbs = limbsFor(bits);
+	res.reshape(size, limbs);
+	RandomStream stream(seed);
+	unsigned char* bytes = new unsigned char[8 * limbs];
+	for (long i = 0; i < size; ++i) {
+		stream.get(bytes, 8 * limbs);
+		uint64_t* ri = res.coeff(i);
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t w = 0;
+			for (long b = 7; b >= 0; --b) {
+				w = (w << 8) | bytes[8 * k + b];
+			}
+			ri[k] = w;
+		}
+		WordUtils::maskWords(ri, bits, limbs);
 	}
+	delete[] bytes;
 }
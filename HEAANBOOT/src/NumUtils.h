@@ -13,8 +13,11 @@
 #include <NTL/ZZ.h>
 
 #include "Common.h"
+#include "FlatPoly.h"
 using namespace NTL;
 
+static const long SEED_BYTES = NTL_PRG_KEYLEN; ///< size of seeds of uniform polynomials
+
 class NumUtils {
 public:
 
@@ -23,6 +26,7 @@ public:
 	//   SAMPLING
 	//----------------------------------------------------------------------------------
 
+	// all samplers except the seeded sampleUniform2 draw from Sampler::local() of the calling thread
 
 	/**
 	 * samples polynomial with random Gaussians coefficients
@@ -32,6 +36,15 @@ public:
 	 */
 	static void sampleGauss(ZZX& res, const long size, const double stdev);
 
+	/**
+	 * samples polynomial with random Gaussians coefficients directly into words
+	 * @param[out] res: polynomial with coefficients mod 2^logq
+	 * @param[in] size: polynomial degree
+	 * @param[in] stdev: standard deviation
+	 * @param[in] logq: log of modulus
+	 */
+	static void sampleGauss(FlatPoly& res, const long size, const double stdev, const long logq);
+
 	/**
 	 * samples polynomial with random {-1,0,1} coefficients
 	 * @param[out] res: ZZX polynomial
@@ -70,6 +83,22 @@ public:
 	 */
 	static void sampleUniform2(ZZX& res, const long size, const long bits);
 
+	/**
+	 * samples fresh seed for sampleUniform2
+	 * @param[out] seed: SEED_BYTES bytes
+	 */
+	static void sampleSeed(unsigned char* seed);
+
+	/**
+	 * expands seed into polynomial with uniform coefficients in [0, 2^bits-1],
+	 * the same polynomial for the same seed, size and bits on every platform
+	 * @param[out] res: polynomial with limbsFor(bits) words per coefficient
+	 * @param[in] seed: SEED_BYTES bytes
+	 * @param[in] size: polynomial degree
+	 * @param[in] bits: number of bits
+	 */
+	static void sampleUniform2(FlatPoly& res, const unsigned char* seed, const long size, const long bits);
+
 };
 
 #endif
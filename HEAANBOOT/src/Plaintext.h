@@ -10,6 +10,9 @@
 
 #include <NTL/ZZ.h>
 #include <NTL/ZZX.h>
+#include <utility>
+
+#include "FlatPoly.h"
 
 using namespace std;
 using namespace NTL;
@@ -17,7 +20,7 @@ using namespace NTL;
 class Plaintext {
 public:
 
-	ZZX mx; ///< message mod X^N + 1
+	FlatPoly mx; ///< message mod X^N + 1
 
 	long logp; ///< number of quantized bits
 	long logq; ///< number of bits in modulus
@@ -28,13 +31,13 @@ public:
 
 	/**
 	 * Plaintext: mx
-	 * @param[in] mx: ZZX polynomial
+	 * @param[in] mx: polynomial with coefficients in [0, 2^logq) or wider
 	 * @param[in] logp: number of quantized bits
 	 * @param[in] logq: number of bits in modulus
 	 * @param[in] slots: number of slots in message
 	 * @param[in] isComplex: option of Message with single real slot
 	 */
-	Plaintext(ZZX mx = ZZX::zero(), long logp = 0, long logq = 0, long slots = 1, bool isComplex = true) : mx(mx), logp(logp), logq(logq), slots(slots), isComplex(isComplex) {}
+	Plaintext(FlatPoly mx = FlatPoly(), long logp = 0, long logq = 0, long slots = 1, bool isComplex = true) : mx(move(mx)), logp(logp), logq(logq), slots(slots), isComplex(isComplex) {}
 
 	/**
 	 * Copy Constructor
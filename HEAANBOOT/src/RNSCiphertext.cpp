@@ -0,0 +1,49 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "RNSCiphertext.h"
+
+#include <algorithm>
+
+RNSCiphertext::RNSCiphertext(uint64_t* ax, uint64_t* bx, long N, long logp, long l, long slots, bool isComplex) : ax(ax), bx(bx), N(N), logp(logp), l(l), slots(slots), isComplex(isComplex) {
+}
+
+RNSCiphertext::RNSCiphertext(const RNSCiphertext& o) : ax(NULL), bx(NULL), N(o.N), logp(o.logp), l(o.l), slots(o.slots), isComplex(o.isComplex) {
+	if(o.ax != NULL) {
+		ax = new uint64_t[N * l];
+		bx = new uint64_t[N * l];
+		copy(o.ax, o.ax + N * l, ax);
+		copy(o.bx, o.bx + N * l, bx);
+	}
+}
+
+RNSCiphertext& RNSCiphertext::operator=(const RNSCiphertext& o) {
+	if(this == &o) {
+		return *this;
+	}
+	delete[] ax;
+	delete[] bx;
+	N = o.N;
+	logp = o.logp;
+	l = o.l;
+	slots = o.slots;
+	isComplex = o.isComplex;
+	ax = NULL;
+	bx = NULL;
+	if(o.ax != NULL) {
+		ax = new uint64_t[N * l];
+		bx = new uint64_t[N * l];
+		copy(o.ax, o.ax + N * l, ax);
+		copy(o.bx, o.bx + N * l, bx);
+	}
+	return *this;
+}
+
+RNSCiphertext::~RNSCiphertext() {
+	delete[] ax;
+	delete[] bx;
+}
@@ -0,0 +1,58 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_RNSCIPHERTEXT_H_
+#define HEAAN_RNSCIPHERTEXT_H_
+
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * RNSCiphertext is an RLWE instance (ax, bx = mx + ex - ax * sx) in ring Z_Q_l[X] / (X^N + 1)
+ * stored as l blocks of N residues in ntt form (see RNSContext)
+ */
+class RNSCiphertext {
+public:
+
+	uint64_t* ax; ///< residues of ax
+	uint64_t* bx; ///< residues of bx
+
+	long N; ///< ring degree
+	long logp; ///< number of quantized bits
+	long l; ///< number of primes in modulus
+	long slots; ///< number of slots in Ciphertext
+
+	bool isComplex; ///< option of Ciphertext with single real slot
+
+	//-----------------------------------------
+
+	/**
+	 * RNSCiphertext = (ax, bx = mx + ex - ax * sx) for secret key sx and error ex
+	 * @param[in] ax: array of l * N residues, owned by ciphertext
+	 * @param[in] bx: array of l * N residues, owned by ciphertext
+	 * @param[in] N: ring degree
+	 * @param[in] logp: number of quantized bits
+	 * @param[in] l: number of primes in modulus
+	 * @param[in] slots: number of slots in a ciphertext
+	 * @param[in] isComplex: option of Ciphertext with single real slot
+	 */
+	RNSCiphertext(uint64_t* ax = NULL, uint64_t* bx = NULL, long N = 0, long logp = 0, long l = 0, long slots = 1, bool isComplex = true);
+
+	/**
+	 * Copy Constructor
+	 */
+	RNSCiphertext(const RNSCiphertext& o);
+
+	RNSCiphertext& operator=(const RNSCiphertext& o);
+
+	virtual ~RNSCiphertext();
+
+};
+
+#endif
@@ -0,0 +1,610 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "RNSContext.h"
+
+#include <NTL/BasicThreadPool.h>
+
+#include "NumUtils.h"
+#include "Sampler.h"
+
+RNSContext::RNSContext(long logN, long logq0, long logp, long L, double sigma, long h) :
+		Context(logN, logq0 + (L - 1) * logp, sigma, h), L(L), logq0(logq0), logp(logp) {
+	if(logq0 > RNS_MAX_PRIME_BITS || logp > RNS_MAX_PRIME_BITS) {
+		throw std::invalid_argument("chain primes should be at most 59 bits");
+	}
+	if(L < 1) {
+		throw std::invalid_argument("chain should have at least one prime");
+	}
+	K = (logQ + RNS_SPECIAL_PRIME_BITS - 2) / (RNS_SPECIAL_PRIME_BITS - 1);
+
+	qVec = new uint64_t[L];
+	pVec = new uint64_t[K];
+	modVec = new uint64_t[L + K];
+	generatePrimes();
+
+	pr0Vec = new uint64_t[L + K];
+	pr1Vec = new uint64_t[L + K];
+	NInvVec = new uint64_t[L + K];
+	NInvShoupVec = new uint64_t[L + K];
+	rootPows = new uint64_t*[L + K];
+	rootPowsShoup = new uint64_t*[L + K];
+	rootPowsInv = new uint64_t*[L + K];
+	rootPowsInvShoup = new uint64_t*[L + K];
+
+	for (long i = 0; i < L + K; ++i) {
+		uint64_t mod = modVec[i];
+		unsigned __int128 pr = ~((unsigned __int128) 0) / mod;
+		pr0Vec[i] = (uint64_t) pr;
+		pr1Vec[i] = (uint64_t) (pr >> 64);
+		NInvVec[i] = RingMultiplier::invMod(N, mod);
+		NInvShoupVec[i] = RingMultiplier::shoup(NInvVec[i], mod);
+		rootPows[i] = new uint64_t[N];
+		rootPowsShoup[i] = new uint64_t[N];
+		rootPowsInv[i] = new uint64_t[N];
+		rootPowsInvShoup[i] = new uint64_t[N];
+		RingMultiplier::rootTables(rootPows[i], rootPowsShoup[i], rootPowsInv[i], rootPowsInvShoup[i], logN, mod);
+	}
+
+	qHatInvModq = new uint64_t*[L];
+	qHatModp = new uint64_t**[L];
+	for (long l = 0; l < L; ++l) {
+		qHatInvModq[l] = new uint64_t[l + 1];
+		qHatModp[l] = new uint64_t*[l + 1];
+		for (long i = 0; i < l + 1; ++i) {
+			uint64_t qHat = 1;
+			for (long j = 0; j < l + 1; ++j) {
+				if(j != i) qHat = mulMod(qHat, qVec[j] % qVec[i], i);
+			}
+			qHatInvModq[l][i] = RingMultiplier::invMod(qHat, qVec[i]);
+			qHatModp[l][i] = new uint64_t[K];
+			for (long k = 0; k < K; ++k) {
+				uint64_t qHatk = 1;
+				for (long j = 0; j < l + 1; ++j) {
+					if(j != i) qHatk = mulMod(qHatk, qVec[j] % pVec[k], L + k);
+				}
+				qHatModp[l][i][k] = qHatk;
+			}
+		}
+	}
+
+	pHatInvModp = new uint64_t[K];
+	pHatModq = new uint64_t*[K];
+	for (long k = 0; k < K; ++k) {
+		uint64_t pHat = 1;
+		for (long j = 0; j < K; ++j) {
+			if(j != k) pHat = mulMod(pHat, pVec[j] % pVec[k], L + k);
+		}
+		pHatInvModp[k] = RingMultiplier::invMod(pHat, pVec[k]);
+		pHatModq[k] = new uint64_t[L];
+		for (long i = 0; i < L; ++i) {
+			uint64_t pHati = 1;
+			for (long j = 0; j < K; ++j) {
+				if(j != k) pHati = mulMod(pHati, pVec[j] % qVec[i], i);
+			}
+			pHatModq[k][i] = pHati;
+		}
+	}
+
+	PModq = new uint64_t[L];
+	PInvModq = new uint64_t[L];
+	PHalfModq = new uint64_t[L];
+	for (long i = 0; i < L; ++i) {
+		uint64_t P = 1;
+		for (long k = 0; k < K; ++k) {
+			P = mulMod(P, pVec[k] % qVec[i], i);
+		}
+		PModq[i] = P;
+		PInvModq[i] = RingMultiplier::invMod(P, qVec[i]);
+		// P is odd, floor(P / 2) = (P - 1) / 2
+		PHalfModq[i] = mulMod((P + qVec[i] - 1) % qVec[i], (qVec[i] + 1) >> 1, i);
+	}
+
+	qInvModq = new uint64_t*[L];
+	for (long l = 0; l < L; ++l) {
+		qInvModq[l] = new uint64_t[l];
+		for (long i = 0; i < l; ++i) {
+			qInvModq[l][i] = RingMultiplier::invMod(qVec[l] % qVec[i], qVec[i]);
+		}
+	}
+}
+
+RNSContext::~RNSContext() {
+	for (long i = 0; i < L + K; ++i) {
+		delete[] rootPows[i];
+		delete[] rootPowsShoup[i];
+		delete[] rootPowsInv[i];
+		delete[] rootPowsInvShoup[i];
+	}
+	delete[] rootPows;
+	delete[] rootPowsShoup;
+	delete[] rootPowsInv;
+	delete[] rootPowsInvShoup;
+
+	for (long l = 0; l < L; ++l) {
+		for (long i = 0; i < l + 1; ++i) {
+			delete[] qHatModp[l][i];
+		}
+		delete[] qHatModp[l];
+		delete[] qHatInvModq[l];
+		delete[] qInvModq[l];
+	}
+	delete[] qHatModp;
+	delete[] qHatInvModq;
+	delete[] qInvModq;
+
+	for (long k = 0; k < K; ++k) {
+		delete[] pHatModq[k];
+	}
+	delete[] pHatModq;
+	delete[] pHatInvModp;
+	delete[] PModq;
+	delete[] PInvModq;
+	delete[] PHalfModq;
+
+	for (auto const& element : crtMap) {
+		delete element.second;
+	}
+
+	delete[] qVec;
+	delete[] pVec;
+	delete[] modVec;
+	delete[] pr0Vec;
+	delete[] pr1Vec;
+	delete[] NInvVec;
+	delete[] NInvShoupVec;
+}
+
+void RNSContext::generatePrimes() {
+	// chain primes are the primes = 1 mod 2N closest to 2^logq0 and 2^logp,
+	// so that rescaling by q_i is close to division by 2^logp
+	for (long i = 0; i < L; ++i) {
+		long bits = i == 0 ? logq0 : logp;
+		uint64_t center = (1UL << bits) + 1;
+		for (long d = 0; ; ++d) {
+			uint64_t cands[2] = {center + d * M, center - d * M};
+			bool found = false;
+			for (long c = 0; c < 2 && !found; ++c) {
+				bool used = false;
+				for (long j = 0; j < i; ++j) {
+					if(qVec[j] == cands[c]) used = true;
+				}
+				if(!used && ProbPrime(ZZ((long) cands[c]))) {
+					qVec[i] = cands[c];
+					found = true;
+				}
+			}
+			if(found) break;
+		}
+	}
+	uint64_t p = (1UL << RNS_SPECIAL_PRIME_BITS) + 1;
+	for (long k = 0; k < K; ) {
+		p -= M;
+		if(ProbPrime(ZZ((long) p))) {
+			pVec[k++] = p;
+		}
+	}
+	for (long i = 0; i < L; ++i) modVec[i] = qVec[i];
+	for (long k = 0; k < K; ++k) modVec[L + k] = pVec[k];
+}
+
+
+//----------------------------------------------------------------------------------
+//   NTT & CRT
+//----------------------------------------------------------------------------------
+
+
+void RNSContext::NTT(uint64_t* a, const long index) {
+	RingMultiplier::NTT(a, N, modVec[index], rootPows[index], rootPowsShoup[index]);
+}
+
+void RNSContext::INTT(uint64_t* a, const long index) {
+	RingMultiplier::INTT(a, N, modVec[index], rootPowsInv[index], rootPowsInvShoup[index], NInvVec[index], NInvShoupVec[index]);
+}
+
+void RNSContext::CRT(uint64_t* res, ZZX& p, const long l, const long k) {
+	long len = min(N, p.rep.length());
+	NTL_EXEC_RANGE(l + k, first, last);
+	for (long j = first; j < last; ++j) {
+		long index = modIndex(j, l);
+		uint64_t* resj = res + (j << logN);
+		long mod = (long) modVec[index];
+		for (long n = 0; n < len; ++n) {
+			resj[n] = (uint64_t) rem(p.rep[n], mod);
+		}
+		for (long n = len; n < N; ++n) {
+			resj[n] = 0;
+		}
+		NTT(resj, index);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RNSContext::CRT(uint64_t* res, long* p, const long l, const long k) {
+	NTL_EXEC_RANGE(l + k, first, last);
+	for (long j = first; j < last; ++j) {
+		long index = modIndex(j, l);
+		uint64_t* resj = res + (j << logN);
+		uint64_t mod = modVec[index];
+		for (long n = 0; n < N; ++n) {
+			resj[n] = p[n] < 0 ? mod - (uint64_t) (-p[n]) : (uint64_t) p[n];
+		}
+		NTT(resj, index);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RNSContext::CRT(uint64_t* res, FlatPoly& p, const long l, const long k) {
+	NTL_EXEC_RANGE(l + k, first, last);
+	for (long j = first; j < last; ++j) {
+		long index = modIndex(j, l);
+		uint64_t* resj = res + (j << logN);
+		uint64_t mod = modVec[index];
+		uint64_t wrap = RingMultiplier::wrapMod(p.limbs, mod, pr0Vec[index], pr1Vec[index]);
+		for (long n = 0; n < N; ++n) {
+			resj[n] = RingMultiplier::residue(p.coeff(n), p.limbs, mod, pr0Vec[index], pr1Vec[index], wrap);
+		}
+		NTT(resj, index);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RNSContext::CRT(uint64_t* res, SmallPoly& p, const long l, const long k) {
+	NTL_EXEC_RANGE(l + k, first, last);
+	for (long j = first; j < last; ++j) {
+		long index = modIndex(j, l);
+		uint64_t* resj = res + (j << logN);
+		uint64_t mod = modVec[index];
+		for (long n = 0; n < N; ++n) {
+			resj[n] = RingMultiplier::residue(p.coeffs[n], mod, pr0Vec[index], pr1Vec[index]);
+		}
+		NTT(resj, index);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+RingCRTData* RNSContext::getCRTData(const long l) {
+	auto it = crtMap.find(l);
+	if(it == crtMap.end()) {
+		it = crtMap.insert(pair<long, RingCRTData*>(l, new RingCRTData(qVec, l))).first;
+	}
+	return it->second;
+}
+
+void RNSContext::reconstruct(ZZX& x, uint64_t* a, const long l) {
+	RingCRTData* crt = getCRTData(l);
+	uint64_t* ra = new uint64_t[l << logN];
+	copy(a, a + (l << logN), ra);
+
+	NTL_EXEC_RANGE(l, first, last);
+	for (long i = first; i < last; ++i) {
+		INTT(ra + (i << logN), i);
+	}
+	NTL_EXEC_RANGE_END;
+
+	x.SetLength(N);
+	NTL_EXEC_RANGE(N, first, last);
+	ZZ acc, tmp;
+	for (long n = first; n < last; ++n) {
+		clear(acc);
+		double y = 0;
+		for (long i = 0; i < l; ++i) {
+			uint64_t s = RingMultiplier::mulModShoup(ra[(i << logN) + n], crt->pHatInvModp[i], crt->pHatInvModpShoup[i], qVec[i]);
+			y += (double) s / (double) qVec[i];
+			NTL::mul(tmp, crt->pHat[i], (long) s);
+			NTL::add(acc, acc, tmp);
+		}
+		long kq = (long) floor(y + 0.5);
+		NTL::mul(tmp, crt->pProd, kq);
+		NTL::sub(x.rep[n], acc, tmp);
+	}
+	NTL_EXEC_RANGE_END;
+	delete[] ra;
+}
+
+
+//----------------------------------------------------------------------------------
+//   ARITHMETIC IN NTT FORM
+//----------------------------------------------------------------------------------
+
+
+void RNSContext::add(uint64_t* res, uint64_t* a, uint64_t* b, const long l, const long k) {
+	for (long j = 0; j < l + k; ++j) {
+		uint64_t mod = modVec[modIndex(j, l)];
+		for (long n = (j << logN); n < ((j + 1) << logN); ++n) {
+			uint64_t sum = a[n] + b[n];
+			res[n] = sum >= mod ? sum - mod : sum;
+		}
+	}
+}
+
+void RNSContext::addAndEqual(uint64_t* a, uint64_t* b, const long l, const long k) {
+	add(a, a, b, l, k);
+}
+
+void RNSContext::sub(uint64_t* res, uint64_t* a, uint64_t* b, const long l, const long k) {
+	for (long j = 0; j < l + k; ++j) {
+		uint64_t mod = modVec[modIndex(j, l)];
+		for (long n = (j << logN); n < ((j + 1) << logN); ++n) {
+			res[n] = a[n] >= b[n] ? a[n] - b[n] : a[n] + mod - b[n];
+		}
+	}
+}
+
+void RNSContext::subAndEqual(uint64_t* a, uint64_t* b, const long l, const long k) {
+	sub(a, a, b, l, k);
+}
+
+void RNSContext::subAndEqual2(uint64_t* a, uint64_t* b, const long l, const long k) {
+	sub(a, b, a, l, k);
+}
+
+void RNSContext::negate(uint64_t* res, uint64_t* a, const long l, const long k) {
+	for (long j = 0; j < l + k; ++j) {
+		uint64_t mod = modVec[modIndex(j, l)];
+		for (long n = (j << logN); n < ((j + 1) << logN); ++n) {
+			res[n] = a[n] == 0 ? 0 : mod - a[n];
+		}
+	}
+}
+
+void RNSContext::negateAndEqual(uint64_t* a, const long l, const long k) {
+	negate(a, a, l, k);
+}
+
+void RNSContext::mul(uint64_t* res, uint64_t* a, uint64_t* b, const long l, const long k) {
+	NTL_EXEC_RANGE(l + k, first, last);
+	for (long j = first; j < last; ++j) {
+		long index = modIndex(j, l);
+		for (long n = (j << logN); n < ((j + 1) << logN); ++n) {
+			res[n] = mulMod(a[n], b[n], index);
+		}
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RNSContext::mulAndEqual(uint64_t* a, uint64_t* b, const long l, const long k) {
+	mul(a, a, b, l, k);
+}
+
+void RNSContext::square(uint64_t* res, uint64_t* a, const long l, const long k) {
+	mul(res, a, a, l, k);
+}
+
+void RNSContext::mulConst(uint64_t* res, uint64_t* a, const ZZ& cnst, const long l, const long k) {
+	for (long j = 0; j < l + k; ++j) {
+		long index = modIndex(j, l);
+		uint64_t mod = modVec[index];
+		uint64_t c = (uint64_t) rem(cnst, (long) mod);
+		uint64_t cShoup = RingMultiplier::shoup(c, mod);
+		for (long n = (j << logN); n < ((j + 1) << logN); ++n) {
+			res[n] = RingMultiplier::mulModShoup(a[n], c, cShoup, mod);
+		}
+	}
+}
+
+void RNSContext::mulConstAndEqual(uint64_t* a, const ZZ& cnst, const long l, const long k) {
+	mulConst(a, a, cnst, l, k);
+}
+
+void RNSContext::addConstAndEqual(uint64_t* a, const ZZ& cnst, const long l) {
+	for (long i = 0; i < l; ++i) {
+		uint64_t mod = qVec[i];
+		uint64_t c = (uint64_t) rem(cnst, (long) mod);
+		for (long n = (i << logN); n < ((i + 1) << logN); ++n) {
+			uint64_t sum = a[n] + c;
+			a[n] = sum >= mod ? sum - mod : sum;
+		}
+	}
+}
+
+void RNSContext::imult(uint64_t* res, uint64_t* a, const long l) {
+	for (long i = 0; i < l; ++i) {
+		uint64_t mod = qVec[i];
+		uint64_t w = rootPows[i][1];
+		uint64_t wShoup = rootPowsShoup[i][1];
+		uint64_t* ai = a + (i << logN);
+		uint64_t* resi = res + (i << logN);
+		for (long n = 0; n < Nh; ++n) {
+			resi[n] = RingMultiplier::mulModShoup(ai[n], w, wShoup, mod);
+		}
+		for (long n = Nh; n < N; ++n) {
+			uint64_t t = RingMultiplier::mulModShoup(ai[n], w, wShoup, mod);
+			resi[n] = t == 0 ? 0 : mod - t;
+		}
+	}
+}
+
+void RNSContext::imultAndEqual(uint64_t* a, const long l) {
+	imult(a, a, l);
+}
+
+void RNSContext::inpower(uint64_t* res, uint64_t* a, const long pow, const long l, const long k) {
+	long* perm = RingMultiplier::getInstance(N).getPermutation(pow);
+	for (long n0 = 0; n0 < N; n0 += NTT_PERM_BLOCK) {
+		long n1 = min(N, n0 + NTT_PERM_BLOCK);
+		for (long j = 0; j < l + k; ++j) {
+			uint64_t* aj = a + (j << logN);
+			uint64_t* resj = res + (j << logN);
+			for (long n = n0; n < n1; ++n) {
+				resj[n] = aj[perm[n]];
+			}
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------------------
+//   MODULUS SWITCHING
+//----------------------------------------------------------------------------------
+
+
+void RNSContext::modUp(uint64_t* res, uint64_t* a, const long l) {
+	uint64_t* ra = new uint64_t[l << logN];
+	copy(a, a + (l << logN), ra);
+	copy(a, a + (l << logN), res);
+
+	NTL_EXEC_RANGE(l, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rai = ra + (i << logN);
+		INTT(rai, i);
+		uint64_t c = qHatInvModq[l - 1][i];
+		uint64_t cShoup = RingMultiplier::shoup(c, qVec[i]);
+		for (long n = 0; n < N; ++n) {
+			rai[n] = RingMultiplier::mulModShoup(rai[n], c, cShoup, qVec[i]);
+		}
+	}
+	NTL_EXEC_RANGE_END;
+
+	NTL_EXEC_RANGE(K, first, last);
+	for (long k = first; k < last; ++k) {
+		uint64_t* resk = res + ((l + k) << logN);
+		uint64_t mod = pVec[k];
+		for (long n = 0; n < N; ++n) {
+			uint64_t acc = 0;
+			for (long i = 0; i < l; ++i) {
+				acc += mulMod(ra[(i << logN) + n], qHatModp[l - 1][i][k], L + k);
+				if(acc >= mod) acc -= mod;
+			}
+			resk[n] = acc;
+		}
+		NTT(resk, L + k);
+	}
+	NTL_EXEC_RANGE_END;
+
+	delete[] ra;
+}
+
+void RNSContext::modDown(uint64_t* res, uint64_t* a, const long l) {
+	NTL_EXEC_RANGE(K, first, last);
+	for (long k = first; k < last; ++k) {
+		uint64_t* ak = a + ((l + k) << logN);
+		INTT(ak, L + k);
+		uint64_t mod = pVec[k];
+		uint64_t half = mod >> 1; // floor(P / 2) mod p_k
+		uint64_t c = pHatInvModp[k];
+		uint64_t cShoup = RingMultiplier::shoup(c, mod);
+		for (long n = 0; n < N; ++n) {
+			uint64_t v = ak[n] + half;
+			if(v >= mod) v -= mod;
+			ak[n] = RingMultiplier::mulModShoup(v, c, cShoup, mod);
+		}
+	}
+	NTL_EXEC_RANGE_END;
+
+	NTL_EXEC_RANGE(l, first, last);
+	uint64_t* t = new uint64_t[N];
+	for (long i = first; i < last; ++i) {
+		uint64_t mod = qVec[i];
+		for (long n = 0; n < N; ++n) {
+			uint64_t acc = 0;
+			for (long k = 0; k < K; ++k) {
+				acc += mulMod(a[((l + k) << logN) + n], pHatModq[k][i], i);
+				if(acc >= mod) acc -= mod;
+			}
+			t[n] = acc >= PHalfModq[i] ? acc - PHalfModq[i] : acc + mod - PHalfModq[i];
+		}
+		NTT(t, i);
+		uint64_t c = PInvModq[i];
+		uint64_t cShoup = RingMultiplier::shoup(c, mod);
+		uint64_t* ai = a + (i << logN);
+		uint64_t* resi = res + (i << logN);
+		for (long n = 0; n < N; ++n) {
+			uint64_t diff = ai[n] >= t[n] ? ai[n] - t[n] : ai[n] + mod - t[n];
+			resi[n] = RingMultiplier::mulModShoup(diff, c, cShoup, mod);
+		}
+	}
+	delete[] t;
+	NTL_EXEC_RANGE_END;
+}
+
+void RNSContext::rescale(uint64_t* res, uint64_t* a, const long l) {
+	uint64_t qlast = qVec[l - 1];
+	uint64_t* top = new uint64_t[N];
+	copy(a + ((l - 1) << logN), a + (l << logN), top);
+	INTT(top, l - 1);
+
+	NTL_EXEC_RANGE(l - 1, first, last);
+	uint64_t* t = new uint64_t[N];
+	for (long i = first; i < last; ++i) {
+		uint64_t mod = qVec[i];
+		uint64_t qlastMod = qlast % mod;
+		for (long n = 0; n < N; ++n) {
+			uint64_t v = top[n] % mod;
+			if(top[n] > (qlast >> 1)) {
+				v = v >= qlastMod ? v - qlastMod : v + mod - qlastMod;
+			}
+			t[n] = v;
+		}
+		NTT(t, i);
+		uint64_t c = qInvModq[l - 1][i];
+		uint64_t cShoup = RingMultiplier::shoup(c, mod);
+		uint64_t* ai = a + (i << logN);
+		uint64_t* resi = res + (i << logN);
+		for (long n = 0; n < N; ++n) {
+			uint64_t diff = ai[n] >= t[n] ? ai[n] - t[n] : ai[n] + mod - t[n];
+			resi[n] = RingMultiplier::mulModShoup(diff, c, cShoup, mod);
+		}
+	}
+	delete[] t;
+	NTL_EXEC_RANGE_END;
+
+	delete[] top;
+}
+
+void RNSContext::modRaise(uint64_t* res, uint64_t* a, const long l) {
+	uint64_t q0 = qVec[0];
+	uint64_t* base = new uint64_t[N];
+	copy(a, a + N, base);
+	INTT(base, 0);
+
+	NTL_EXEC_RANGE(l, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t mod = qVec[i];
+		uint64_t q0Mod = q0 % mod;
+		uint64_t* resi = res + (i << logN);
+		for (long n = 0; n < N; ++n) {
+			uint64_t v = base[n] % mod;
+			if(base[n] > (q0 >> 1)) {
+				v = v >= q0Mod ? v - q0Mod : v + mod - q0Mod;
+			}
+			resi[n] = v;
+		}
+		NTT(resi, i);
+	}
+	NTL_EXEC_RANGE_END;
+
+	delete[] base;
+}
+
+
+//----------------------------------------------------------------------------------
+//   SAMPLING
+//----------------------------------------------------------------------------------
+
+
+void RNSContext::sampleUniform(uint64_t* res, const long l, const long k) {
+	Sampler& sampler = Sampler::local();
+	for (long j = 0; j < l + k; ++j) {
+		uint64_t mod = modVec[modIndex(j, l)];
+		for (long n = (j << logN); n < ((j + 1) << logN); ++n) {
+			res[n] = sampler.nextBelow(mod);
+		}
+	}
+}
+
+void RNSContext::sampleGauss(uint64_t* res, const long l, const long k) {
+	ZZX ex;
+	NumUtils::sampleGauss(ex, N, sigma);
+	CRT(res, ex, l, k);
+}
+
+void RNSContext::sampleZO(uint64_t* res, const long l, const long k) {
+	ZZX vx;
+	NumUtils::sampleZO(vx, N);
+	CRT(res, vx, l, k);
+}
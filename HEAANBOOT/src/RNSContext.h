@@ -0,0 +1,261 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_RNSCONTEXT_H_
+#define HEAAN_RNSCONTEXT_H_
+
+#include <NTL/ZZ.h>
+#include <NTL/ZZX.h>
+#include <cstdint>
+
+#include "Context.h"
+#include "RingMultiplier.h"
+
+using namespace std;
+using namespace NTL;
+
+static const long RNS_SPECIAL_PRIME_BITS = 60; ///< special primes are in (2^59, 2^60)
+static const long RNS_MAX_PRIME_BITS = 59; ///< bound on bit size of chain primes
+
+/**
+ * Context of the RNS backend: the modulus of level l is Q_l = q_0 * ... * q_{l-1} for a chain of
+ * word-size ntt primes q_0 ~ 2^logq0, q_i ~ 2^logp (i > 0), and key switching is done modulo
+ * Q_L * P for special primes P = p_0 * ... * p_{K-1}.
+ *
+ * Polynomials are flat arrays of residues: block i (N words starting at i << logN) holds the
+ * residues mod the i-th prime in ntt form. Arrays over Q_l * P hold l chain blocks followed by
+ * K special blocks. Rescaling by q_{l-1} approximates division by 2^logp.
+ *
+ * Encoding and bootstrapping auxiliary data are inherited from Context.
+ */
+class RNSContext : public Context {
+public:
+
+	long L; ///< number of primes in the chain
+	long K; ///< number of special primes
+	long logq0; ///< bit size of base prime q_0
+	long logp; ///< bit size of primes q_1, ..., q_{L-1}
+
+	uint64_t* qVec; ///< chain primes
+	uint64_t* pVec; ///< special primes
+
+	uint64_t* modVec; ///< all primes: q_0, ..., q_{L-1}, p_0, ..., p_{K-1}
+	uint64_t* pr0Vec; ///< low words of barrett constants floor(2^128 / mod)
+	uint64_t* pr1Vec; ///< high words of barrett constants floor(2^128 / mod)
+	uint64_t* NInvVec; ///< N^{-1} mod prime
+	uint64_t* NInvShoupVec; ///< shoup constants of NInvVec
+
+	uint64_t** rootPows; ///< powers of primitive 2N-th root of unity in bit-reversed order
+	uint64_t** rootPowsShoup; ///< shoup constants of rootPows
+	uint64_t** rootPowsInv; ///< powers of inverse root of unity in bit-reversed order
+	uint64_t** rootPowsInvShoup; ///< shoup constants of rootPowsInv
+
+	uint64_t** qHatInvModq; ///< [l - 1][i]: (Q_l / q_i)^{-1} mod q_i
+	uint64_t*** qHatModp; ///< [l - 1][i][k]: (Q_l / q_i) mod p_k
+	uint64_t* pHatInvModp; ///< [k]: (P / p_k)^{-1} mod p_k
+	uint64_t** pHatModq; ///< [k][i]: (P / p_k) mod q_i
+	uint64_t* PModq; ///< [i]: P mod q_i
+	uint64_t* PInvModq; ///< [i]: P^{-1} mod q_i
+	uint64_t* PHalfModq; ///< [i]: floor(P / 2) mod q_i
+	uint64_t** qInvModq; ///< [l][i]: q_l^{-1} mod q_i
+
+	map<long, RingCRTData*> crtMap; ///< CRT constants for Q_l
+
+	RNSContext(long logN, long logq0, long logp, long L, double sigma = 3.2, long h = 64);
+
+	virtual ~RNSContext();
+
+
+	//----------------------------------------------------------------------------------
+	//   NTT & CRT
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * index of j-th block of an array over Q_l (j < l) or Q_l * P (l <= j < l + K)
+	 */
+	inline long modIndex(const long j, const long l) {
+		return j < l ? j : L + j - l;
+	}
+
+	/**
+	 * forward ntt of one block in place
+	 * @param[in, out] a: array of N residues
+	 * @param[in] index: prime index in modVec
+	 */
+	void NTT(uint64_t* a, const long index);
+
+	/**
+	 * inverse ntt of one block in place
+	 * @param[in, out] a: array of N residues
+	 * @param[in] index: prime index in modVec
+	 */
+	void INTT(uint64_t* a, const long index);
+
+	/**
+	 * residues of a polynomial with signed coefficients in ntt form
+	 * @param[out] res: array of (l + k) * N residues
+	 * @param[in] p: polynomial
+	 * @param[in] l: number of chain primes
+	 * @param[in] k: number of special primes (0 or K)
+	 */
+	void CRT(uint64_t* res, ZZX& p, const long l, const long k = 0);
+
+	/**
+	 * residues of a polynomial with small signed coefficients in ntt form
+	 * @param[out] res: array of (l + k) * N residues
+	 * @param[in] p: array of N coefficients
+	 * @param[in] l: number of chain primes
+	 * @param[in] k: number of special primes (0 or K)
+	 */
+	void CRT(uint64_t* res, long* p, const long l, const long k = 0);
+
+	/**
+	 * residues of a polynomial with signed coefficients in two's complement in ntt form
+	 * @param[out] res: array of (l + k) * N residues
+	 * @param[in] p: polynomial, e.g. an encoding from BootContext
+	 * @param[in] l: number of chain primes
+	 * @param[in] k: number of special primes (0 or K)
+	 */
+	void CRT(uint64_t* res, FlatPoly& p, const long l, const long k = 0);
+
+	/**
+	 * residues of a polynomial with int64_t coefficients in ntt form
+	 * @param[out] res: array of (l + k) * N residues
+	 * @param[in] p: polynomial, e.g. an encoding from BootContext
+	 * @param[in] l: number of chain primes
+	 * @param[in] k: number of special primes (0 or K)
+	 */
+	void CRT(uint64_t* res, SmallPoly& p, const long l, const long k = 0);
+
+	/**
+	 * centered polynomial with given residues mod Q_l
+	 * @param[out] x: polynomial with coefficients in (-Q_l/2, Q_l/2]
+	 * @param[in] a: array of l * N residues in ntt form
+	 * @param[in] l: number of chain primes
+	 */
+	void reconstruct(ZZX& x, uint64_t* a, const long l);
+
+	/**
+	 * CRT constants for Q_l
+	 */
+	RingCRTData* getCRTData(const long l);
+
+
+	//----------------------------------------------------------------------------------
+	//   ARITHMETIC IN NTT FORM
+	//----------------------------------------------------------------------------------
+
+
+	void add(uint64_t* res, uint64_t* a, uint64_t* b, const long l, const long k = 0);
+
+	void addAndEqual(uint64_t* a, uint64_t* b, const long l, const long k = 0);
+
+	void sub(uint64_t* res, uint64_t* a, uint64_t* b, const long l, const long k = 0);
+
+	void subAndEqual(uint64_t* a, uint64_t* b, const long l, const long k = 0);
+
+	/**
+	 * a -> b - a
+	 */
+	void subAndEqual2(uint64_t* a, uint64_t* b, const long l, const long k = 0);
+
+	void negate(uint64_t* res, uint64_t* a, const long l, const long k = 0);
+
+	void negateAndEqual(uint64_t* a, const long l, const long k = 0);
+
+	void mul(uint64_t* res, uint64_t* a, uint64_t* b, const long l, const long k = 0);
+
+	void mulAndEqual(uint64_t* a, uint64_t* b, const long l, const long k = 0);
+
+	void square(uint64_t* res, uint64_t* a, const long l, const long k = 0);
+
+	/**
+	 * multiplication by integer constant
+	 */
+	void mulConst(uint64_t* res, uint64_t* a, const ZZ& cnst, const long l, const long k = 0);
+
+	void mulConstAndEqual(uint64_t* a, const ZZ& cnst, const long l, const long k = 0);
+
+	/**
+	 * addition of integer constant (constant polynomial)
+	 */
+	void addConstAndEqual(uint64_t* a, const ZZ& cnst, const long l);
+
+	/**
+	 * multiplication by X^{N/2}: ntt values at psi^(2j+1) get factor i = psi^{N/2} or -i
+	 */
+	void imult(uint64_t* res, uint64_t* a, const long l);
+
+	void imultAndEqual(uint64_t* a, const long l);
+
+	/**
+	 * a(X) -> a(X^pow) in ntt form
+	 * @param[out] res: array of (l + k) * N residues
+	 * @param[in] a: array of (l + k) * N residues
+	 * @param[in] pow: odd power
+	 */
+	void inpower(uint64_t* res, uint64_t* a, const long pow, const long l, const long k = 0);
+
+
+	//----------------------------------------------------------------------------------
+	//   MODULUS SWITCHING
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * extends array over Q_l to Q_l * P by fast basis conversion
+	 * @param[out] res: array of (l + K) * N residues
+	 * @param[in] a: array of l * N residues
+	 */
+	void modUp(uint64_t* res, uint64_t* a, const long l);
+
+	/**
+	 * divides array over Q_l * P by P with rounding: floor(P / 2) is added to the special part
+	 * before its basis conversion and subtracted from the converted part
+	 * @param[out] res: array of l * N residues
+	 * @param[in, out] a: array of (l + K) * N residues, special blocks are destroyed
+	 */
+	void modDown(uint64_t* res, uint64_t* a, const long l);
+
+	/**
+	 * divides array over Q_l by q_{l-1} with rounding
+	 * @param[out] res: array of (l - 1) * N residues
+	 * @param[in] a: array of l * N residues
+	 */
+	void rescale(uint64_t* res, uint64_t* a, const long l);
+
+	/**
+	 * lifts residues mod q_0 to centered representatives mod Q_l
+	 * @param[out] res: array of l * N residues
+	 * @param[in] a: array of N residues mod q_0
+	 */
+	void modRaise(uint64_t* res, uint64_t* a, const long l);
+
+
+	//----------------------------------------------------------------------------------
+	//   SAMPLING
+	//----------------------------------------------------------------------------------
+
+
+	void sampleUniform(uint64_t* res, const long l, const long k = 0);
+
+	void sampleGauss(uint64_t* res, const long l, const long k = 0);
+
+	void sampleZO(uint64_t* res, const long l, const long k = 0);
+
+private:
+
+	uint64_t mulMod(const uint64_t a, const uint64_t b, const long index) {
+		return RingMultiplier::mulModBarrett(a, b, modVec[index], pr0Vec[index], pr1Vec[index]);
+	}
+
+	void generatePrimes();
+
+};
+
+#endif
@@ -0,0 +1,45 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "RNSKey.h"
+
+#include <algorithm>
+
+RNSKey::RNSKey(uint64_t* ax, uint64_t* bx, long size) : ax(ax), bx(bx), size(size) {
+}
+
+RNSKey::RNSKey(const RNSKey& o) : ax(NULL), bx(NULL), size(o.size) {
+	if(o.ax != NULL) {
+		ax = new uint64_t[size];
+		bx = new uint64_t[size];
+		copy(o.ax, o.ax + size, ax);
+		copy(o.bx, o.bx + size, bx);
+	}
+}
+
+RNSKey& RNSKey::operator=(const RNSKey& o) {
+	if(this == &o) {
+		return *this;
+	}
+	delete[] ax;
+	delete[] bx;
+	size = o.size;
+	ax = NULL;
+	bx = NULL;
+	if(o.ax != NULL) {
+		ax = new uint64_t[size];
+		bx = new uint64_t[size];
+		copy(o.ax, o.ax + size, ax);
+		copy(o.bx, o.bx + size, bx);
+	}
+	return *this;
+}
+
+RNSKey::~RNSKey() {
+	delete[] ax;
+	delete[] bx;
+}
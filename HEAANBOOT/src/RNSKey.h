@@ -0,0 +1,38 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_RNSKEY_H_
+#define HEAAN_RNSKEY_H_
+
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * RNSKey is an RLWE instance (ax, bx = mx + ex - ax * sx) over Q_L * P
+ * stored as L + K blocks of N residues in ntt form (see RNSContext)
+ */
+class RNSKey {
+public:
+
+	uint64_t* ax;
+	uint64_t* bx;
+
+	long size; ///< number of residues in ax and bx
+
+	RNSKey(uint64_t* ax = NULL, uint64_t* bx = NULL, long size = 0);
+
+	RNSKey(const RNSKey& o);
+
+	RNSKey& operator=(const RNSKey& o);
+
+	virtual ~RNSKey();
+
+};
+
+#endif
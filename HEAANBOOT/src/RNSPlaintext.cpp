@@ -0,0 +1,42 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "RNSPlaintext.h"
+
+#include <algorithm>
+
+RNSPlaintext::RNSPlaintext(uint64_t* mx, long N, long logp, long l, long slots, bool isComplex) : mx(mx), N(N), logp(logp), l(l), slots(slots), isComplex(isComplex) {
+}
+
+RNSPlaintext::RNSPlaintext(const RNSPlaintext& o) : mx(NULL), N(o.N), logp(o.logp), l(o.l), slots(o.slots), isComplex(o.isComplex) {
+	if(o.mx != NULL) {
+		mx = new uint64_t[N * l];
+		copy(o.mx, o.mx + N * l, mx);
+	}
+}
+
+RNSPlaintext& RNSPlaintext::operator=(const RNSPlaintext& o) {
+	if(this == &o) {
+		return *this;
+	}
+	delete[] mx;
+	N = o.N;
+	logp = o.logp;
+	l = o.l;
+	slots = o.slots;
+	isComplex = o.isComplex;
+	mx = NULL;
+	if(o.mx != NULL) {
+		mx = new uint64_t[N * l];
+		copy(o.mx, o.mx + N * l, mx);
+	}
+	return *this;
+}
+
+RNSPlaintext::~RNSPlaintext() {
+	delete[] mx;
+}
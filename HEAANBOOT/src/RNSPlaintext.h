@@ -0,0 +1,51 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_RNSPLAINTEXT_H_
+#define HEAAN_RNSPLAINTEXT_H_
+
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+class RNSPlaintext {
+public:
+
+	uint64_t* mx; ///< residues of message mod X^N + 1 in ntt form
+
+	long N; ///< ring degree
+	long logp; ///< number of quantized bits
+	long l; ///< number of primes in modulus
+	long slots; ///< number of slots in message
+
+	bool isComplex; ///< option of Message with single real slot
+
+	//-----------------------------------------
+
+	/**
+	 * RNSPlaintext: mx
+	 * @param[in] mx: array of l * N residues, owned by plaintext
+	 * @param[in] N: ring degree
+	 * @param[in] logp: number of quantized bits
+	 * @param[in] l: number of primes in modulus
+	 * @param[in] slots: number of slots in message
+	 * @param[in] isComplex: option of Message with single real slot
+	 */
+	RNSPlaintext(uint64_t* mx = NULL, long N = 0, long logp = 0, long l = 0, long slots = 1, bool isComplex = true);
+
+	/**
+	 * Copy Constructor
+	 */
+	RNSPlaintext(const RNSPlaintext& o);
+
+	RNSPlaintext& operator=(const RNSPlaintext& o);
+
+	virtual ~RNSPlaintext();
+};
+
+#endif
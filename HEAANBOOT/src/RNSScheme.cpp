@@ -0,0 +1,1006 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "RNSScheme.h"
+
+#include <NTL/BasicThreadPool.h>
+#include <NTL/RR.h>
+#include <NTL/ZZ.h>
+#include <NTL/ZZX.h>
+
+#include "EvaluatorUtils.h"
+
+//-----------------------------------------
+
+RNSScheme::RNSScheme(RNSContext& context) : context(context) {
+}
+
+RNSScheme::RNSScheme(SecretKey& secretKey, RNSContext& context) : context(context) {
+	addEncKey(secretKey);
+	addMultKey(secretKey);
+};
+
+
+//----------------------------------------------------------------------------------
+//   KEYS GENERATION
+//----------------------------------------------------------------------------------
+
+
+void RNSScheme::addEncKey(SecretKey& secretKey) {
+	long L = context.L;
+	uint64_t* ax = new uint64_t[L << context.logN];
+	uint64_t* bx = new uint64_t[L << context.logN];
+	uint64_t* sx = new uint64_t[L << context.logN];
+
+	context.CRT(sx, secretKey.sx, L);
+	context.sampleUniform(ax, L);
+	context.sampleGauss(bx, L);
+	context.mulAndEqual(sx, ax, L);
+	context.subAndEqual(bx, sx, L);
+
+	delete[] sx;
+	keyMap.insert(pair<long, RNSKey>(ENCRYPTION, RNSKey(ax, bx, L << context.logN)));
+}
+
+void RNSScheme::addSwitchKey(SecretKey& secretKey, uint64_t* sxNew, RNSKey& key) {
+	long L = context.L;
+	long K = context.K;
+	long size = (L + K) << context.logN;
+	uint64_t* ax = new uint64_t[size];
+	uint64_t* bx = new uint64_t[size];
+	uint64_t* sx = new uint64_t[size];
+
+	context.CRT(sx, secretKey.sx, L, K);
+	context.sampleUniform(ax, L, K);
+	context.sampleGauss(bx, L, K);
+	context.mulAndEqual(sx, ax, L, K);
+	context.subAndEqual(bx, sx, L, K);
+
+	// bx += P * sxNew, which vanishes mod the special primes
+	for (long i = 0; i < L; ++i) {
+		uint64_t mod = context.qVec[i];
+		uint64_t c = context.PModq[i];
+		uint64_t cShoup = RingMultiplier::shoup(c, mod);
+		for (long n = (i << context.logN); n < ((i + 1) << context.logN); ++n) {
+			uint64_t sum = bx[n] + RingMultiplier::mulModShoup(sxNew[n], c, cShoup, mod);
+			bx[n] = sum >= mod ? sum - mod : sum;
+		}
+	}
+
+	delete[] sx;
+	key = RNSKey(ax, bx, size);
+}
+
+void RNSScheme::addMultKey(SecretKey& secretKey) {
+	long L = context.L;
+	uint64_t* sxsx = new uint64_t[L << context.logN];
+	context.CRT(sxsx, secretKey.sx, L);
+	context.square(sxsx, sxsx, L);
+
+	RNSKey key;
+	addSwitchKey(secretKey, sxsx, key);
+	delete[] sxsx;
+	keyMap.insert(pair<long, RNSKey>(MULTIPLICATION, key));
+}
+
+void RNSScheme::addConjKey(SecretKey& secretKey) {
+	long L = context.L;
+	uint64_t* sx = new uint64_t[L << context.logN];
+	uint64_t* sxconj = new uint64_t[L << context.logN];
+	context.CRT(sx, secretKey.sx, L);
+	context.inpower(sxconj, sx, context.M - 1, L);
+
+	RNSKey key;
+	addSwitchKey(secretKey, sxconj, key);
+	delete[] sx;
+	delete[] sxconj;
+	keyMap.insert(pair<long, RNSKey>(CONJUGATION, key));
+}
+
+void RNSScheme::addLeftRotKey(SecretKey& secretKey, long rot) {
+	long L = context.L;
+	uint64_t* sx = new uint64_t[L << context.logN];
+	uint64_t* sxrot = new uint64_t[L << context.logN];
+	context.CRT(sx, secretKey.sx, L);
+	context.inpower(sxrot, sx, context.rotGroup[rot], L);
+
+	RNSKey key;
+	addSwitchKey(secretKey, sxrot, key);
+	delete[] sx;
+	delete[] sxrot;
+	leftRotKeyMap.insert(pair<long, RNSKey>(rot, key));
+}
+
+void RNSScheme::addLeftRotKeys(SecretKey& secretKey) {
+	for (long i = 0; i < context.logNh; ++i) {
+		long idx = 1 << i;
+		if(leftRotKeyMap.find(idx) == leftRotKeyMap.end()) {
+			addLeftRotKey(secretKey, idx);
+		}
+	}
+}
+
+void RNSScheme::addRightRotKeys(SecretKey& secretKey) {
+	for (long i = 0; i < context.logNh; ++i) {
+		long idx = context.Nh - (1 << i);
+		if(leftRotKeyMap.find(idx) == leftRotKeyMap.end()) {
+			addLeftRotKey(secretKey, idx);
+		}
+	}
+}
+
+void RNSScheme::addBootKey(SecretKey& secretKey, long logSlots) {
+	context.addBootContext(logSlots, context.logp);
+
+	if(keyMap.find(CONJUGATION) == keyMap.end()) {
+		addConjKey(secretKey);
+	}
+	addLeftRotKeys(secretKey);
+
+	long logk = logSlots / 2;
+	long k = 1 << logk;
+	long m = 1 << (logSlots - logk);
+
+	for (long i = 1; i < k; ++i) {
+		if(leftRotKeyMap.find(i) == leftRotKeyMap.end()) {
+			addLeftRotKey(secretKey, i);
+		}
+	}
+
+	for (long i = 1; i < m; ++i) {
+		long idx = i * k;
+		if(leftRotKeyMap.find(idx) == leftRotKeyMap.end()) {
+			addLeftRotKey(secretKey, idx);
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------------------
+//   ENCODING & DECODING
+//----------------------------------------------------------------------------------
+
+
+RNSPlaintext RNSScheme::encode(double* vals, long slots, long logp, long l) {
+	ZZX mx = context.encode(vals, slots, logp);
+	uint64_t* rx = new uint64_t[l << context.logN];
+	context.CRT(rx, mx, l);
+	return RNSPlaintext(rx, context.N, logp, l, slots, false);
+}
+
+RNSPlaintext RNSScheme::encode(complex<double>* vals, long slots, long logp, long l) {
+	ZZX mx = context.encode(vals, slots, logp);
+	uint64_t* rx = new uint64_t[l << context.logN];
+	context.CRT(rx, mx, l);
+	return RNSPlaintext(rx, context.N, logp, l, slots, true);
+}
+
+complex<double>* RNSScheme::decode(RNSPlaintext& msg) {
+	ZZX mx;
+	context.reconstruct(mx, msg.mx, msg.l);
+
+	long slots = msg.slots;
+	long gap = context.Nh / slots;
+	complex<double>* res = new complex<double>[slots];
+	for (long i = 0, idx = 0; i < slots; ++i, idx += gap) {
+		res[i].real(EvaluatorUtils::scaleDownToReal(mx.rep[idx], msg.logp));
+		res[i].imag(EvaluatorUtils::scaleDownToReal(mx.rep[idx + context.Nh], msg.logp));
+	}
+	context.fftSpecial(res, slots);
+	return res;
+}
+
+RNSPlaintext RNSScheme::encodeSingle(double val, long logp, long l) {
+	ZZX mx = context.encodeSingle(val, logp);
+	uint64_t* rx = new uint64_t[l << context.logN];
+	context.CRT(rx, mx, l);
+	return RNSPlaintext(rx, context.N, logp, l, 1, false);
+}
+
+RNSPlaintext RNSScheme::encodeSingle(complex<double> val, long logp, long l) {
+	ZZX mx = context.encodeSingle(val, logp);
+	uint64_t* rx = new uint64_t[l << context.logN];
+	context.CRT(rx, mx, l);
+	return RNSPlaintext(rx, context.N, logp, l, 1, true);
+}
+
+complex<double> RNSScheme::decodeSingle(RNSPlaintext& msg) {
+	ZZX mx;
+	context.reconstruct(mx, msg.mx, msg.l);
+
+	complex<double> res;
+	res.real(EvaluatorUtils::scaleDownToReal(mx.rep[0], msg.logp));
+	if(msg.isComplex) {
+		res.imag(EvaluatorUtils::scaleDownToReal(mx.rep[context.Nh], msg.logp));
+	}
+	return res;
+}
+
+
+//----------------------------------------------------------------------------------
+//   ENCRYPTION & DECRYPTION
+//----------------------------------------------------------------------------------
+
+
+RNSCiphertext RNSScheme::encryptMsg(RNSPlaintext& msg) {
+	long l = msg.l;
+	RNSKey& key = keyMap.at(ENCRYPTION);
+	uint64_t* ax = new uint64_t[l << context.logN];
+	uint64_t* bx = new uint64_t[l << context.logN];
+	uint64_t* vx = new uint64_t[l << context.logN];
+	uint64_t* ex = new uint64_t[l << context.logN];
+
+	context.sampleZO(vx, l);
+	context.mul(ax, vx, key.ax, l);
+	context.sampleGauss(ex, l);
+	context.addAndEqual(ax, ex, l);
+
+	context.mul(bx, vx, key.bx, l);
+	context.sampleGauss(ex, l);
+	context.addAndEqual(bx, ex, l);
+
+	context.addAndEqual(bx, msg.mx, l);
+
+	delete[] vx;
+	delete[] ex;
+	return RNSCiphertext(ax, bx, context.N, msg.logp, l, msg.slots, msg.isComplex);
+}
+
+RNSPlaintext RNSScheme::decryptMsg(SecretKey& secretKey, RNSCiphertext& cipher) {
+	long l = cipher.l;
+	uint64_t* mx = new uint64_t[l << context.logN];
+	context.CRT(mx, secretKey.sx, l);
+	context.mulAndEqual(mx, cipher.ax, l);
+	context.addAndEqual(mx, cipher.bx, l);
+	return RNSPlaintext(mx, context.N, cipher.logp, l, cipher.slots, cipher.isComplex);
+}
+
+RNSCiphertext RNSScheme::encrypt(double* vals, long slots, long logp, long l) {
+	RNSPlaintext msg = encode(vals, slots, logp, l);
+	return encryptMsg(msg);
+}
+
+RNSCiphertext RNSScheme::encrypt(complex<double>* vals, long slots, long logp, long l) {
+	RNSPlaintext msg = encode(vals, slots, logp, l);
+	return encryptMsg(msg);
+}
+
+complex<double>* RNSScheme::decrypt(SecretKey& secretKey, RNSCiphertext& cipher) {
+	RNSPlaintext msg = decryptMsg(secretKey, cipher);
+	return decode(msg);
+}
+
+RNSCiphertext RNSScheme::encryptSingle(double val, long logp, long l) {
+	RNSPlaintext msg = encodeSingle(val, logp, l);
+	return encryptMsg(msg);
+}
+
+RNSCiphertext RNSScheme::encryptSingle(complex<double> val, long logp, long l) {
+	RNSPlaintext msg = encodeSingle(val, logp, l);
+	return encryptMsg(msg);
+}
+
+complex<double> RNSScheme::decryptSingle(SecretKey& secretKey, RNSCiphertext& cipher) {
+	RNSPlaintext msg = decryptMsg(secretKey, cipher);
+	return decodeSingle(msg);
+}
+
+
+//----------------------------------------------------------------------------------
+//   HOMOMORPHIC OPERATIONS
+//----------------------------------------------------------------------------------
+
+
+RNSCiphertext RNSScheme::negate(RNSCiphertext& cipher) {
+	RNSCiphertext res = cipher;
+	negateAndEqual(res);
+	return res;
+}
+
+void RNSScheme::negateAndEqual(RNSCiphertext& cipher) {
+	context.negateAndEqual(cipher.ax, cipher.l);
+	context.negateAndEqual(cipher.bx, cipher.l);
+}
+
+RNSCiphertext RNSScheme::add(RNSCiphertext& cipher1, RNSCiphertext& cipher2) {
+	RNSCiphertext res = cipher1;
+	addAndEqual(res, cipher2);
+	return res;
+}
+
+void RNSScheme::addAndEqual(RNSCiphertext& cipher1, RNSCiphertext& cipher2) {
+	context.addAndEqual(cipher1.ax, cipher2.ax, cipher1.l);
+	context.addAndEqual(cipher1.bx, cipher2.bx, cipher1.l);
+}
+
+RNSCiphertext RNSScheme::addConst(RNSCiphertext& cipher, double cnst, long logp) {
+	RNSCiphertext res = cipher;
+	addConstAndEqual(res, cnst, logp);
+	return res;
+}
+
+RNSCiphertext RNSScheme::addConst(RNSCiphertext& cipher, RR& cnst, long logp) {
+	RNSCiphertext res = cipher;
+	addConstAndEqual(res, cnst, logp);
+	return res;
+}
+
+void RNSScheme::addConstAndEqual(RNSCiphertext& cipher, double cnst, long logp) {
+	ZZ cnstZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst, cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst, logp);
+	context.addConstAndEqual(cipher.bx, cnstZZ, cipher.l);
+}
+
+void RNSScheme::addConstAndEqual(RNSCiphertext& cipher, RR& cnst, long logp) {
+	ZZ cnstZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst, cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst, logp);
+	context.addConstAndEqual(cipher.bx, cnstZZ, cipher.l);
+}
+
+RNSCiphertext RNSScheme::sub(RNSCiphertext& cipher1, RNSCiphertext& cipher2) {
+	RNSCiphertext res = cipher1;
+	subAndEqual(res, cipher2);
+	return res;
+}
+
+void RNSScheme::subAndEqual(RNSCiphertext& cipher1, RNSCiphertext& cipher2) {
+	context.subAndEqual(cipher1.ax, cipher2.ax, cipher1.l);
+	context.subAndEqual(cipher1.bx, cipher2.bx, cipher1.l);
+}
+
+void RNSScheme::subAndEqual2(RNSCiphertext& cipher1, RNSCiphertext& cipher2) {
+	context.subAndEqual2(cipher2.ax, cipher1.ax, cipher2.l);
+	context.subAndEqual2(cipher2.bx, cipher1.bx, cipher2.l);
+}
+
+RNSCiphertext RNSScheme::imult(RNSCiphertext& cipher) {
+	RNSCiphertext res = cipher;
+	imultAndEqual(res);
+	return res;
+}
+
+RNSCiphertext RNSScheme::idiv(RNSCiphertext& cipher) {
+	RNSCiphertext res = cipher;
+	idivAndEqual(res);
+	return res;
+}
+
+void RNSScheme::imultAndEqual(RNSCiphertext& cipher) {
+	context.imultAndEqual(cipher.ax, cipher.l);
+	context.imultAndEqual(cipher.bx, cipher.l);
+}
+
+void RNSScheme::idivAndEqual(RNSCiphertext& cipher) {
+	imultAndEqual(cipher);
+	negateAndEqual(cipher);
+}
+
+RNSCiphertext RNSScheme::mult(RNSCiphertext& cipher1, RNSCiphertext& cipher2) {
+	RNSCiphertext res = cipher1;
+	multAndEqual(res, cipher2);
+	return res;
+}
+
+void RNSScheme::multAndEqual(RNSCiphertext& cipher1, RNSCiphertext& cipher2) {
+	long l = cipher1.l;
+	long size = l << context.logN;
+	RNSKey& key = keyMap.at(MULTIPLICATION);
+
+	uint64_t* axax = new uint64_t[size];
+	uint64_t* axbx = new uint64_t[size];
+	uint64_t* bxbx = new uint64_t[size];
+	uint64_t* tmp = new uint64_t[size];
+
+	context.mul(axax, cipher1.ax, cipher2.ax, l);
+	context.mul(bxbx, cipher1.bx, cipher2.bx, l);
+	context.mul(axbx, cipher1.ax, cipher2.bx, l);
+	context.mul(tmp, cipher1.bx, cipher2.ax, l);
+	context.addAndEqual(axbx, tmp, l);
+
+	keySwitch(cipher1.ax, cipher1.bx, axax, key, l);
+
+	context.addAndEqual(cipher1.ax, axbx, l);
+	context.addAndEqual(cipher1.bx, bxbx, l);
+	cipher1.logp += cipher2.logp;
+
+	delete[] axax;
+	delete[] axbx;
+	delete[] bxbx;
+	delete[] tmp;
+}
+
+RNSCiphertext RNSScheme::square(RNSCiphertext& cipher) {
+	RNSCiphertext res = cipher;
+	squareAndEqual(res);
+	return res;
+}
+
+void RNSScheme::squareAndEqual(RNSCiphertext& cipher) {
+	long l = cipher.l;
+	long size = l << context.logN;
+	RNSKey& key = keyMap.at(MULTIPLICATION);
+
+	uint64_t* axax = new uint64_t[size];
+	uint64_t* axbx = new uint64_t[size];
+	uint64_t* bxbx = new uint64_t[size];
+
+	context.square(axax, cipher.ax, l);
+	context.square(bxbx, cipher.bx, l);
+	context.mul(axbx, cipher.ax, cipher.bx, l);
+	context.addAndEqual(axbx, axbx, l);
+
+	keySwitch(cipher.ax, cipher.bx, axax, key, l);
+
+	context.addAndEqual(cipher.ax, axbx, l);
+	context.addAndEqual(cipher.bx, bxbx, l);
+	cipher.logp *= 2;
+
+	delete[] axax;
+	delete[] axbx;
+	delete[] bxbx;
+}
+
+RNSCiphertext RNSScheme::multByConst(RNSCiphertext& cipher, double cnst, long logp) {
+	RNSCiphertext res = cipher;
+	multByConstAndEqual(res, cnst, logp);
+	return res;
+}
+
+RNSCiphertext RNSScheme::multByConst(RNSCiphertext& cipher, RR& cnst, long logp) {
+	RNSCiphertext res = cipher;
+	multByConstAndEqual(res, cnst, logp);
+	return res;
+}
+
+RNSCiphertext RNSScheme::multByConst(RNSCiphertext& cipher, complex<double> cnst, long logp) {
+	RNSCiphertext res = cipher;
+	multByConstAndEqual(res, cnst, logp);
+	return res;
+}
+
+void RNSScheme::multByConstAndEqual(RNSCiphertext& cipher, double cnst, long logp) {
+	ZZ cnstZZ = EvaluatorUtils::scaleUpToZZ(cnst, logp);
+	context.mulConstAndEqual(cipher.ax, cnstZZ, cipher.l);
+	context.mulConstAndEqual(cipher.bx, cnstZZ, cipher.l);
+	cipher.logp += logp;
+}
+
+void RNSScheme::multByConstAndEqual(RNSCiphertext& cipher, RR& cnst, long logp) {
+	ZZ cnstZZ = EvaluatorUtils::scaleUpToZZ(cnst, logp);
+	context.mulConstAndEqual(cipher.ax, cnstZZ, cipher.l);
+	context.mulConstAndEqual(cipher.bx, cnstZZ, cipher.l);
+	cipher.logp += logp;
+}
+
+void RNSScheme::multByConstAndEqual(RNSCiphertext& cipher, complex<double> cnst, long logp) {
+	ZZ cnstrZZ = EvaluatorUtils::scaleUpToZZ(cnst.real(), logp);
+	ZZ cnstiZZ = EvaluatorUtils::scaleUpToZZ(cnst.imag(), logp);
+	RNSCiphertext ci = imult(cipher);
+
+	context.mulConstAndEqual(cipher.ax, cnstrZZ, cipher.l);
+	context.mulConstAndEqual(cipher.bx, cnstrZZ, cipher.l);
+	context.mulConstAndEqual(ci.ax, cnstiZZ, cipher.l);
+	context.mulConstAndEqual(ci.bx, cnstiZZ, cipher.l);
+	addAndEqual(cipher, ci);
+	cipher.logp += logp;
+}
+
+RNSCiphertext RNSScheme::multByConstVec(RNSCiphertext& cipher, complex<double>* cnstVec, long slots, long logp) {
+	ZZX cmx = context.encode(cnstVec, slots, logp);
+	return multByPoly(cipher, cmx, logp);
+}
+
+void RNSScheme::multByConstVecAndEqual(RNSCiphertext& cipher, complex<double>* cnstVec, long slots, long logp) {
+	ZZX cmx = context.encode(cnstVec, slots, logp);
+	multByPolyAndEqual(cipher, cmx, logp);
+}
+
+RNSCiphertext RNSScheme::multByPoly(RNSCiphertext& cipher, ZZX& poly, long logp) {
+	RNSCiphertext res = cipher;
+	multByPolyAndEqual(res, poly, logp);
+	return res;
+}
+
+void RNSScheme::multByPolyAndEqual(RNSCiphertext& cipher, ZZX& poly, long logp) {
+	uint64_t* rpoly = new uint64_t[cipher.l << context.logN];
+	context.CRT(rpoly, poly, cipher.l);
+	context.mulAndEqual(cipher.ax, rpoly, cipher.l);
+	context.mulAndEqual(cipher.bx, rpoly, cipher.l);
+	cipher.logp += logp;
+	delete[] rpoly;
+}
+
+RNSCiphertext RNSScheme::multByPoly(RNSCiphertext& cipher, FlatPoly& poly, long logp) {
+	RNSCiphertext res = cipher;
+	multByPolyAndEqual(res, poly, logp);
+	return res;
+}
+
+void RNSScheme::multByPolyAndEqual(RNSCiphertext& cipher, FlatPoly& poly, long logp) {
+	uint64_t* rpoly = new uint64_t[cipher.l << context.logN];
+	context.CRT(rpoly, poly, cipher.l);
+	context.mulAndEqual(cipher.ax, rpoly, cipher.l);
+	context.mulAndEqual(cipher.bx, rpoly, cipher.l);
+	cipher.logp += logp;
+	delete[] rpoly;
+}
+
+RNSCiphertext RNSScheme::multByPoly(RNSCiphertext& cipher, SmallPoly& poly, long logp) {
+	RNSCiphertext res = cipher;
+	multByPolyAndEqual(res, poly, logp);
+	return res;
+}
+
+void RNSScheme::multByPolyAndEqual(RNSCiphertext& cipher, SmallPoly& poly, long logp) {
+	uint64_t* rpoly = new uint64_t[cipher.l << context.logN];
+	context.CRT(rpoly, poly, cipher.l);
+	context.mulAndEqual(cipher.ax, rpoly, cipher.l);
+	context.mulAndEqual(cipher.bx, rpoly, cipher.l);
+	cipher.logp += logp;
+	delete[] rpoly;
+}
+
+RNSCiphertext RNSScheme::divByPo2(RNSCiphertext& cipher, long bits) {
+	RNSCiphertext res = cipher;
+	divByPo2AndEqual(res, bits);
+	return res;
+}
+
+void RNSScheme::divByPo2AndEqual(RNSCiphertext& cipher, long bits) {
+	while(bits > 0) {
+		long b = min(bits, context.logp);
+		scaleByConstAndEqual(cipher, pow(2.0, -b));
+		bits -= b;
+	}
+}
+
+void RNSScheme::scaleByConstAndEqual(RNSCiphertext& cipher, double cnst) {
+	ZZ cnstZZ = EvaluatorUtils::scaleUpToZZ(cnst, context.logp);
+	context.mulConstAndEqual(cipher.ax, cnstZZ, cipher.l);
+	context.mulConstAndEqual(cipher.bx, cnstZZ, cipher.l);
+	context.rescale(cipher.ax, cipher.ax, cipher.l);
+	context.rescale(cipher.bx, cipher.bx, cipher.l);
+	cipher.l -= 1;
+}
+
+
+//----------------------------------------------------------------------------------
+//   RESCALING & MODULUS DOWN
+//----------------------------------------------------------------------------------
+
+
+RNSCiphertext RNSScheme::reScaleBy(RNSCiphertext& cipher, long dl) {
+	RNSCiphertext res = cipher;
+	reScaleByAndEqual(res, dl);
+	return res;
+}
+
+RNSCiphertext RNSScheme::reScaleTo(RNSCiphertext& cipher, long l) {
+	RNSCiphertext res = cipher;
+	reScaleToAndEqual(res, l);
+	return res;
+}
+
+void RNSScheme::reScaleByAndEqual(RNSCiphertext& cipher, long dl) {
+	for (long i = 0; i < dl; ++i) {
+		context.rescale(cipher.ax, cipher.ax, cipher.l);
+		context.rescale(cipher.bx, cipher.bx, cipher.l);
+		cipher.l -= 1;
+		cipher.logp -= context.logp;
+	}
+}
+
+void RNSScheme::reScaleToAndEqual(RNSCiphertext& cipher, long l) {
+	reScaleByAndEqual(cipher, cipher.l - l);
+}
+
+RNSCiphertext RNSScheme::modDownBy(RNSCiphertext& cipher, long dl) {
+	RNSCiphertext res = cipher;
+	modDownByAndEqual(res, dl);
+	return res;
+}
+
+void RNSScheme::modDownByAndEqual(RNSCiphertext& cipher, long dl) {
+	cipher.l -= dl;
+}
+
+RNSCiphertext RNSScheme::modDownTo(RNSCiphertext& cipher, long l) {
+	RNSCiphertext res = cipher;
+	modDownToAndEqual(res, l);
+	return res;
+}
+
+void RNSScheme::modDownToAndEqual(RNSCiphertext& cipher, long l) {
+	cipher.l = l;
+}
+
+
+//----------------------------------------------------------------------------------
+//   ROTATIONS & CONJUGATIONS
+//----------------------------------------------------------------------------------
+
+
+void RNSScheme::keySwitch(uint64_t* axres, uint64_t* bxres, uint64_t* ax, RNSKey& key, long l) {
+	long K = context.K;
+	long logN = context.logN;
+	uint64_t* axup = new uint64_t[(l + K) << logN];
+	uint64_t* axmult = new uint64_t[(l + K) << logN];
+	uint64_t* bxmult = new uint64_t[(l + K) << logN];
+
+	context.modUp(axup, ax, l);
+
+	// key blocks of Q_l are the first l of Q_L, special blocks follow all L chain blocks
+	context.mul(axmult, axup, key.ax, l);
+	context.mul(bxmult, axup, key.bx, l);
+	context.mul(axmult + (l << logN), axup + (l << logN), key.ax + (context.L << logN), 0, K);
+	context.mul(bxmult + (l << logN), axup + (l << logN), key.bx + (context.L << logN), 0, K);
+
+	context.modDown(axres, axmult, l);
+	context.modDown(bxres, bxmult, l);
+
+	delete[] axup;
+	delete[] axmult;
+	delete[] bxmult;
+}
+
+RNSCiphertext RNSScheme::leftRotateFast(RNSCiphertext& cipher, long rotSlots) {
+	RNSCiphertext res = cipher;
+	leftRotateAndEqualFast(res, rotSlots);
+	return res;
+}
+
+void RNSScheme::leftRotateAndEqualFast(RNSCiphertext& cipher, long rotSlots) {
+	long l = cipher.l;
+	RNSKey& key = leftRotKeyMap.at(rotSlots);
+	uint64_t* axrot = new uint64_t[l << context.logN];
+	uint64_t* bxrot = new uint64_t[l << context.logN];
+
+	context.inpower(bxrot, cipher.bx, context.rotGroup[rotSlots], l);
+	context.inpower(axrot, cipher.ax, context.rotGroup[rotSlots], l);
+
+	keySwitch(cipher.ax, cipher.bx, axrot, key, l);
+	context.addAndEqual(cipher.bx, bxrot, l);
+
+	delete[] axrot;
+	delete[] bxrot;
+}
+
+RNSCiphertext RNSScheme::leftRotateByPo2(RNSCiphertext& cipher, long logRotSlots) {
+	long rotSlots = (1 << logRotSlots);
+	return leftRotateFast(cipher, rotSlots);
+}
+
+void RNSScheme::leftRotateByPo2AndEqual(RNSCiphertext& cipher, long logRotSlots) {
+	long rotSlots = (1 << logRotSlots);
+	leftRotateAndEqualFast(cipher, rotSlots);
+}
+
+RNSCiphertext RNSScheme::rightRotateByPo2(RNSCiphertext& cipher, long logRotSlots) {
+	long rotSlots = context.Nh - (1 << logRotSlots);
+	return leftRotateFast(cipher, rotSlots);
+}
+
+void RNSScheme::rightRotateByPo2AndEqual(RNSCiphertext& cipher, long logRotSlots) {
+	long rotSlots = context.Nh - (1 << logRotSlots);
+	leftRotateAndEqualFast(cipher, rotSlots);
+}
+
+RNSCiphertext RNSScheme::leftRotate(RNSCiphertext& cipher, long rotSlots) {
+	RNSCiphertext res = cipher;
+	leftRotateAndEqual(res, rotSlots);
+	return res;
+}
+
+void RNSScheme::leftRotateAndEqual(RNSCiphertext& cipher, long rotSlots) {
+	long remrotSlots = rotSlots % cipher.slots;
+	long logrotSlots = log2((double)remrotSlots) + 1;
+	for (long i = 0; i < logrotSlots; ++i) {
+		if(bit(remrotSlots, i)) {
+			leftRotateByPo2AndEqual(cipher, i);
+		}
+	}
+}
+
+RNSCiphertext RNSScheme::rightRotate(RNSCiphertext& cipher, long rotSlots) {
+	RNSCiphertext res = cipher;
+	rightRotateAndEqual(res, rotSlots);
+	return res;
+}
+
+void RNSScheme::rightRotateAndEqual(RNSCiphertext& cipher, long rotSlots) {
+	long remrotSlots = rotSlots % cipher.slots;
+	long logrotSlots = log2((double)remrotSlots) + 1;
+	for (long i = 0; i < logrotSlots; ++i) {
+		if(bit(remrotSlots, i)) {
+			rightRotateByPo2AndEqual(cipher, i);
+		}
+	}
+}
+
+RNSCiphertext RNSScheme::conjugate(RNSCiphertext& cipher) {
+	RNSCiphertext res = cipher;
+	conjugateAndEqual(res);
+	return res;
+}
+
+void RNSScheme::conjugateAndEqual(RNSCiphertext& cipher) {
+	long l = cipher.l;
+	RNSKey& key = keyMap.at(CONJUGATION);
+	uint64_t* axconj = new uint64_t[l << context.logN];
+	uint64_t* bxconj = new uint64_t[l << context.logN];
+
+	context.inpower(bxconj, cipher.bx, context.M - 1, l);
+	context.inpower(axconj, cipher.ax, context.M - 1, l);
+
+	keySwitch(cipher.ax, cipher.bx, axconj, key, l);
+	context.addAndEqual(cipher.bx, bxconj, l);
+
+	delete[] axconj;
+	delete[] bxconj;
+}
+
+
+//----------------------------------------------------------------------------------
+//   BOOTSTRAPPING
+//----------------------------------------------------------------------------------
+
+
+void RNSScheme::modRaiseAndEqual(RNSCiphertext& cipher) {
+	long L = context.L;
+	uint64_t* ax = new uint64_t[L << context.logN];
+	uint64_t* bx = new uint64_t[L << context.logN];
+
+	context.modRaise(ax, cipher.ax, L);
+	context.modRaise(bx, cipher.bx, L);
+
+	delete[] cipher.ax;
+	delete[] cipher.bx;
+	cipher.ax = ax;
+	cipher.bx = bx;
+	cipher.l = L;
+}
+
+void RNSScheme::coeffToSlotAndEqual(RNSCiphertext& cipher) {
+	long slots = cipher.slots;
+	long logSlots = log2(slots);
+	long logk = logSlots / 2;
+	long k = 1 << logk;
+
+	RNSCiphertext* rotvec = new RNSCiphertext[k];
+	rotvec[0] = cipher;
+
+	NTL_EXEC_RANGE(k - 1, first, last);
+	for (long j = first; j < last; ++j) {
+		rotvec[j + 1] = leftRotateFast(rotvec[0], j + 1);
+	}
+	NTL_EXEC_RANGE_END;
+
+	BootContext& bootContext = context.bootContextMap.at(logSlots);
+
+	RNSCiphertext* tmpvec = new RNSCiphertext[k];
+
+	NTL_EXEC_RANGE(k, first, last);
+	for (long j = first; j < last; ++j) {
+		tmpvec[j] = multByPoly(rotvec[j], bootContext.pvec[j], bootContext.logp);
+	}
+	NTL_EXEC_RANGE_END;
+
+	for (long j = 1; j < k; ++j) {
+		addAndEqual(tmpvec[0], tmpvec[j]);
+	}
+	cipher = tmpvec[0];
+
+	for (long ki = k; ki < slots; ki += k) {
+		NTL_EXEC_RANGE(k, first, last);
+		for (long j = first; j < last; ++j) {
+			tmpvec[j] = multByPoly(rotvec[j], bootContext.pvec[j + ki], bootContext.logp);
+		}
+		NTL_EXEC_RANGE_END;
+		for (long j = 1; j < k; ++j) {
+			addAndEqual(tmpvec[0], tmpvec[j]);
+		}
+		leftRotateAndEqualFast(tmpvec[0], ki);
+		addAndEqual(cipher, tmpvec[0]);
+	}
+	reScaleByAndEqual(cipher, 1);
+	delete[] rotvec;
+	delete[] tmpvec;
+}
+
+void RNSScheme::slotToCoeffAndEqual(RNSCiphertext& cipher) {
+	long slots = cipher.slots;
+	long logSlots = log2(slots);
+	long logk = logSlots / 2;
+	long k = 1 << logk;
+
+	RNSCiphertext* rotvec = new RNSCiphertext[k];
+	rotvec[0] = cipher;
+
+	NTL_EXEC_RANGE(k - 1, first, last);
+	for (long j = first; j < last; ++j) {
+		rotvec[j + 1] = leftRotateFast(rotvec[0], j + 1);
+	}
+	NTL_EXEC_RANGE_END;
+
+	BootContext& bootContext = context.bootContextMap.at(logSlots);
+
+	RNSCiphertext* tmpvec = new RNSCiphertext[k];
+
+	NTL_EXEC_RANGE(k, first, last);
+	for (long j = first; j < last; ++j) {
+		tmpvec[j] = multByPoly(rotvec[j], bootContext.pvecInv[j], bootContext.logp);
+	}
+	NTL_EXEC_RANGE_END;
+
+	for (long j = 1; j < k; ++j) {
+		addAndEqual(tmpvec[0], tmpvec[j]);
+	}
+	cipher = tmpvec[0];
+
+	for (long ki = k; ki < slots; ki += k) {
+		NTL_EXEC_RANGE(k, first, last);
+		for (long j = first; j < last; ++j) {
+			tmpvec[j] = multByPoly(rotvec[j], bootContext.pvecInv[j + ki], bootContext.logp);
+		}
+		NTL_EXEC_RANGE_END;
+		for (long j = 1; j < k; ++j) {
+			addAndEqual(tmpvec[0], tmpvec[j]);
+		}
+		leftRotateAndEqualFast(tmpvec[0], ki);
+		addAndEqual(cipher, tmpvec[0]);
+	}
+	reScaleByAndEqual(cipher, 1);
+	delete[] rotvec;
+	delete[] tmpvec;
+}
+
+void RNSScheme::exp2piAndEqual(RNSCiphertext& cipher) {
+	long logp = context.logp;
+
+	RNSCiphertext cipher2 = square(cipher);
+	reScaleByAndEqual(cipher2, 1); // cipher2.l : l - 1
+
+	RNSCiphertext cipher4 = square(cipher2);
+	reScaleByAndEqual(cipher4, 1); // cipher4.l : l - 2
+
+	RR c = 1/(2*Pi);
+	RNSCiphertext cipher01 = addConst(cipher, c, logp); // cipher01.l : l
+
+	c = 2*Pi;
+	multByConstAndEqual(cipher01, c, logp);
+	reScaleByAndEqual(cipher01, 1); // cipher01.l : l - 1
+
+	c = 3/(2*Pi);
+	RNSCiphertext cipher23 = addConst(cipher, c, logp); // cipher23.l : l
+
+	c = 4*Pi*Pi*Pi/3;
+	multByConstAndEqual(cipher23, c, logp);
+	reScaleByAndEqual(cipher23, 1); // cipher23.l : l - 1
+
+	multAndEqual(cipher23, cipher2);
+	reScaleByAndEqual(cipher23, 1); // cipher23.l : l - 2
+
+	addAndEqual(cipher23, cipher01); // cipher23.l : l - 2
+
+	c = 5/(2*Pi);
+	RNSCiphertext cipher45 = addConst(cipher, c, logp); // cipher45.l : l
+
+	c = 4*Pi*Pi*Pi*Pi*Pi/15;
+	multByConstAndEqual(cipher45, c, logp);
+	reScaleByAndEqual(cipher45, 1); // cipher45.l : l - 1
+
+	c = 7/(2*Pi);
+	addConstAndEqual(cipher, c, logp); // cipher.l : l
+
+	c = 8*Pi*Pi*Pi*Pi*Pi*Pi*Pi/315;
+	multByConstAndEqual(cipher, c, logp);
+	reScaleByAndEqual(cipher, 1); // cipher.l : l - 1
+
+	multAndEqual(cipher, cipher2);
+	reScaleByAndEqual(cipher, 1); // cipher.l : l - 2
+
+	modDownByAndEqual(cipher45, 1); // cipher45.l : l - 2
+	addAndEqual(cipher, cipher45); // cipher.l : l - 2
+
+	multAndEqual(cipher, cipher4);
+	reScaleByAndEqual(cipher, 1); // cipher.l : l - 3
+
+	modDownByAndEqual(cipher23, 1);
+	addAndEqual(cipher, cipher23); // cipher.l : l - 3
+}
+
+void RNSScheme::evalExpAndEqual(RNSCiphertext& cipher, long logT, long logI) {
+	long slots = cipher.slots;
+	long logSlots = log2(slots);
+	BootContext& bootContext = context.bootContextMap.at(logSlots);
+	if(logSlots == 0 && !cipher.isComplex) {
+		imultAndEqual(cipher);
+		divByPo2AndEqual(cipher, logT);
+		exp2piAndEqual(cipher);
+		for (long i = 0; i < logI + logT; ++i) {
+			squareAndEqual(cipher);
+			reScaleByAndEqual(cipher, 1);
+		}
+		RNSCiphertext tmp = conjugate(cipher);
+		subAndEqual(cipher, tmp);
+		idivAndEqual(cipher);
+		RR c = 0.25/Pi;
+		multByConstAndEqual(cipher, c, bootContext.logp);
+	} else if(logSlots < context.logNh) {
+		RNSCiphertext tmp = conjugate(cipher);
+		subAndEqual(cipher, tmp);
+		divByPo2AndEqual(cipher, logT + 1);
+		exp2piAndEqual(cipher);
+		for (long i = 0; i < logI + logT; ++i) {
+			squareAndEqual(cipher);
+			reScaleByAndEqual(cipher, 1);
+		}
+		tmp = conjugate(cipher);
+		subAndEqual(cipher, tmp);
+
+		tmp = multByPoly(cipher, bootContext.p1, bootContext.logp);
+		RNSCiphertext tmprot = leftRotateFast(tmp, slots);
+		addAndEqual(tmp, tmprot);
+		multByPolyAndEqual(cipher, bootContext.p2, bootContext.logp);
+		tmprot = leftRotateFast(cipher, slots);
+		addAndEqual(cipher, tmprot);
+		addAndEqual(cipher, tmp);
+	} else {
+		RNSCiphertext tmp = conjugate(cipher);
+		RNSCiphertext c2 = sub(cipher, tmp);
+		addAndEqual(cipher, tmp);
+		imultAndEqual(cipher);
+		divByPo2AndEqual(cipher, logT + 1);
+		divByPo2AndEqual(c2, logT + 1);
+		exp2piAndEqual(cipher);
+		exp2piAndEqual(c2);
+		for (long i = 0; i < logI + logT; ++i) {
+			squareAndEqual(c2);
+			squareAndEqual(cipher);
+			reScaleByAndEqual(c2, 1);
+			reScaleByAndEqual(cipher, 1);
+		}
+		tmp = conjugate(c2);
+		subAndEqual(c2, tmp);
+		tmp = conjugate(cipher);
+		subAndEqual(cipher, tmp);
+		imultAndEqual(cipher);
+		subAndEqual2(c2, cipher);
+		RR c = 0.25/Pi;
+		multByConstAndEqual(cipher, c, bootContext.logp);
+	}
+	reScaleByAndEqual(cipher, 1);
+	// the input was scaled by 2^logp / (16 q_0), the output is brought back to the scale of the coefficients mod q_0
+	scaleByConstAndEqual(cipher, ldexp((double) context.qVec[0], 4 - context.logp - logI));
+}
+
+void RNSScheme::bootstrapAndEqual(RNSCiphertext& cipher, long logT, long logI) {
+	long logSlots = log2(cipher.slots);
+	long logp = cipher.logp;
+
+	modDownToAndEqual(cipher, 1);
+	modRaiseAndEqual(cipher);
+
+	cipher.logp = context.logp;
+	for (long i = logSlots; i < context.logNh; ++i) {
+		RNSCiphertext rot = leftRotateByPo2(cipher, i);
+		addAndEqual(cipher, rot);
+	}
+
+	// coefficients x + q_0 I are scaled by 2^logp / (16 q_0) instead of 2^{-4} for power-of-two q_0
+	double scale = ldexp(1.0, context.logp - 4) / (double) context.qVec[0];
+	if (logSlots == 0 && !cipher.isComplex) {
+		RNSCiphertext cconj = conjugate(cipher);
+		addAndEqual(cipher, cconj);
+		scaleByConstAndEqual(cipher, ldexp(scale, -context.logN));
+		evalExpAndEqual(cipher, logT, logI);
+	} else {
+		scaleByConstAndEqual(cipher, ldexp(scale, -context.logNh));
+		coeffToSlotAndEqual(cipher);
+		evalExpAndEqual(cipher, logT, logI);
+		slotToCoeffAndEqual(cipher);
+	}
+	cipher.logp = logp;
+}
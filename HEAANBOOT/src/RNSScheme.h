@@ -0,0 +1,384 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_RNSSCHEME_H_
+#define HEAAN_RNSSCHEME_H_
+
+#include <NTL/RR.h>
+#include <NTL/ZZX.h>
+#include <complex>
+
+#include "Common.h"
+#include "RNSCiphertext.h"
+#include "RNSContext.h"
+#include "RNSKey.h"
+#include "RNSPlaintext.h"
+#include "Scheme.h"
+#include "SecretKey.h"
+
+using namespace std;
+using namespace NTL;
+
+/**
+ * Scheme over the RNS backend. Mirrors the Scheme API with the modulus given by the number of
+ * primes l instead of logq: rescaling drops the last prime (approximately dividing by 2^logp of
+ * the context) and key switching uses the special primes of the context.
+ */
+class RNSScheme {
+public:
+	RNSContext& context;
+
+	map<long, RNSKey> keyMap; ///< contain Encryption, Multiplication and Conjugation keys, if generated
+	map<long, RNSKey> leftRotKeyMap; ///< contain left rotation keys, if generated
+
+	RNSScheme(RNSContext& context);
+
+	RNSScheme(SecretKey& secretKey, RNSContext& context);
+
+
+	//----------------------------------------------------------------------------------
+	//   KEYS GENERATION
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * generates key for public encryption (key is stored in keyMap)
+	 */
+	void addEncKey(SecretKey& secretKey);
+
+	/**
+	 * generates key for conjugation (key is stored in keyMap)
+	 */
+	void addConjKey(SecretKey& secretKey);
+
+	/**
+	 * generates key for multiplication (key is stored in keyMap)
+	 */
+	void addMultKey(SecretKey& secretKey);
+
+	/**
+	 * generates key for left rotation (key is stored in leftRotKeyMap)
+	 */
+	void addLeftRotKey(SecretKey& secretKey, long rot);
+
+	/**
+	 * generates all keys for power-of-two left rotations (keys are stored in leftRotKeyMap)
+	 */
+	void addLeftRotKeys(SecretKey& secretKey);
+
+	/**
+	 * generates all keys for power-of-two right rotations (keys are stored in leftRotKeyMap)
+	 */
+	void addRightRotKeys(SecretKey& secretKey);
+
+	/**
+	 * generates key for bootstrapping (keys are stored in leftRotKeyMap and keyMap),
+	 * auxiliary encodings are quantized with logp bits of the context
+	 */
+	void addBootKey(SecretKey& secretKey, long logSlots);
+
+
+	//----------------------------------------------------------------------------------
+	//   ENCODING & DECODING
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * encodes an array of double values into message
+	 * @param[in] vals: array of double values
+	 * @param[in] slots: array size
+	 * @param[in] logp: number of quantized bits
+	 * @param[in] l: number of primes in modulus
+	 * @return message
+	 */
+	RNSPlaintext encode(double* vals, long slots, long logp, long l);
+
+	/**
+	 * encodes an array of complex values into message
+	 * @param[in] vals: array of complex values
+	 * @param[in] slots: array size
+	 * @param[in] logp: number of quantized bits
+	 * @param[in] l: number of primes in modulus
+	 * @return message
+	 */
+	RNSPlaintext encode(complex<double>* vals, long slots, long logp, long l);
+
+	/**
+	 * decodes message into array of complex values
+	 * @param[in] msg: message
+	 * @return decoded array of complex values
+	 */
+	complex<double>* decode(RNSPlaintext& msg);
+
+	/**
+	 * encodes a single double value into message
+	 */
+	RNSPlaintext encodeSingle(double val, long logp, long l);
+
+	/**
+	 * encodes a single complex value into message
+	 */
+	RNSPlaintext encodeSingle(complex<double> val, long logp, long l);
+
+	/**
+	 * decodes message into a single complex value
+	 */
+	complex<double> decodeSingle(RNSPlaintext& msg);
+
+
+	//----------------------------------------------------------------------------------
+	//   ENCRYPTION & DECRYPTION
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * encrypts message into ciphertext using public key encyption
+	 */
+	RNSCiphertext encryptMsg(RNSPlaintext& msg);
+
+	/**
+	 * decrypts ciphertext into message
+	 */
+	RNSPlaintext decryptMsg(SecretKey& secretKey, RNSCiphertext& cipher);
+
+	RNSCiphertext encrypt(double* vals, long slots, long logp, long l);
+
+	RNSCiphertext encrypt(complex<double>* vals, long slots, long logp, long l);
+
+	complex<double>* decrypt(SecretKey& secretKey, RNSCiphertext& cipher);
+
+	RNSCiphertext encryptSingle(double val, long logp, long l);
+
+	RNSCiphertext encryptSingle(complex<double> val, long logp, long l);
+
+	complex<double> decryptSingle(SecretKey& secretKey, RNSCiphertext& cipher);
+
+
+	//----------------------------------------------------------------------------------
+	//   HOMOMORPHIC OPERATIONS
+	//----------------------------------------------------------------------------------
+
+
+	RNSCiphertext negate(RNSCiphertext& cipher);
+
+	void negateAndEqual(RNSCiphertext& cipher);
+
+	/**
+	 * addition of ciphertexts, cipher2 may be at a higher level
+	 * @return ciphertext(m1 + m2)
+	 */
+	RNSCiphertext add(RNSCiphertext& cipher1, RNSCiphertext& cipher2);
+
+	void addAndEqual(RNSCiphertext& cipher1, RNSCiphertext& cipher2);
+
+	/**
+	 * @return ciphertext(m + cnst * 2^logp)
+	 */
+	RNSCiphertext addConst(RNSCiphertext& cipher, double cnst, long logp = -1);
+
+	RNSCiphertext addConst(RNSCiphertext& cipher, RR& cnst, long logp = -1);
+
+	void addConstAndEqual(RNSCiphertext& cipher, double cnst, long logp = -1);
+
+	void addConstAndEqual(RNSCiphertext& cipher, RR& cnst, long logp = -1);
+
+	RNSCiphertext sub(RNSCiphertext& cipher1, RNSCiphertext& cipher2);
+
+	void subAndEqual(RNSCiphertext& cipher1, RNSCiphertext& cipher2);
+
+	/**
+	 * @param[in] cipher1: ciphertext(m1)
+	 * @param[in, out] cipher2: ciphertext(m2) -> ciphertext(m1 - m2)
+	 */
+	void subAndEqual2(RNSCiphertext& cipher1, RNSCiphertext& cipher2);
+
+	RNSCiphertext imult(RNSCiphertext& cipher);
+
+	RNSCiphertext idiv(RNSCiphertext& cipher);
+
+	void imultAndEqual(RNSCiphertext& cipher);
+
+	void idivAndEqual(RNSCiphertext& cipher);
+
+	/**
+	 * multiplication of ciphertexts, cipher2 may be at a higher level.
+	 * This algorithm contain relinearization.
+	 * To manage the noise we usually need rescaling method after multiplication
+	 * @return ciphertext(m1 * m2)
+	 */
+	RNSCiphertext mult(RNSCiphertext& cipher1, RNSCiphertext& cipher2);
+
+	void multAndEqual(RNSCiphertext& cipher1, RNSCiphertext& cipher2);
+
+	RNSCiphertext square(RNSCiphertext& cipher);
+
+	void squareAndEqual(RNSCiphertext& cipher);
+
+	/**
+	 * @return ciphertext(m * (cnst * 2^logp))
+	 */
+	RNSCiphertext multByConst(RNSCiphertext& cipher, double cnst, long logp);
+
+	RNSCiphertext multByConst(RNSCiphertext& cipher, RR& cnst, long logp);
+
+	RNSCiphertext multByConst(RNSCiphertext& cipher, complex<double> cnst, long logp);
+
+	void multByConstAndEqual(RNSCiphertext& cipher, double cnst, long logp);
+
+	void multByConstAndEqual(RNSCiphertext& cipher, RR& cnst, long logp);
+
+	void multByConstAndEqual(RNSCiphertext& cipher, complex<double> cnst, long logp);
+
+	RNSCiphertext multByConstVec(RNSCiphertext& cipher, complex<double>* cnstVec, long slots, long logp);
+
+	void multByConstVecAndEqual(RNSCiphertext& cipher, complex<double>* cnstVec, long slots, long logp);
+
+	/**
+	 * multiplication by polynomial
+	 * @param[in] poly: polynomial - encoding(cnst) with logp quantized bits
+	 * @return ciphertext(m * cnst)
+	 */
+	RNSCiphertext multByPoly(RNSCiphertext& cipher, ZZX& poly, long logp);
+
+	void multByPolyAndEqual(RNSCiphertext& cipher, ZZX& poly, long logp);
+
+	RNSCiphertext multByPoly(RNSCiphertext& cipher, FlatPoly& poly, long logp);
+
+	void multByPolyAndEqual(RNSCiphertext& cipher, FlatPoly& poly, long logp);
+
+	RNSCiphertext multByPoly(RNSCiphertext& cipher, SmallPoly& poly, long logp);
+
+	void multByPolyAndEqual(RNSCiphertext& cipher, SmallPoly& poly, long logp);
+
+	/**
+	 * division by 2^bits, consumes one prime per logp bits of the context
+	 * @return ciphertext(m / 2^bits)
+	 */
+	RNSCiphertext divByPo2(RNSCiphertext& cipher, long bits);
+
+	void divByPo2AndEqual(RNSCiphertext& cipher, long bits);
+
+	/**
+	 * multiplication by small real constant followed by rescaling, consumes one prime
+	 * @param[in, out] cipher: ciphertext(m) -> ciphertext(cnst * m)
+	 */
+	void scaleByConstAndEqual(RNSCiphertext& cipher, double cnst);
+
+
+	//----------------------------------------------------------------------------------
+	//   RESCALING & MODULUS DOWN
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * rescaling by dl primes
+	 * @return ciphertext(m / (q_{l-1} ... q_{l-dl})) with dl primes dropped
+	 */
+	RNSCiphertext reScaleBy(RNSCiphertext& cipher, long dl);
+
+	RNSCiphertext reScaleTo(RNSCiphertext& cipher, long l);
+
+	void reScaleByAndEqual(RNSCiphertext& cipher, long dl);
+
+	void reScaleToAndEqual(RNSCiphertext& cipher, long l);
+
+	/**
+	 * modulus down by dl primes
+	 * @return ciphertext(m) with dl primes dropped
+	 */
+	RNSCiphertext modDownBy(RNSCiphertext& cipher, long dl);
+
+	void modDownByAndEqual(RNSCiphertext& cipher, long dl);
+
+	RNSCiphertext modDownTo(RNSCiphertext& cipher, long l);
+
+	void modDownToAndEqual(RNSCiphertext& cipher, long l);
+
+
+	//----------------------------------------------------------------------------------
+	//   ROTATIONS & CONJUGATIONS
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * key switching of ax * sx' to ax * sx
+	 * @param[out] axres, bxres: arrays of l * N residues with bxres + axres * sx = ax * sx'
+	 * @param[in] ax: array of l * N residues
+	 * @param[in] key: switching key from sx' to sx
+	 * @param[in] l: number of primes in modulus
+	 */
+	void keySwitch(uint64_t* axres, uint64_t* bxres, uint64_t* ax, RNSKey& key, long l);
+
+	RNSCiphertext leftRotateFast(RNSCiphertext& cipher, long rotSlots);
+
+	void leftRotateAndEqualFast(RNSCiphertext& cipher, long rotSlots);
+
+	RNSCiphertext leftRotateByPo2(RNSCiphertext& cipher, long logRotSlots);
+
+	void leftRotateByPo2AndEqual(RNSCiphertext& cipher, long logRotSlots);
+
+	RNSCiphertext rightRotateByPo2(RNSCiphertext& cipher, long logRotSlots);
+
+	void rightRotateByPo2AndEqual(RNSCiphertext& cipher, long logRotSlots);
+
+	RNSCiphertext leftRotate(RNSCiphertext& cipher, long rotSlots);
+
+	void leftRotateAndEqual(RNSCiphertext& cipher, long rotSlots);
+
+	RNSCiphertext rightRotate(RNSCiphertext& cipher, long rotSlots);
+
+	void rightRotateAndEqual(RNSCiphertext& cipher, long rotSlots);
+
+	RNSCiphertext conjugate(RNSCiphertext& cipher);
+
+	void conjugateAndEqual(RNSCiphertext& cipher);
+
+
+	//----------------------------------------------------------------------------------
+	//   BOOTSTRAPPING
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * centered lift of ciphertext mod q_0 to the whole chain
+	 * @param[in, out] cipher: ciphertext(m) mod q_0 -> ciphertext(m + q_0 I) mod Q_L
+	 */
+	void modRaiseAndEqual(RNSCiphertext& cipher);
+
+	/**
+	 * @param[in, out] cipher: ciphertext(vecm) -> ciphertext(special fft of vecm)
+	 */
+	void coeffToSlotAndEqual(RNSCiphertext& cipher);
+
+	/**
+	 * @param[in, out] cipher: ciphertext(vecm) -> ciphertext(special fft inverse of vecm)
+	 */
+	void slotToCoeffAndEqual(RNSCiphertext& cipher);
+
+	/**
+	 * @param[in, out] cipher: ciphertext(m) -> ciphertext(exp(2pim)), consumes three primes
+	 */
+	void exp2piAndEqual(RNSCiphertext& cipher);
+
+	/**
+	 * @param[in, out] cipher: ciphertext(x + q_0 I + i(y + q_0 J)) scaled by 2^logp / (16 q_0)
+	 * -> ciphertext(x + iy) at the original scale
+	 */
+	void evalExpAndEqual(RNSCiphertext& cipher, long logT, long logI = 4);
+
+	/**
+	 * @param[in, out] cipher: ciphertext(x) mod q_0 -> ciphertext(x) mod Q_l for l close to L
+	 */
+	void bootstrapAndEqual(RNSCiphertext& cipher, long logT, long logI = 4);
+
+private:
+
+	void addSwitchKey(SecretKey& secretKey, uint64_t* sxNew, RNSKey& key);
+
+};
+
+#endif
@@ -7,6 +7,54 @@
 */
 #include "Ring2Utils.h"
 
+#include <NTL/BasicThreadPool.h>
+#include <algorithm>
+#include <utility>
+
+#include "RingMultiplier.h"
+
+/**
+ * log of mod if it is a power of two, -1 otherwise
+ */
+static long logPo2(const ZZ& mod) {
+	long logq = NumBits(mod) - 1;
+	return NumTwos(mod) == logq ? logq : -1;
+}
+
+/**
+ * x = a mod 2^logq by truncation, for |a| < 2^logq also from negative a
+ */
+static inline void truncPo2(ZZ& x, const ZZ& a, const long logq, const ZZ& mod) {
+	trunc(x, a, logq);
+	if(sign(x) < 0) {
+		add(x, x, mod);
+	}
+}
+
+/**
+ * p if it has at least limbs words per coefficient, its zero-extension in tmp otherwise
+ */
+static FlatPoly& widen(FlatPoly& p, FlatPoly& tmp, const long limbs) {
+	if(p.limbs >= limbs) return p;
+	tmp.reshape(p.N, limbs);
+	for (long i = 0; i < p.N; ++i) {
+		WordUtils::copyWords(tmp.coeff(i), limbs, p.coeff(i), p.limbs);
+	}
+	return tmp;
+}
+
+/**
+ * output with limbs words per coefficient: res itself, or tmp if res is an input of other shape
+ */
+static FlatPoly& output(FlatPoly& res, FlatPoly& tmp, const bool aliased, const long limbs, const long degree) {
+	if(aliased && (res.N != degree || res.limbs != limbs)) {
+		tmp.reshape(degree, limbs);
+		return tmp;
+	}
+	res.reshape(degree, limbs);
+	return res;
+}
+
 
 //----------------------------------------------------------------------------------
 //   MODULUS
@@ -15,15 +63,18 @@
 
 void Ring2Utils::mod(ZZX& res, ZZX& p, ZZ& mod, const long degree) {
 	res.SetLength(degree);
+	long logq = logPo2(mod);
 	for (long i = 0; i < degree; ++i) {
-		rem(res.rep[i], p.rep[i], mod);
+		if(logq >= 0 && NumBits(p.rep[i]) <= logq) {
+			truncPo2(res.rep[i], p.rep[i], logq, mod);
+		} else {
+			rem(res.rep[i], p.rep[i], mod);
+		}
 	}
 }
 
 void Ring2Utils::modAndEqual(ZZX& p, ZZ& mod, const long degree) {
-	for (long i = 0; i < degree; ++i) {
-		rem(p.rep[i], p.rep[i], mod);
-	}
+	Ring2Utils::mod(p, p, mod, degree);
 }
 
 
@@ -54,7 +105,7 @@ void Ring2Utils::addAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
 void Ring2Utils::sub(ZZX& res, ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
 	res.SetLength(degree);
 	for (long i = 0; i < degree; ++i) {
-		AddMod(res.rep[i], p1.rep[i], -p2.rep[i], mod);
+		SubMod(res.rep[i], p1.rep[i], p2.rep[i], mod);
 	}
 }
 
@@ -66,13 +117,13 @@ ZZX Ring2Utils::sub(ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
 
 void Ring2Utils::subAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
 	for (long i = 0; i < degree; ++i) {
-		AddMod(p1.rep[i], p1.rep[i], -p2.rep[i], mod);
+		SubMod(p1.rep[i], p1.rep[i], p2.rep[i], mod);
 	}
 }
 
 void Ring2Utils::subAndEqual2(ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
 	for (long i = 0; i < degree; ++i) {
-		AddMod(p2.rep[i], p1.rep[i], -p2.rep[i], mod);
+		SubMod(p2.rep[i], p1.rep[i], p2.rep[i], mod);
 	}
 }
 
@@ -83,15 +134,7 @@ void Ring2Utils::subAndEqual2(ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
 
 
 void Ring2Utils::mult(ZZX& res, ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
-	res.SetLength(degree);
-	ZZX pp;
-	mul(pp, p1, p2);
-	pp.SetLength(2 * degree);
-	for (long i = 0; i < degree; ++i) {
-		rem(pp.rep[i], pp.rep[i], mod);
-		rem(pp.rep[i + degree], pp.rep[i + degree], mod);
-		SubMod(res.rep[i], pp.rep[i], pp.rep[i + degree], mod);
-	}
+	RingMultiplier::getInstance(degree).mult(res, p1, p2, mod);
 }
 
 ZZX Ring2Utils::mult(ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
@@ -101,28 +144,11 @@ ZZX Ring2Utils::mult(ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
 }
 
 void Ring2Utils::multAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long degree) {
-	ZZX pp;
-	mul(pp, p1, p2);
-	pp.SetLength(2 * degree);
-
-	for (long i = 0; i < degree; ++i) {
-		rem(pp.rep[i], pp.rep[i], mod);
-		rem(pp.rep[i + degree], pp.rep[i + degree], mod);
-		SubMod(p1.rep[i], pp.rep[i], pp.rep[i + degree], mod);
-	}
+	RingMultiplier::getInstance(degree).mult(p1, p1, p2, mod);
 }
 
 void Ring2Utils::square(ZZX& res, ZZX& p, ZZ& mod, const long degree) {
-	res.SetLength(degree);
-	ZZX pp;
-	sqr(pp, p);
-	pp.SetLength(2 * degree);
-
-	for (long i = 0; i < degree; ++i) {
-		rem(pp.rep[i], pp.rep[i], mod);
-		rem(pp.rep[i + degree], pp.rep[i + degree], mod);
-		SubMod(res.rep[i], pp.rep[i], pp.rep[i + degree], mod);
-	}
+	RingMultiplier::getInstance(degree).square(res, p, mod);
 }
 
 ZZX Ring2Utils::square(ZZX& p, ZZ& mod, const long degree) {
@@ -132,15 +158,7 @@ ZZX Ring2Utils::square(ZZX& p, ZZ& mod, const long degree) {
 }
 
 void Ring2Utils::squareAndEqual(ZZX& p, ZZ& mod, const long degree) {
-	ZZX pp;
-	sqr(pp, p);
-	pp.SetLength(2 * degree);
-
-	for (long i = 0; i < degree; ++i) {
-		rem(pp.rep[i], pp.rep[i], mod);
-		rem(pp.rep[i + degree], pp.rep[i + degree], mod);
-		SubMod(p.rep[i], pp.rep[i], pp.rep[i + degree], mod);
-	}
+	RingMultiplier::getInstance(degree).square(p, p, mod);
 }
 
 void Ring2Utils::multByMonomial(ZZX& res, ZZX& p, const long monomialDeg, const long degree) {
@@ -210,24 +228,26 @@ void Ring2Utils::multByConstAndEqual(ZZX& p, const ZZ& cnst, ZZ& mod, const long
 
 void Ring2Utils::leftShift(ZZX& res, ZZX& p, const long bits, ZZ& mod, const long degree) {
 	res.SetLength(degree);
+	long logq = logPo2(mod);
 	for (long i = 0; i < degree; ++i) {
-		LeftShift(res.rep[i], p.rep[i], bits);
-		rem(res.rep[i], res.rep[i], mod);
+		if(logq >= 0 && NumBits(p.rep[i]) <= logq) {
+			// bits above logq are dropped before shifting, so |p| << bits is never formed
+			trunc(res.rep[i], p.rep[i], max(logq - bits, 0L));
+			LeftShift(res.rep[i], res.rep[i], bits);
+			truncPo2(res.rep[i], res.rep[i], logq, mod);
+		} else {
+			LeftShift(res.rep[i], p.rep[i], bits);
+			rem(res.rep[i], res.rep[i], mod);
+		}
 	}
 }
 
 void Ring2Utils::leftShiftAndEqual(ZZX& p, const long bits, ZZ& mod, const long degree) {
-	for (long i = 0; i < degree; ++i) {
-		LeftShift(p.rep[i], p.rep[i], bits);
-		rem(p.rep[i], p.rep[i], mod);
-	}
+	Ring2Utils::leftShift(p, p, bits, mod, degree);
 }
 
 void Ring2Utils::doubleAndEqual(ZZX& p, ZZ& mod, const long degree) {
-	for (long i = 0; i < degree; ++i) {
-		LeftShift(p.rep[i], p.rep[i], 1);
-		rem(p.rep[i], p.rep[i], mod);
-	}
+	Ring2Utils::leftShift(p, p, 1, mod, degree);
 }
 
 void Ring2Utils::rightShift(ZZX& res, ZZX& p, const long bits, const long degree) {
@@ -285,3 +305,338 @@ ZZX Ring2Utils::inpower(ZZX& p, const long pow, ZZ& mod, const long degree) {
 	inpower(res, p, pow, mod, degree);
 	return res;
 }
+
+void Ring2Utils::inpower(ZZX& res, ZZX& p, long* table, ZZ& mod, const long degree) {
+	long len = p.rep.length();
+	res.SetLength(degree);
+	for (long j = 0; j < degree; ++j) {
+		long i = table[j];
+		if(i >= 0) {
+			if(i >= len) {
+				NTL::clear(res.rep[j]);
+			} else if(sign(p.rep[i]) < 0) {
+				NTL::add(res.rep[j], p.rep[i], mod);
+			} else {
+				res.rep[j] = p.rep[i];
+			}
+		} else {
+			i = ~i;
+			if(i >= len) {
+				NTL::clear(res.rep[j]);
+			} else if(sign(p.rep[i]) > 0) {
+				NTL::sub(res.rep[j], mod, p.rep[i]);
+			} else {
+				NTL::negate(res.rep[j], p.rep[i]);
+			}
+		}
+	}
+}
+
+
+
+//----------------------------------------------------------------------------------
+//   FLAT ARITHMETIC MOD 2^logq
+//----------------------------------------------------------------------------------
+
+
+void Ring2Utils::mod(FlatPoly& res, FlatPoly& p, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly tr;
+	FlatPoly& r = output(res, tr, &res == &p, limbs, degree);
+	for (long i = 0; i < degree; ++i) {
+		WordUtils::copyWords(r.coeff(i), limbs, p.coeff(i), p.limbs);
+		WordUtils::maskWords(r.coeff(i), logq, limbs);
+	}
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::modAndEqual(FlatPoly& p, const long logq, const long degree) {
+	Ring2Utils::mod(p, p, logq, degree);
+}
+
+void Ring2Utils::liftAndEqual(FlatPoly& p, const long logq, const long logQ, const long degree) {
+	long limbs = limbsFor(logQ);
+	FlatPoly tr;
+	FlatPoly& r = output(p, tr, true, limbs, degree);
+	for (long i = 0; i < degree; ++i) {
+		WordUtils::copyWords(r.coeff(i), limbs, p.coeff(i), p.limbs);
+		WordUtils::maskWords(r.coeff(i), logq, limbs);
+		WordUtils::signExtendWords(r.coeff(i), logq, limbs);
+		WordUtils::maskWords(r.coeff(i), logQ, limbs);
+	}
+	if(&r != &p) p = move(r);
+}
+
+void Ring2Utils::add(FlatPoly& res, FlatPoly& p1, FlatPoly& p2, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly t1, t2, tr;
+	FlatPoly& a = widen(p1, t1, limbs);
+	FlatPoly& b = widen(p2, t2, limbs);
+	FlatPoly& r = output(res, tr, &res == &p1 || &res == &p2, limbs, degree);
+	for (long i = 0; i < degree; ++i) {
+		WordUtils::addWords(r.coeff(i), a.coeff(i), b.coeff(i), limbs);
+		WordUtils::maskWords(r.coeff(i), logq, limbs);
+	}
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::addAndEqual(FlatPoly& p1, FlatPoly& p2, const long logq, const long degree) {
+	Ring2Utils::add(p1, p1, p2, logq, degree);
+}
+
+void Ring2Utils::addConstAndEqual(FlatPoly& p, const long n, const ZZ& cnst, const long logq) {
+	long limbs = limbsFor(logq);
+	FlatPoly tp;
+	if(p.limbs < limbs) {
+		p = move(widen(p, tp, limbs));
+	}
+	uint64_t* c = new uint64_t[p.limbs];
+	WordUtils::fromZZ(c, cnst, p.limbs);
+	WordUtils::addWords(p.coeff(n), p.coeff(n), c, p.limbs);
+	WordUtils::maskWords(p.coeff(n), logq, p.limbs);
+	delete[] c;
+}
+
+void Ring2Utils::sub(FlatPoly& res, FlatPoly& p1, FlatPoly& p2, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly t1, t2, tr;
+	FlatPoly& a = widen(p1, t1, limbs);
+	FlatPoly& b = widen(p2, t2, limbs);
+	FlatPoly& r = output(res, tr, &res == &p1 || &res == &p2, limbs, degree);
+	for (long i = 0; i < degree; ++i) {
+		WordUtils::subWords(r.coeff(i), a.coeff(i), b.coeff(i), limbs);
+		WordUtils::maskWords(r.coeff(i), logq, limbs);
+	}
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::subAndEqual(FlatPoly& p1, FlatPoly& p2, const long logq, const long degree) {
+	Ring2Utils::sub(p1, p1, p2, logq, degree);
+}
+
+void Ring2Utils::subAndEqual2(FlatPoly& p1, FlatPoly& p2, const long logq, const long degree) {
+	Ring2Utils::sub(p2, p1, p2, logq, degree);
+}
+
+void Ring2Utils::negate(FlatPoly& res, FlatPoly& p, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly tp, tr;
+	FlatPoly& a = widen(p, tp, limbs);
+	FlatPoly& r = output(res, tr, &res == &p, limbs, degree);
+	for (long i = 0; i < degree; ++i) {
+		WordUtils::negateWords(r.coeff(i), a.coeff(i), limbs);
+		WordUtils::maskWords(r.coeff(i), logq, limbs);
+	}
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::negateAndEqual(FlatPoly& p, const long logq, const long degree) {
+	Ring2Utils::negate(p, p, logq, degree);
+}
+
+void Ring2Utils::mult(FlatPoly& res, FlatPoly& p1, FlatPoly& p2, const long logq, const long degree) {
+	RingMultiplier::getInstance(degree).mult(res, p1, p2, logq);
+}
+
+void Ring2Utils::mult(FlatPoly& res, FlatPoly& p1, ZZX& p2, const long logq, const long degree) {
+	RingMultiplier::getInstance(degree).mult(res, p1, p2, logq);
+}
+
+void Ring2Utils::multAndEqual(FlatPoly& p1, FlatPoly& p2, const long logq, const long degree) {
+	RingMultiplier::getInstance(degree).mult(p1, p1, p2, logq);
+}
+
+void Ring2Utils::multAndEqual(FlatPoly& p1, ZZX& p2, const long logq, const long degree) {
+	RingMultiplier::getInstance(degree).mult(p1, p1, p2, logq);
+}
+
+void Ring2Utils::mult(FlatPoly& res, FlatPoly& p1, TernaryPoly& p2, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly tp, tr;
+	FlatPoly& a = widen(p1, tp, limbs);
+	FlatPoly& r = &res == &p1 ? tr : res;
+	r.reshape(degree, limbs);
+	r.clear();
+	NTL_EXEC_RANGE(degree, first, last);
+	for (long k = 0; k < p2.h; ++k) {
+		long i = p2.idx[k];
+		bool plus = k < p2.hplus;
+		long mid = min(max(i, first), last);
+		// r_j += -+ a_{j - i + N} for j < i by X^N = -1, r_j += +- a_{j - i} otherwise
+		for (long j = first; j < mid; ++j) {
+			if(plus) {
+				WordUtils::subWords(r.coeff(j), r.coeff(j), a.coeff(j - i + degree), limbs);
+			} else {
+				WordUtils::addWords(r.coeff(j), r.coeff(j), a.coeff(j - i + degree), limbs);
+			}
+		}
+		for (long j = mid; j < last; ++j) {
+			if(plus) {
+				WordUtils::addWords(r.coeff(j), r.coeff(j), a.coeff(j - i), limbs);
+			} else {
+				WordUtils::subWords(r.coeff(j), r.coeff(j), a.coeff(j - i), limbs);
+			}
+		}
+	}
+	for (long j = first; j < last; ++j) {
+		WordUtils::maskWords(r.coeff(j), logq, limbs);
+	}
+	NTL_EXEC_RANGE_END;
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::multAndEqual(FlatPoly& p1, TernaryPoly& p2, const long logq, const long degree) {
+	Ring2Utils::mult(p1, p1, p2, logq, degree);
+}
+
+void Ring2Utils::square(FlatPoly& res, FlatPoly& p, const long logq, const long degree) {
+	RingMultiplier::getInstance(degree).square(res, p, logq);
+}
+
+void Ring2Utils::squareAndEqual(FlatPoly& p, const long logq, const long degree) {
+	RingMultiplier::getInstance(degree).square(p, p, logq);
+}
+
+void Ring2Utils::multByMonomial(FlatPoly& res, FlatPoly& p, const long monomialDeg, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	long shift = monomialDeg % (2 * degree);
+	if(shift < 0) shift += 2 * degree;
+	FlatPoly tr;
+	FlatPoly& r = &res == &p ? tr : res;
+	r.reshape(degree, limbs);
+	for (long i = 0; i < degree; ++i) {
+		long j = i + shift;
+		bool neg = (j / degree) & 1;
+		uint64_t* rj = r.coeff(j % degree);
+		WordUtils::copyWords(rj, limbs, p.coeff(i), p.limbs);
+		if(neg) {
+			WordUtils::negateWords(rj, rj, limbs);
+		}
+		WordUtils::maskWords(rj, logq, limbs);
+	}
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::multByMonomialAndEqual(FlatPoly& p, const long monomialDeg, const long logq, const long degree) {
+	Ring2Utils::multByMonomial(p, p, monomialDeg, logq, degree);
+}
+
+void Ring2Utils::multByConst(FlatPoly& res, FlatPoly& p, const ZZ& cnst, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly tp, tr;
+	FlatPoly& a = widen(p, tp, limbs);
+	FlatPoly& r = output(res, tr, &res == &p, limbs, degree);
+	uint64_t* c = new uint64_t[limbs];
+	uint64_t* t = new uint64_t[limbs];
+	WordUtils::fromZZ(c, cnst, limbs);
+	for (long i = 0; i < degree; ++i) {
+		WordUtils::mulWords(t, a.coeff(i), c, limbs);
+		WordUtils::maskWords(t, logq, limbs);
+		copy(t, t + limbs, r.coeff(i));
+	}
+	delete[] c;
+	delete[] t;
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::multByConstAndEqual(FlatPoly& p, const ZZ& cnst, const long logq, const long degree) {
+	Ring2Utils::multByConst(p, p, cnst, logq, degree);
+}
+
+void Ring2Utils::leftShift(FlatPoly& res, FlatPoly& p, const long bits, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly tp, tr;
+	FlatPoly& a = widen(p, tp, limbs);
+	FlatPoly& r = output(res, tr, &res == &p, limbs, degree);
+	for (long i = 0; i < degree; ++i) {
+		WordUtils::leftShiftWords(r.coeff(i), a.coeff(i), bits, limbs);
+		WordUtils::maskWords(r.coeff(i), logq, limbs);
+	}
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::leftShiftAndEqual(FlatPoly& p, const long bits, const long logq, const long degree) {
+	Ring2Utils::leftShift(p, p, bits, logq, degree);
+}
+
+void Ring2Utils::doubleAndEqual(FlatPoly& p, const long logq, const long degree) {
+	Ring2Utils::leftShift(p, p, 1, logq, degree);
+}
+
+void Ring2Utils::rightShift(FlatPoly& res, FlatPoly& p, const long bits, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly tr;
+	FlatPoly& r = output(res, tr, &res == &p, limbs, degree);
+	for (long i = 0; i < degree; ++i) {
+		WordUtils::rightShiftWords(r.coeff(i), limbs, p.coeff(i), p.limbs, bits);
+		WordUtils::maskWords(r.coeff(i), logq, limbs);
+	}
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::rightShiftAndEqual(FlatPoly& p, const long bits, const long logq, const long degree) {
+	Ring2Utils::rightShift(p, p, bits, logq, degree);
+}
+
+void Ring2Utils::decompose(FlatPoly* digits, FlatPoly& p, const long bits, const long count, const long logq, const long degree) {
+	// one more bit than the base, so that digits read as centered values
+	long limbs = limbsFor(bits + 1);
+	for (long j = 0; j < count; ++j) {
+		digits[j].reshape(degree, limbs);
+	}
+	uint64_t* base = new uint64_t[limbs];
+	uint64_t* one = new uint64_t[limbs];
+	fill(base, base + limbs, 0);
+	fill(one, one + limbs, 0);
+	base[bits >> 6] = (uint64_t) 1 << (bits & 63);
+	one[0] = 1;
+	for (long i = 0; i < degree; ++i) {
+		bool carry = false;
+		for (long j = 0; j < count; ++j) {
+			uint64_t* d = digits[j].coeff(i);
+			WordUtils::rightShiftWords(d, limbs, p.coeff(i), p.limbs, j * bits);
+			WordUtils::maskWords(d, min(bits, max(logq - j * bits, 0L)), limbs);
+			if(carry) WordUtils::addWords(d, d, one, limbs);
+			// digits from 2^(bits-1) up to 2^bits become negative and carry into the next one
+			carry = ((d[(bits - 1) >> 6] >> ((bits - 1) & 63)) & 1) || ((d[bits >> 6] >> (bits & 63)) & 1);
+			if(carry) WordUtils::subWords(d, d, base, limbs);
+		}
+	}
+	delete[] base;
+	delete[] one;
+}
+
+void Ring2Utils::conjugate(FlatPoly& res, FlatPoly& p, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly tr;
+	FlatPoly& r = &res == &p ? tr : res;
+	r.reshape(degree, limbs);
+	WordUtils::copyWords(r.coeff(0), limbs, p.coeff(0), p.limbs);
+	WordUtils::maskWords(r.coeff(0), logq, limbs);
+	for (long i = 1; i < degree; ++i) {
+		uint64_t* ri = r.coeff(i);
+		WordUtils::copyWords(ri, limbs, p.coeff(degree - i), p.limbs);
+		WordUtils::negateWords(ri, ri, limbs);
+		WordUtils::maskWords(ri, logq, limbs);
+	}
+	if(&r != &res) res = move(r);
+}
+
+void Ring2Utils::inpower(FlatPoly& res, FlatPoly& p, long* table, const long logq, const long degree) {
+	long limbs = limbsFor(logq);
+	FlatPoly tr;
+	FlatPoly& r = &res == &p ? tr : res;
+	r.reshape(degree, limbs);
+	for (long j = 0; j < degree; ++j) {
+		long i = table[j];
+		uint64_t* rj = r.coeff(j);
+		if(i >= 0) {
+			WordUtils::copyWords(rj, limbs, p.coeff(i), p.limbs);
+		} else {
+			WordUtils::copyWords(rj, limbs, p.coeff(~i), p.limbs);
+			WordUtils::negateWords(rj, rj, limbs);
+		}
+		WordUtils::maskWords(rj, logq, limbs);
+	}
+	if(&r != &res) res = move(r);
+}
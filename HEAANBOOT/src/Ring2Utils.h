@@ -11,6 +11,9 @@
 #include <NTL/ZZ.h>
 #include <NTL/ZZX.h>
 
+#include "FlatPoly.h"
+#include "TernaryPoly.h"
+
 using namespace NTL;
 
 class Ring2Utils {
@@ -119,7 +122,7 @@ public:
 
 
 	/**
-	 * multiplication in ring Z_q[X] / (X^N + 1)
+	 * multiplication in ring Z_q[X] / (X^N + 1) via multi-modular negacyclic ntt (see RingMultiplier)
 	 * @param[out] p1 * p2 in Z_q[X] / (X^N + 1)
 	 * @param[in] p1 in Z_q[X] / (X^N + 1)
 	 * @param[in] p2 in Z_q[X] / (X^N + 1)
@@ -314,6 +317,213 @@ public:
 	 */
 	static ZZX inpower(ZZX& p, const long pow, ZZ& mod, const long degree);
 
+	/**
+	 * changing p(X) to p(X^pow) in Z_q[X] / (X^N + 1) by a precomputed signed permutation
+	 * @param[out] p(X^pow) in Z_q[X] / (X^N + 1), must not alias p
+	 * @param[in] p(X) with coefficients in (-q, q)
+	 * @param[in] table: signed permutation of X -> X^pow (see Context::getInpowerTable)
+	 * @param[in] mod q
+	 * @param[in] degree N
+	 */
+	static void inpower(ZZX& res, ZZX& p, long* table, ZZ& mod, const long degree);
+
+
+	//----------------------------------------------------------------------------------
+	//   FLAT ARITHMETIC MOD 2^logq
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * modulus function
+	 * @param[out] p in Z_q[X] / (X^N + 1)
+	 * @param[in] p in Z_Q[X] / (X^N + 1) for Q >= q
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void mod(FlatPoly& res, FlatPoly& p, const long logq, const long degree);
+
+	/**
+	 * modulus function
+	 * @param[in, out] p in Z_Q[X] / (X^N + 1) -> p in Z_q[X] / (X^N + 1) for Q >= q
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void modAndEqual(FlatPoly& p, const long logq, const long degree);
+
+	/**
+	 * centered lift from Z_q[X] / (X^N + 1) to Z_Q[X] / (X^N + 1)
+	 * @param[in, out] p in Z_q[X] / (X^N + 1) -> p - q * [p >= q/2] in Z_Q[X] / (X^N + 1)
+	 * @param[in] logq: log of q
+	 * @param[in] logQ: log of Q >= q
+	 * @param[in] degree N
+	 */
+	static void liftAndEqual(FlatPoly& p, const long logq, const long logQ, const long degree);
+
+	/**
+	 * addition in ring Z_q[X] / (X^N + 1)
+	 * @param[out] p1 + p2 in Z_q[X] / (X^N + 1)
+	 * @param[in] p1 in Z_q[X] / (X^N + 1)
+	 * @param[in] p2 in Z_q[X] / (X^N + 1)
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void add(FlatPoly& res, FlatPoly& p1, FlatPoly& p2, const long logq, const long degree);
+
+	static void addAndEqual(FlatPoly& p1, FlatPoly& p2, const long logq, const long degree);
+
+	/**
+	 * addition of constant to a coefficient in ring Z_q[X] / (X^N + 1)
+	 * @param[in, out] p -> p + c * X^n in Z_q[X] / (X^N + 1)
+	 * @param[in] n: index of coefficient
+	 * @param[in] cnst: constant c
+	 * @param[in] logq: log of q
+	 */
+	static void addConstAndEqual(FlatPoly& p, const long n, const ZZ& cnst, const long logq);
+
+	/**
+	 * substraction in ring Z_q[X] / (X^N + 1)
+	 * @param[out] p1 - p2 in Z_q[X] / (X^N + 1)
+	 * @param[in] p1 in Z_q[X] / (X^N + 1)
+	 * @param[in] p2 in Z_q[X] / (X^N + 1)
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void sub(FlatPoly& res, FlatPoly& p1, FlatPoly& p2, const long logq, const long degree);
+
+	static void subAndEqual(FlatPoly& p1, FlatPoly& p2, const long logq, const long degree);
+
+	/**
+	 * p2 -> p1 - p2 in ring Z_q[X] / (X^N + 1)
+	 */
+	static void subAndEqual2(FlatPoly& p1, FlatPoly& p2, const long logq, const long degree);
+
+	/**
+	 * negation in ring Z_q[X] / (X^N + 1)
+	 */
+	static void negate(FlatPoly& res, FlatPoly& p, const long logq, const long degree);
+
+	static void negateAndEqual(FlatPoly& p, const long logq, const long degree);
+
+	/**
+	 * multiplication in ring Z_q[X] / (X^N + 1) via multi-modular negacyclic ntt (see RingMultiplier)
+	 * @param[out] p1 * p2 in Z_q[X] / (X^N + 1)
+	 * @param[in] p1 in Z_q[X] / (X^N + 1)
+	 * @param[in] p2 in Z_q[X] / (X^N + 1), or with signed coefficients
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void mult(FlatPoly& res, FlatPoly& p1, FlatPoly& p2, const long logq, const long degree);
+
+	static void mult(FlatPoly& res, FlatPoly& p1, ZZX& p2, const long logq, const long degree);
+
+	static void multAndEqual(FlatPoly& p1, FlatPoly& p2, const long logq, const long degree);
+
+	static void multAndEqual(FlatPoly& p1, ZZX& p2, const long logq, const long degree);
+
+	/**
+	 * multiplication by sparse ternary polynomial in ring Z_q[X] / (X^N + 1)
+	 * with h signed shifted additions, e.g. by the secret key
+	 * @param[out] p1 * p2 in Z_q[X] / (X^N + 1)
+	 * @param[in] p1 in Z_q[X] / (X^N + 1)
+	 * @param[in] p2: polynomial with h coefficients in {-1, 1}
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void mult(FlatPoly& res, FlatPoly& p1, TernaryPoly& p2, const long logq, const long degree);
+
+	static void multAndEqual(FlatPoly& p1, TernaryPoly& p2, const long logq, const long degree);
+
+	/**
+	 * square in ring Z_q[X] / (X^N + 1)
+	 * @param[out] p^2 in Z_q[X] / (X^N + 1)
+	 * @param[in] p in Z_q[X] / (X^N + 1)
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void square(FlatPoly& res, FlatPoly& p, const long logq, const long degree);
+
+	static void squareAndEqual(FlatPoly& p, const long logq, const long degree);
+
+	/**
+	 * multiplication by monomial in ring Z_q[X] / (X^N + 1)
+	 * @param[out] p * X^d in Z_q[X] / (X^N + 1)
+	 * @param[in] p in Z_q[X] / (X^N + 1)
+	 * @param[in] monomial degree d
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void multByMonomial(FlatPoly& res, FlatPoly& p, const long monomialDeg, const long logq, const long degree);
+
+	static void multByMonomialAndEqual(FlatPoly& p, const long monomialDeg, const long logq, const long degree);
+
+	/**
+	 * multiplication by constant in ring Z_q[X] / (X^N + 1)
+	 * @param[out] p * c in Z_q[X] / (X^N + 1)
+	 * @param[in] p in Z_q[X] / (X^N + 1)
+	 * @param[in] constant c
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void multByConst(FlatPoly& res, FlatPoly& p, const ZZ& cnst, const long logq, const long degree);
+
+	static void multByConstAndEqual(FlatPoly& p, const ZZ& cnst, const long logq, const long degree);
+
+	/**
+	 * multiplication by 2^bits in ring Z_q[X] / (X^N + 1)
+	 * @param[out] p * 2^bits in Z_q[X] / (X^N + 1)
+	 * @param[in] p in Z_q[X] / (X^N + 1)
+	 * @param[in] bits: number of bits
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void leftShift(FlatPoly& res, FlatPoly& p, const long bits, const long logq, const long degree);
+
+	static void leftShiftAndEqual(FlatPoly& p, const long bits, const long logq, const long degree);
+
+	static void doubleAndEqual(FlatPoly& p, const long logq, const long degree);
+
+	/**
+	 * division by 2^bits with rounding down of coefficients in [0, 2^(logq + bits))
+	 * @param[out] p / 2^bits in Z_q[X] / (X^N + 1)
+	 * @param[in] p in Z_{q * 2^bits}[X] / (X^N + 1)
+	 * @param[in] bits: number of bits
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void rightShift(FlatPoly& res, FlatPoly& p, const long bits, const long logq, const long degree);
+
+	static void rightShiftAndEqual(FlatPoly& p, const long bits, const long logq, const long degree);
+
+	/**
+	 * balanced decomposition in base 2^bits, p = sum_j digits[j] * 2^(j bits) mod q
+	 * @param[out] digits: count polynomials with centered coefficients in [-2^(bits-1), 2^(bits-1)]
+	 * @param[in] p in Z_q[X] / (X^N + 1)
+	 * @param[in] bits: number of bits of base
+	 * @param[in] count: number of digits, count * bits >= logq
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void decompose(FlatPoly* digits, FlatPoly& p, const long bits, const long count, const long logq, const long degree);
+
+	/**
+	 * conjugation
+	 * @param[out] conj(p) in Z_q[X] / (X^N + 1)
+	 * @param[in] p in Z_q[X] / (X^N + 1)
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void conjugate(FlatPoly& res, FlatPoly& p, const long logq, const long degree);
+
+	/**
+	 * changing p(X) to p(X^pow) in Z_q[X] / (X^N + 1) by a precomputed signed permutation
+	 * @param[out] p(X^pow) in Z_q[X] / (X^N + 1)
+	 * @param[in] p(X) in Z_q[X] / (X^N + 1)
+	 * @param[in] table: signed permutation of X -> X^pow (see Context::getInpowerTable)
+	 * @param[in] logq: log of q
+	 * @param[in] degree N
+	 */
+	static void inpower(FlatPoly& res, FlatPoly& p, long* table, const long logq, const long degree);
+
 };
 
 #endif
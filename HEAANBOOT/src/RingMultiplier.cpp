@@ -0,0 +1,545 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "RingMultiplier.h"
+
+#include <NTL/BasicThreadPool.h>
+
+RingCRTData::RingCRTData(uint64_t* pVec, long np) {
+	pProd = ZZ(1);
+	for (long i = 0; i < np; ++i) {
+		pProd *= (long) pVec[i];
+	}
+	pHat = new ZZ[np];
+	pHatInvModp = new uint64_t[np];
+	pHatInvModpShoup = new uint64_t[np];
+	for (long i = 0; i < np; ++i) {
+		pHat[i] = pProd / ZZ((long) pVec[i]);
+		uint64_t pHatModp = (uint64_t) rem(pHat[i], (long) pVec[i]);
+		pHatInvModp[i] = RingMultiplier::invMod(pHatModp, pVec[i]);
+		pHatInvModpShoup[i] = RingMultiplier::shoup(pHatInvModp[i], pVec[i]);
+	}
+	pHatWords = new uint64_t[np * np];
+	pProdWords = new uint64_t[np];
+	for (long i = 0; i < np; ++i) {
+		WordUtils::fromZZ(pHatWords + i * np, pHat[i], np);
+	}
+	WordUtils::fromZZ(pProdWords, pProd, np);
+}
+
+RingCRTData::~RingCRTData() {
+	delete[] pHat;
+	delete[] pHatInvModp;
+	delete[] pHatInvModpShoup;
+	delete[] pHatWords;
+	delete[] pProdWords;
+}
+
+RingMultiplier::RingMultiplier(long logN) : logN(logN) {
+	N = 1 << logN;
+	np = 0;
+
+	pVec = new uint64_t[NTT_MAX_PRIMES];
+	pInvVec = new double[NTT_MAX_PRIMES];
+	pr0Vec = new uint64_t[NTT_MAX_PRIMES];
+	pr1Vec = new uint64_t[NTT_MAX_PRIMES];
+	NInvVec = new uint64_t[NTT_MAX_PRIMES];
+	NInvShoupVec = new uint64_t[NTT_MAX_PRIMES];
+
+	rootPows = new uint64_t*[NTT_MAX_PRIMES];
+	rootPowsShoup = new uint64_t*[NTT_MAX_PRIMES];
+	rootPowsInv = new uint64_t*[NTT_MAX_PRIMES];
+	rootPowsInvShoup = new uint64_t*[NTT_MAX_PRIMES];
+}
+
+RingMultiplier::~RingMultiplier() {
+	for (long i = 0; i < np; ++i) {
+		delete[] rootPows[i];
+		delete[] rootPowsShoup[i];
+		delete[] rootPowsInv[i];
+		delete[] rootPowsInvShoup[i];
+	}
+	for (auto const& element : crtMap) {
+		delete element.second;
+	}
+	for (auto const& element : permMap) {
+		delete[] element.second;
+	}
+	delete[] rootPows;
+	delete[] rootPowsShoup;
+	delete[] rootPowsInv;
+	delete[] rootPowsInvShoup;
+	delete[] pVec;
+	delete[] pInvVec;
+	delete[] pr0Vec;
+	delete[] pr1Vec;
+	delete[] NInvVec;
+	delete[] NInvShoupVec;
+}
+
+RingMultiplier& RingMultiplier::getInstance(const long degree) {
+	static mutex instancesLock;
+	static map<long, RingMultiplier*> instances;
+
+	lock_guard<mutex> guard(instancesLock);
+	auto it = instances.find(degree);
+	if(it == instances.end()) {
+		long logN = 0;
+		while((1L << logN) < degree) logN++;
+		it = instances.insert(pair<long, RingMultiplier*>(degree, new RingMultiplier(logN))).first;
+	}
+	return *it->second;
+}
+
+
+//----------------------------------------------------------------------------------
+//   PRIMES
+//----------------------------------------------------------------------------------
+
+
+long RingMultiplier::primesNeeded(const long bits) {
+	long needed = (bits + 2) / (NTT_PRIME_BITS - 1) + 1;
+	if(needed > NTT_MAX_PRIMES) {
+		throw std::invalid_argument("Product is too large for ntt primes");
+	}
+	lock_guard<mutex> guard(primesLock);
+	uint64_t p = np == 0 ? (1UL << NTT_PRIME_BITS) + 1 : pVec[np - 1];
+	while(np < needed) {
+		p -= 2 * N;
+		if(ProbPrime(ZZ((long) p))) {
+			addPrime(p);
+		}
+	}
+	return needed;
+}
+
+RingCRTData* RingMultiplier::getCRTData(const long np) {
+	lock_guard<mutex> guard(primesLock);
+	auto it = crtMap.find(np);
+	if(it == crtMap.end()) {
+		it = crtMap.insert(pair<long, RingCRTData*>(np, new RingCRTData(pVec, np))).first;
+	}
+	return it->second;
+}
+
+long RingMultiplier::maxBits(ZZX& p, const long degree) {
+	long bits = 0;
+	long len = min(degree, p.rep.length());
+	for (long i = 0; i < len; ++i) {
+		long b = NumBits(p.rep[i]);
+		if(b > bits) bits = b;
+	}
+	return bits;
+}
+
+long RingMultiplier::maxBits(FlatPoly& p, const long degree) {
+	long bits = 0;
+	long len = min(degree, p.N);
+	for (long i = 0; i < len; ++i) {
+		long b = WordUtils::bitLength(p.coeff(i), p.limbs);
+		if(b > bits) bits = b;
+	}
+	return bits;
+}
+
+void RingMultiplier::addPrime(const uint64_t p) {
+	pVec[np] = p;
+	pInvVec[np] = 1.0 / (double) p;
+
+	unsigned __int128 pr = ~((unsigned __int128) 0) / p;
+	pr0Vec[np] = (uint64_t) pr;
+	pr1Vec[np] = (uint64_t) (pr >> 64);
+
+	NInvVec[np] = invMod(N, p);
+	NInvShoupVec[np] = shoup(NInvVec[np], p);
+
+	rootPows[np] = new uint64_t[N];
+	rootPowsShoup[np] = new uint64_t[N];
+	rootPowsInv[np] = new uint64_t[N];
+	rootPowsInvShoup[np] = new uint64_t[N];
+	rootTables(rootPows[np], rootPowsShoup[np], rootPowsInv[np], rootPowsInvShoup[np], logN, p);
+
+	np++;
+}
+
+
+//----------------------------------------------------------------------------------
+//   NTT
+//----------------------------------------------------------------------------------
+
+
+void RingMultiplier::NTT(uint64_t* a, const long index) {
+	NTT(a, N, pVec[index], rootPows[index], rootPowsShoup[index]);
+}
+
+void RingMultiplier::INTT(uint64_t* a, const long index) {
+	INTT(a, N, pVec[index], rootPowsInv[index], rootPowsInvShoup[index], NInvVec[index], NInvShoupVec[index]);
+}
+
+void RingMultiplier::CRT(uint64_t* ra, ZZX& a, const long np) {
+	long len = min(N, a.rep.length());
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rai = ra + (i << logN);
+		long pi = (long) pVec[i];
+		for (long n = 0; n < len; ++n) {
+			rai[n] = (uint64_t) rem(a.rep[n], pi);
+		}
+		for (long n = len; n < N; ++n) {
+			rai[n] = 0;
+		}
+		NTT(rai, i);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::CRT(uint64_t* ra, const FlatPoly& a, const long np) {
+	long len = min(N, a.N);
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rai = ra + (i << logN);
+		uint64_t pi = pVec[i];
+		uint64_t pr0 = pr0Vec[i];
+		uint64_t pr1 = pr1Vec[i];
+		uint64_t wrap = wrapMod(a.limbs, pi, pr0, pr1);
+		for (long n = 0; n < len; ++n) {
+			rai[n] = residue(a.coeff(n), a.limbs, pi, pr0, pr1, wrap);
+		}
+		for (long n = len; n < N; ++n) {
+			rai[n] = 0;
+		}
+		NTT(rai, i);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::CRT(uint64_t* ra, const SmallPoly& a, const long np) {
+	long len = min(N, a.N);
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rai = ra + (i << logN);
+		uint64_t pi = pVec[i];
+		uint64_t pr0 = pr0Vec[i];
+		uint64_t pr1 = pr1Vec[i];
+		for (long n = 0; n < len; ++n) {
+			rai[n] = residue(a.coeffs[n], pi, pr0, pr1);
+		}
+		for (long n = len; n < N; ++n) {
+			rai[n] = 0;
+		}
+		NTT(rai, i);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::CRT(uint64_t* ra, TernaryPoly& a, const long np) {
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rai = ra + (i << logN);
+		fill(rai, rai + N, 0);
+		for (long k = 0; k < a.hplus; ++k) {
+			rai[a.idx[k]] = 1;
+		}
+		for (long k = a.hplus; k < a.h; ++k) {
+			rai[a.idx[k]] = pVec[i] - 1;
+		}
+		NTT(rai, i);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::mulPointwise(uint64_t* rx, uint64_t* ra, uint64_t* rb, const long np) {
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rxi = rx + (i << logN);
+		uint64_t* rai = ra + (i << logN);
+		uint64_t* rbi = rb + (i << logN);
+		uint64_t pi = pVec[i];
+		uint64_t pr0 = pr0Vec[i];
+		uint64_t pr1 = pr1Vec[i];
+		for (long n = 0; n < N; ++n) {
+			rxi[n] = mulModBarrett(rai[n], rbi[n], pi, pr0, pr1);
+		}
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::mulAddPointwise(uint64_t* rx, uint64_t* ra, uint64_t* rb, const long np) {
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rxi = rx + (i << logN);
+		uint64_t* rai = ra + (i << logN);
+		uint64_t* rbi = rb + (i << logN);
+		uint64_t pi = pVec[i];
+		uint64_t pr0 = pr0Vec[i];
+		uint64_t pr1 = pr1Vec[i];
+		for (long n = 0; n < N; ++n) {
+			uint64_t x = rxi[n] + mulModBarrett(rai[n], rbi[n], pi, pr0, pr1);
+			rxi[n] = x >= pi ? x - pi : x;
+		}
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::squarePointwise(uint64_t* rx, uint64_t* ra, const long np) {
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rxi = rx + (i << logN);
+		uint64_t* rai = ra + (i << logN);
+		uint64_t pi = pVec[i];
+		uint64_t pr0 = pr0Vec[i];
+		uint64_t pr1 = pr1Vec[i];
+		for (long n = 0; n < N; ++n) {
+			rxi[n] = mulModBarrett(rai[n], rai[n], pi, pr0, pr1);
+		}
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+long* RingMultiplier::getPermutation(const long pow) {
+	lock_guard<mutex> guard(permLock);
+	auto it = permMap.find(pow);
+	if(it == permMap.end()) {
+		// ntt slot n holds the value at psi^(2 brv(n) + 1), which X -> X^pow moves to psi^((2 brv(n) + 1) pow)
+		long M = N << 1;
+		long* perm = new long[N];
+		for (long n = 0; n < N; ++n) {
+			long nbr = 0;
+			for (long b = 0; b < logN; ++b) nbr |= ((n >> b) & 1) << (logN - 1 - b);
+			long e = (((2 * nbr + 1) * pow) % M - 1) >> 1;
+			long ebr = 0;
+			for (long b = 0; b < logN; ++b) ebr |= ((e >> b) & 1) << (logN - 1 - b);
+			perm[n] = ebr;
+		}
+		it = permMap.insert(pair<long, long*>(pow, perm)).first;
+	}
+	return it->second;
+}
+
+void RingMultiplier::inpower(uint64_t* rx, uint64_t* ra, const long pow, const long np) {
+	long* perm = getPermutation(pow);
+	for (long n0 = 0; n0 < N; n0 += NTT_PERM_BLOCK) {
+		long n1 = min(N, n0 + NTT_PERM_BLOCK);
+		for (long i = 0; i < np; ++i) {
+			uint64_t* rai = ra + (i << logN);
+			uint64_t* rxi = rx + (i << logN);
+			for (long n = n0; n < n1; ++n) {
+				rxi[n] = rai[perm[n]];
+			}
+		}
+	}
+}
+
+void RingMultiplier::reconstruct(ZZX& x, uint64_t* rx, const long np, const ZZ& mod) {
+	RingCRTData* crt = getCRTData(np);
+
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		INTT(rx + (i << logN), i);
+	}
+	NTL_EXEC_RANGE_END;
+
+	x.SetLength(N);
+	NTL_EXEC_RANGE(N, first, last);
+	ZZ acc, tmp;
+	for (long n = first; n < last; ++n) {
+		clear(acc);
+		double y = 0;
+		for (long i = 0; i < np; ++i) {
+			uint64_t s = mulModShoup(rx[(i << logN) + n], crt->pHatInvModp[i], crt->pHatInvModpShoup[i], pVec[i]);
+			y += (double) s * pInvVec[i];
+			mul(tmp, crt->pHat[i], (long) s);
+			add(acc, acc, tmp);
+		}
+		long k = (long) floor(y + 0.5);
+		mul(tmp, crt->pProd, k);
+		sub(acc, acc, tmp);
+		rem(x.rep[n], acc, mod);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::reconstruct(FlatPoly& x, uint64_t* rx, const long np, const long logq) {
+	RingCRTData* crt = getCRTData(np);
+
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		INTT(rx + (i << logN), i);
+	}
+	NTL_EXEC_RANGE_END;
+
+	// the centered product is sum s_i * P / p_i - k * P, which is evaluated mod 2^(64 limbs)
+	long limbs = limbsFor(logq);
+	x.reshape(N, limbs);
+	NTL_EXEC_RANGE(N, first, last);
+	for (long n = first; n < last; ++n) {
+		uint64_t* xn = x.coeff(n);
+		fill(xn, xn + limbs, 0);
+		double y = 0;
+		for (long i = 0; i < np; ++i) {
+			uint64_t s = mulModShoup(rx[(i << logN) + n], crt->pHatInvModp[i], crt->pHatInvModpShoup[i], pVec[i]);
+			y += (double) s * pInvVec[i];
+			WordUtils::mulAddWord(xn, limbs, crt->pHatWords + i * np, np, s);
+		}
+		uint64_t k = (uint64_t) floor(y + 0.5);
+		WordUtils::mulSubWord(xn, limbs, crt->pProdWords, np, k);
+		WordUtils::maskWords(xn, logq, limbs);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+
+//----------------------------------------------------------------------------------
+//   MULTIPLICATION & SQUARING
+//----------------------------------------------------------------------------------
+
+
+void RingMultiplier::mult(ZZX& x, ZZX& a, ZZX& b, const ZZ& mod) {
+	long np = primesNeeded(maxBits(a, N) + maxBits(b, N) + logN);
+	uint64_t* ra = new uint64_t[np << logN];
+	uint64_t* rb = new uint64_t[np << logN];
+	CRT(ra, a, np);
+	CRT(rb, b, np);
+	mulPointwise(ra, ra, rb, np);
+	reconstruct(x, ra, np, mod);
+	delete[] ra;
+	delete[] rb;
+}
+
+void RingMultiplier::square(ZZX& x, ZZX& a, const ZZ& mod) {
+	long np = primesNeeded(2 * maxBits(a, N) + logN);
+	uint64_t* ra = new uint64_t[np << logN];
+	CRT(ra, a, np);
+	squarePointwise(ra, ra, np);
+	reconstruct(x, ra, np, mod);
+	delete[] ra;
+}
+
+void RingMultiplier::mult(FlatPoly& x, FlatPoly& a, FlatPoly& b, const long logq) {
+	long np = primesNeeded(maxBits(a, N) + maxBits(b, N) + logN);
+	uint64_t* ra = new uint64_t[np << logN];
+	uint64_t* rb = new uint64_t[np << logN];
+	CRT(ra, a, np);
+	CRT(rb, b, np);
+	mulPointwise(ra, ra, rb, np);
+	reconstruct(x, ra, np, logq);
+	delete[] ra;
+	delete[] rb;
+}
+
+void RingMultiplier::mult(FlatPoly& x, FlatPoly& a, ZZX& b, const long logq) {
+	long np = primesNeeded(maxBits(a, N) + maxBits(b, N) + logN);
+	uint64_t* ra = new uint64_t[np << logN];
+	uint64_t* rb = new uint64_t[np << logN];
+	CRT(ra, a, np);
+	CRT(rb, b, np);
+	mulPointwise(ra, ra, rb, np);
+	reconstruct(x, ra, np, logq);
+	delete[] ra;
+	delete[] rb;
+}
+
+void RingMultiplier::square(FlatPoly& x, FlatPoly& a, const long logq) {
+	long np = primesNeeded(2 * maxBits(a, N) + logN);
+	uint64_t* ra = new uint64_t[np << logN];
+	CRT(ra, a, np);
+	squarePointwise(ra, ra, np);
+	reconstruct(x, ra, np, logq);
+	delete[] ra;
+}
+
+
+//----------------------------------------------------------------------------------
+//   WORD-SIZE MODULAR ARITHMETIC
+//----------------------------------------------------------------------------------
+
+
+uint64_t RingMultiplier::powMod(uint64_t a, uint64_t e, const uint64_t p) {
+	uint64_t res = 1;
+	a %= p;
+	while(e > 0) {
+		if(e & 1) res = (uint64_t) (((unsigned __int128) res * a) % p);
+		a = (uint64_t) (((unsigned __int128) a * a) % p);
+		e >>= 1;
+	}
+	return res;
+}
+
+uint64_t RingMultiplier::invMod(const uint64_t a, const uint64_t p) {
+	return powMod(a, p - 2, p);
+}
+
+void RingMultiplier::NTT(uint64_t* a, const long N, const uint64_t p, uint64_t* pows, uint64_t* powsShoup) {
+	long t = N;
+	for (long m = 1; m < N; m <<= 1) {
+		t >>= 1;
+		for (long i = 0; i < m; ++i) {
+			long j1 = 2 * i * t;
+			long j2 = j1 + t;
+			uint64_t W = pows[m + i];
+			uint64_t WShoup = powsShoup[m + i];
+			for (long j = j1; j < j2; ++j) {
+				uint64_t U = a[j];
+				uint64_t V = mulModShoup(a[j + t], W, WShoup, p);
+				uint64_t sum = U + V;
+				a[j] = sum >= p ? sum - p : sum;
+				a[j + t] = U >= V ? U - V : U + p - V;
+			}
+		}
+	}
+}
+
+void RingMultiplier::INTT(uint64_t* a, const long N, const uint64_t p, uint64_t* powsInv, uint64_t* powsInvShoup, const uint64_t NInv, const uint64_t NInvShoup) {
+	long t = 1;
+	for (long m = N; m > 1; m >>= 1) {
+		long j1 = 0;
+		long h = m >> 1;
+		for (long i = 0; i < h; ++i) {
+			long j2 = j1 + t;
+			uint64_t W = powsInv[h + i];
+			uint64_t WShoup = powsInvShoup[h + i];
+			for (long j = j1; j < j2; ++j) {
+				uint64_t U = a[j];
+				uint64_t V = a[j + t];
+				uint64_t sum = U + V;
+				a[j] = sum >= p ? sum - p : sum;
+				a[j + t] = mulModShoup(U >= V ? U - V : U + p - V, W, WShoup, p);
+			}
+			j1 += (t << 1);
+		}
+		t <<= 1;
+	}
+	for (long j = 0; j < N; ++j) {
+		a[j] = mulModShoup(a[j], NInv, NInvShoup, p);
+	}
+}
+
+void RingMultiplier::rootTables(uint64_t* pows, uint64_t* powsShoup, uint64_t* powsInv, uint64_t* powsInvShoup, const long logN, const uint64_t p) {
+	long N = 1 << logN;
+	long M = N << 1;
+	uint64_t root = 0;
+	for (uint64_t g = 2; ; ++g) {
+		root = powMod(g, (p - 1) / M, p);
+		if(powMod(root, N, p) == p - 1) break;
+	}
+	uint64_t rootInv = invMod(root, p);
+
+	uint64_t power = 1;
+	uint64_t powerInv = 1;
+	for (long i = 0; i < N; ++i) {
+		long ibr = 0;
+		for (long b = 0; b < logN; ++b) {
+			ibr |= ((i >> b) & 1) << (logN - 1 - b);
+		}
+		pows[ibr] = power;
+		powsShoup[ibr] = shoup(power, p);
+		powsInv[ibr] = powerInv;
+		powsInvShoup[ibr] = shoup(powerInv, p);
+		power = (uint64_t) (((unsigned __int128) power * root) % p);
+		powerInv = (uint64_t) (((unsigned __int128) powerInv * rootInv) % p);
+	}
+}
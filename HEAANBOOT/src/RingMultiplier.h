@@ -0,0 +1,408 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_RINGMULTIPLIER_H_
+#define HEAAN_RINGMULTIPLIER_H_
+
+#include <NTL/ZZ.h>
+#include <NTL/ZZX.h>
+#include <cstdint>
+#include <mutex>
+
+#include "Common.h"
+#include "FlatPoly.h"
+#include "SmallPoly.h"
+#include "TernaryPoly.h"
+
+using namespace std;
+using namespace NTL;
+
+static const long NTT_PRIME_BITS = 61; ///< ntt primes are in (2^60, 2^61)
+static const long NTT_MAX_PRIMES = 256; ///< enough for products of up to 15000 bits
+static const long NTT_PERM_BLOCK = 512; ///< ntt slots per tile of a permutation, a tile of the table is reused for all primes
+
+/**
+ * CRT constants for the first np ntt primes
+ */
+class RingCRTData {
+public:
+
+	ZZ pProd; ///< P = p_0 * ... * p_{np-1}
+	ZZ* pHat; ///< P / p_i
+	uint64_t* pHatInvModp; ///< (P / p_i)^{-1} mod p_i
+	uint64_t* pHatInvModpShoup; ///< shoup constants of pHatInvModp
+	uint64_t* pHatWords; ///< P / p_i in np words each, for reconstruction mod powers of two
+	uint64_t* pProdWords; ///< P in np words
+
+	RingCRTData(uint64_t* pVec, long np);
+
+	~RingCRTData();
+
+};
+
+/**
+ * Negacyclic convolution in Z[X] / (X^N + 1) over word-size ntt primes p_i = 1 mod 2N.
+ * Polynomials are decomposed into residues mod p_i, multiplied in the twisted ntt domain
+ * and recovered from the exact integer product by CRT.
+ */
+class RingMultiplier {
+public:
+
+	long logN; ///< log of ring degree
+	long N; ///< ring degree
+
+	long np; ///< number of generated primes
+
+	uint64_t* pVec; ///< ntt primes
+	double* pInvVec; ///< 1 / p_i
+	uint64_t* NInvVec; ///< N^{-1} mod p_i
+	uint64_t* NInvShoupVec; ///< shoup constants of N^{-1} mod p_i
+
+	uint64_t** rootPows; ///< powers of primitive 2N-th root of unity mod p_i in bit-reversed order
+	uint64_t** rootPowsShoup; ///< shoup constants of rootPows
+	uint64_t** rootPowsInv; ///< powers of inverse root of unity mod p_i in bit-reversed order
+	uint64_t** rootPowsInvShoup; ///< shoup constants of rootPowsInv
+
+	uint64_t* pr0Vec; ///< low words of barrett constants floor(2^128 / p_i)
+	uint64_t* pr1Vec; ///< high words of barrett constants floor(2^128 / p_i)
+
+	map<long, RingCRTData*> crtMap; ///< CRT constants for number of primes used
+
+	mutex primesLock; ///< guards generation of primes and CRT constants
+
+	map<long, long*> permMap; ///< ntt slot permutations of X -> X^pow, built on first use
+	mutex permLock; ///< guards permMap
+
+	RingMultiplier(long logN);
+
+	virtual ~RingMultiplier();
+
+	/**
+	 * shared multiplier for ring degree, created on first use
+	 * @param[in] degree N
+	 */
+	static RingMultiplier& getInstance(const long degree);
+
+
+	//----------------------------------------------------------------------------------
+	//   PRIMES
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * number of ntt primes to represent a signed product without wrap-around,
+	 * generates missing primes
+	 * @param[in] bits: bound on bit size of absolute values of product coefficients
+	 * @return number of primes
+	 */
+	long primesNeeded(const long bits);
+
+	/**
+	 * CRT constants for the first np primes
+	 * @param[in] np: number of primes
+	 */
+	RingCRTData* getCRTData(const long np);
+
+	/**
+	 * maximal bit size of coefficients
+	 * @param[in] p: polynomial
+	 * @param[in] degree N
+	 */
+	static long maxBits(ZZX& p, const long degree);
+
+	/**
+	 * maximal bit size of centered coefficients
+	 * @param[in] p: polynomial
+	 * @param[in] degree N
+	 */
+	static long maxBits(FlatPoly& p, const long degree);
+
+
+	//----------------------------------------------------------------------------------
+	//   NTT
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * forward negacyclic ntt mod p_index in place, output in bit-reversed order
+	 * @param[in, out] a: array of N residues
+	 * @param[in] index: prime index
+	 */
+	void NTT(uint64_t* a, const long index);
+
+	/**
+	 * inverse negacyclic ntt mod p_index in place, input in bit-reversed order
+	 * @param[in, out] a: array of N residues
+	 * @param[in] index: prime index
+	 */
+	void INTT(uint64_t* a, const long index);
+
+	/**
+	 * reduces polynomial mod first np primes and transforms residues to ntt domain
+	 * @param[out] ra: array of np * N residues
+	 * @param[in] a: polynomial
+	 * @param[in] np: number of primes
+	 */
+	void CRT(uint64_t* ra, ZZX& a, const long np);
+
+	/**
+	 * reduces centered polynomial mod first np primes and transforms residues to ntt domain
+	 * @param[out] ra: array of np * N residues
+	 * @param[in] a: polynomial
+	 * @param[in] np: number of primes
+	 */
+	void CRT(uint64_t* ra, const FlatPoly& a, const long np);
+
+	/**
+	 * residues of ternary polynomial, read off its nonzero indices, in ntt domain
+	 * @param[out] ra: array of np * N residues
+	 * @param[in] a: polynomial with coefficients in {-1, 0, 1}
+	 * @param[in] np: number of primes
+	 */
+	void CRT(uint64_t* ra, TernaryPoly& a, const long np);
+
+	/**
+	 * residues of polynomial with int64_t coefficients in ntt domain
+	 * @param[out] ra: array of np * N residues
+	 * @param[in] a: polynomial
+	 * @param[in] np: number of primes
+	 */
+	void CRT(uint64_t* ra, const SmallPoly& a, const long np);
+
+	/**
+	 * pointwise product in ntt domain
+	 * @param[out] rx: ra * rb
+	 * @param[in] ra: array of np * N residues
+	 * @param[in] rb: array of np * N residues
+	 * @param[in] np: number of primes
+	 */
+	void mulPointwise(uint64_t* rx, uint64_t* ra, uint64_t* rb, const long np);
+
+	/**
+	 * pointwise product accumulated in ntt domain
+	 * @param[in, out] rx: rx + ra * rb
+	 * @param[in] ra: array of np * N residues
+	 * @param[in] rb: array of np * N residues
+	 * @param[in] np: number of primes
+	 */
+	void mulAddPointwise(uint64_t* rx, uint64_t* ra, uint64_t* rb, const long np);
+
+	/**
+	 * pointwise square in ntt domain
+	 * @param[out] rx: ra * ra
+	 * @param[in] ra: array of np * N residues
+	 * @param[in] np: number of primes
+	 */
+	void squarePointwise(uint64_t* rx, uint64_t* ra, const long np);
+
+	/**
+	 * permutation of ntt slots for X -> X^pow, shared between calls:
+	 * slot n of a(X^pow) is slot perm[n] of a(X)
+	 * @param[in] pow: odd power
+	 */
+	long* getPermutation(const long pow);
+
+	/**
+	 * automorphism X -> X^pow in ntt domain, which is a permutation of ntt slots
+	 * @param[out] rx: residues of a(X^pow), must not alias ra
+	 * @param[in] ra: array of np * N residues of a(X) in ntt domain
+	 * @param[in] pow: odd power
+	 * @param[in] np: number of primes
+	 */
+	void inpower(uint64_t* rx, uint64_t* ra, const long pow, const long np);
+
+	/**
+	 * inverse ntt and CRT reconstruction of centered product, reduced mod q
+	 * @param[out] x: polynomial in Z_q[X] / (X^N + 1)
+	 * @param[in, out] rx: array of np * N residues in ntt domain, destroyed
+	 * @param[in] np: number of primes
+	 * @param[in] mod: q
+	 */
+	void reconstruct(ZZX& x, uint64_t* rx, const long np, const ZZ& mod);
+
+	/**
+	 * inverse ntt and CRT reconstruction of centered product, reduced mod 2^logq
+	 * without big integer arithmetic
+	 * @param[out] x: polynomial in Z_q[X] / (X^N + 1) with limbsFor(logq) words
+	 * @param[in, out] rx: array of np * N residues in ntt domain, destroyed
+	 * @param[in] np: number of primes
+	 * @param[in] logq: log of q
+	 */
+	void reconstruct(FlatPoly& x, uint64_t* rx, const long np, const long logq);
+
+
+	//----------------------------------------------------------------------------------
+	//   MULTIPLICATION & SQUARING
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * multiplication in ring Z_q[X] / (X^N + 1)
+	 * @param[out] x: a * b in Z_q[X] / (X^N + 1)
+	 * @param[in] a: polynomial
+	 * @param[in] b: polynomial
+	 * @param[in] mod: q
+	 */
+	void mult(ZZX& x, ZZX& a, ZZX& b, const ZZ& mod);
+
+	/**
+	 * square in ring Z_q[X] / (X^N + 1)
+	 * @param[out] x: a^2 in Z_q[X] / (X^N + 1)
+	 * @param[in] a: polynomial
+	 * @param[in] mod: q
+	 */
+	void square(ZZX& x, ZZX& a, const ZZ& mod);
+
+	/**
+	 * multiplication in ring Z_q[X] / (X^N + 1) for q = 2^logq
+	 * @param[out] x: a * b in Z_q[X] / (X^N + 1)
+	 * @param[in] a: polynomial
+	 * @param[in] b: polynomial
+	 * @param[in] logq: log of q
+	 */
+	void mult(FlatPoly& x, FlatPoly& a, FlatPoly& b, const long logq);
+
+	/**
+	 * multiplication in ring Z_q[X] / (X^N + 1) for q = 2^logq
+	 * @param[out] x: a * b in Z_q[X] / (X^N + 1)
+	 * @param[in] a: polynomial
+	 * @param[in] b: polynomial with signed coefficients
+	 * @param[in] logq: log of q
+	 */
+	void mult(FlatPoly& x, FlatPoly& a, ZZX& b, const long logq);
+
+	/**
+	 * square in ring Z_q[X] / (X^N + 1) for q = 2^logq
+	 * @param[out] x: a^2 in Z_q[X] / (X^N + 1)
+	 * @param[in] a: polynomial
+	 * @param[in] logq: log of q
+	 */
+	void square(FlatPoly& x, FlatPoly& a, const long logq);
+
+
+	//----------------------------------------------------------------------------------
+	//   WORD-SIZE MODULAR ARITHMETIC
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * z1 * 2^64 + z0 mod p for z1 < p < 2^62 with precomputed pr = floor(2^128 / p)
+	 */
+	static inline uint64_t modBarrett(const uint64_t z0, const uint64_t z1, const uint64_t p, const uint64_t pr0, const uint64_t pr1) {
+		unsigned __int128 t = (unsigned __int128) z0 * pr1 + (uint64_t) (((unsigned __int128) z0 * pr0) >> 64);
+		unsigned __int128 u = (unsigned __int128) z1 * pr0 + (uint64_t) t;
+		uint64_t q = z1 * pr1 + (uint64_t) (t >> 64) + (uint64_t) (u >> 64);
+		uint64_t r = z0 - q * p;
+		if(r >= p) r -= p;
+		return r >= p ? r - p : r;
+	}
+
+	/**
+	 * a * b mod p for a, b < p < 2^62 with precomputed pr = floor(2^128 / p)
+	 */
+	static inline uint64_t mulModBarrett(const uint64_t a, const uint64_t b, const uint64_t p, const uint64_t pr0, const uint64_t pr1) {
+		unsigned __int128 z = (unsigned __int128) a * b;
+		return modBarrett((uint64_t) z, (uint64_t) (z >> 64), p, pr0, pr1);
+	}
+
+	/**
+	 * 2^(64 limbs) mod p, the correction for negative coefficients in residue
+	 */
+	static inline uint64_t wrapMod(const long limbs, const uint64_t p, const uint64_t pr0, const uint64_t pr1) {
+		uint64_t r = 1;
+		for (long k = 0; k < limbs; ++k) {
+			r = modBarrett(0, r, p, pr0, pr1);
+		}
+		return r;
+	}
+
+	/**
+	 * residue mod p of a coefficient of limbs words in two's complement
+	 * @param[in] wrap: 2^(64 limbs) mod p
+	 */
+	static inline uint64_t residue(const uint64_t* a, const long limbs, const uint64_t p, const uint64_t pr0, const uint64_t pr1, const uint64_t wrap) {
+		uint64_t r = 0;
+		for (long k = limbs - 1; k >= 0; --k) {
+			r = modBarrett(a[k], r, p, pr0, pr1);
+		}
+		if(WordUtils::isNegative(a, limbs)) {
+			r = r >= wrap ? r - wrap : r + p - wrap;
+		}
+		return r;
+	}
+
+	/**
+	 * residue mod p of a signed coefficient below 2^63 in absolute value
+	 */
+	static inline uint64_t residue(const int64_t a, const uint64_t p, const uint64_t pr0, const uint64_t pr1) {
+		uint64_t r = modBarrett(a < 0 ? -(uint64_t) a : (uint64_t) a, 0, p, pr0, pr1);
+		return a < 0 && r ? p - r : r;
+	}
+
+	/**
+	 * a * w mod p for fixed w < p < 2^63 with precomputed wShoup = floor(w * 2^64 / p)
+	 */
+	static inline uint64_t mulModShoup(const uint64_t a, const uint64_t w, const uint64_t wShoup, const uint64_t p) {
+		uint64_t q = (uint64_t) (((unsigned __int128) a * wShoup) >> 64);
+		uint64_t r = a * w - q * p;
+		return r >= p ? r - p : r;
+	}
+
+	/**
+	 * shoup constant floor(w * 2^64 / p)
+	 */
+	static inline uint64_t shoup(const uint64_t w, const uint64_t p) {
+		return (uint64_t) (((unsigned __int128) w << 64) / p);
+	}
+
+	/**
+	 * a^e mod p
+	 */
+	static uint64_t powMod(uint64_t a, uint64_t e, const uint64_t p);
+
+	/**
+	 * a^{-1} mod prime p
+	 */
+	static uint64_t invMod(const uint64_t a, const uint64_t p);
+
+	/**
+	 * forward negacyclic ntt mod p in place, output in bit-reversed order
+	 * @param[in, out] a: array of N residues
+	 * @param[in] N: ring degree
+	 * @param[in] p: prime = 1 mod 2N
+	 * @param[in] pows: powers of primitive 2N-th root in bit-reversed order
+	 * @param[in] powsShoup: shoup constants of pows
+	 */
+	static void NTT(uint64_t* a, const long N, const uint64_t p, uint64_t* pows, uint64_t* powsShoup);
+
+	/**
+	 * inverse negacyclic ntt mod p in place, input in bit-reversed order
+	 * @param[in, out] a: array of N residues
+	 * @param[in] N: ring degree
+	 * @param[in] p: prime = 1 mod 2N
+	 * @param[in] powsInv: powers of inverse primitive 2N-th root in bit-reversed order
+	 * @param[in] powsInvShoup: shoup constants of powsInv
+	 * @param[in] NInv: N^{-1} mod p
+	 * @param[in] NInvShoup: shoup constant of NInv
+	 */
+	static void INTT(uint64_t* a, const long N, const uint64_t p, uint64_t* powsInv, uint64_t* powsInvShoup, const uint64_t NInv, const uint64_t NInvShoup);
+
+	/**
+	 * tables of root powers in bit-reversed order for negacyclic ntt mod p
+	 * @param[out] pows, powsShoup, powsInv, powsInvShoup: arrays of N elements
+	 * @param[in] logN: log of ring degree
+	 * @param[in] p: prime = 1 mod 2N
+	 */
+	static void rootTables(uint64_t* pows, uint64_t* powsShoup, uint64_t* powsInv, uint64_t* powsInvShoup, const long logN, const uint64_t p);
+
+private:
+
+	void addPrime(const uint64_t p);
+
+};
+
+#endif
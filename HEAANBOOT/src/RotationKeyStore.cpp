@@ -0,0 +1,104 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "RotationKeyStore.h"
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <streambuf>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SerializationUtils.h"
+
+/**
+ * read-only stream buffer over mapped bytes, so that records are parsed in place
+ */
+class MappedBuffer : public streambuf {
+public:
+	MappedBuffer(char* begin, char* end) {
+		setg(begin, begin, end);
+	}
+};
+
+RotationKeyStore::RotationKeyStore(string path, function<void(Key&)> prepare, long maxResident) : prepare(prepare), maxResident(maxResident), data(NULL), size(0) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0) {
+		throw invalid_argument("Unable to open file");
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		throw invalid_argument("Unable to open file");
+	}
+	size = st.st_size;
+	void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapped == MAP_FAILED) {
+		throw invalid_argument("Unable to map file");
+	}
+	data = (char*) mapped;
+	try {
+		MappedBuffer buffer(data, data + size);
+		istream in(&buffer);
+		index = SerializationUtils::readRotationKeyIndex(in);
+	} catch(...) {
+		munmap(data, size);
+		throw;
+	}
+	for (auto const& element : index) {
+		if(element.second < 0 || (size_t) element.second >= size) {
+			munmap(data, size);
+			throw invalid_argument("Rotation key offset is out of file");
+		}
+	}
+}
+
+RotationKeyStore::~RotationKeyStore() {
+	munmap(data, size);
+}
+
+bool RotationKeyStore::contains(long rot) {
+	return index.find(rot) != index.end();
+}
+
+shared_ptr<Key> RotationKeyStore::get(long rot) {
+	{
+		lock_guard<mutex> guard(storeLock);
+		auto it = keys.find(rot);
+		if(it != keys.end()) {
+			recent.splice(recent.begin(), recent, it->second.second);
+			return it->second.first;
+		}
+	}
+	long offset = index.at(rot);
+	MappedBuffer buffer(data + offset, data + size);
+	istream in(&buffer);
+	shared_ptr<Key> key = make_shared<Key>(SerializationUtils::readKeyBinary(in));
+	prepare(*key);
+
+	lock_guard<mutex> guard(storeLock);
+	auto it = keys.find(rot);
+	if(it != keys.end()) {
+		// prepared concurrently by another thread
+		recent.splice(recent.begin(), recent, it->second.second);
+		return it->second.first;
+	}
+	recent.push_front(rot);
+	keys.insert(make_pair(rot, make_pair(key, recent.begin())));
+	while(maxResident > 0 && (long) keys.size() > maxResident) {
+		keys.erase(recent.back());
+		recent.pop_back();
+	}
+	return key;
+}
+
+long RotationKeyStore::resident() {
+	lock_guard<mutex> guard(storeLock);
+	return keys.size();
+}
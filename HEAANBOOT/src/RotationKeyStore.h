@@ -0,0 +1,81 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_ROTATIONKEYSTORE_H_
+#define HEAAN_ROTATIONKEYSTORE_H_
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "Key.h"
+
+using namespace std;
+
+/**
+ * Left rotation keys in a memory-mapped binary file (see SerializationUtils::writeRotationKeyStore),
+ * indexed by rotation amount. A key is parsed and prepared on first use only, and at most
+ * maxResident prepared keys are kept, least recently used first out.
+ * Keys are handed out as shared pointers, so an evicted key stays valid while it is in use.
+ */
+class RotationKeyStore {
+public:
+
+	/**
+	 * maps file and reads its index
+	 * @param[in] path: file written by SerializationUtils::writeRotationKeyStore
+	 * @param[in] prepare: called on every key after it is parsed, e.g. Scheme::transformKey
+	 * @param[in] maxResident: maximum number of prepared keys in memory, 0 for no bound
+	 * @throws invalid_argument if file cannot be mapped or is not a rotation key store
+	 */
+	RotationKeyStore(string path, function<void(Key&)> prepare, long maxResident = 0);
+
+	/**
+	 * unmaps file
+	 */
+	~RotationKeyStore();
+
+	/**
+	 * @return true if file has key for rotation rot
+	 */
+	bool contains(long rot);
+
+	/**
+	 * @param[in] rot: rotation amount
+	 * @return prepared key, parsed from file if not resident
+	 * @throws out_of_range if file has no key for rot
+	 */
+	shared_ptr<Key> get(long rot);
+
+	/**
+	 * @return number of prepared keys in memory
+	 */
+	long resident();
+
+private:
+
+	function<void(Key&)> prepare;
+	long maxResident; ///< 0 for no bound
+
+	char* data; ///< mapped file
+	size_t size; ///< bytes of mapped file
+	map<long, long> index; ///< file offset of key record by rotation amount
+
+	list<long> recent; ///< resident rotation amounts, most recently used first
+	map<long, pair<shared_ptr<Key>, list<long>::iterator>> keys;
+	mutex storeLock; ///< guards recent and keys
+
+	RotationKeyStore(const RotationKeyStore&) = delete;
+	RotationKeyStore& operator=(const RotationKeyStore&) = delete;
+
+};
+
+#endif
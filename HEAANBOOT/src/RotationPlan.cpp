@@ -0,0 +1,119 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "RotationPlan.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+RotationPlan::RotationPlan(long Nh, const vector<long>& rots, long maxKeys) : Nh(Nh) {
+	vector<long> targets;
+	for (long rot : rots) {
+		long r = ((rot % Nh) + Nh) % Nh;
+		if(r != 0 && find(targets.begin(), targets.end(), r) == targets.end()) {
+			targets.push_back(r);
+		}
+	}
+
+	if((long) targets.size() <= maxKeys) {
+		keys = targets;
+		search();
+		return;
+	}
+
+	vector<long> candidates = targets;
+	for (long i = 1; i < Nh; i <<= 1) {
+		if(find(candidates.begin(), candidates.end(), i) == candidates.end()) candidates.push_back(i);
+		if(find(candidates.begin(), candidates.end(), Nh - i) == candidates.end()) candidates.push_back(Nh - i);
+	}
+
+	// a key c saves dist[r] - 1 - dist[r - c] switches on r if used once more;
+	// unreachable amounts count as Nh switches, more than any path
+	while((long) keys.size() < maxKeys) {
+		search();
+		long best = -1;
+		long bestGain = 0;
+		for (long c : candidates) {
+			if(find(keys.begin(), keys.end(), c) != keys.end()) continue;
+			long gain = 0;
+			for (long r : targets) {
+				long d = dist[r] < 0 ? Nh : dist[r];
+				long prev = dist[(r - c + Nh) % Nh];
+				if(prev >= 0 && prev + 1 < d) gain += d - prev - 1;
+			}
+			if(gain > bestGain) {
+				best = c;
+				bestGain = gain;
+			}
+		}
+		if(best < 0) break;
+		keys.push_back(best);
+	}
+	search();
+
+	for (long r : targets) {
+		if(dist[r] < 0) {
+			long logNh = 0;
+			while((1 << logNh) < Nh) logNh++;
+			if(maxKeys < logNh) {
+				throw invalid_argument("number of keys is too small for rotations");
+			}
+			// powers of two reach every amount
+			keys.clear();
+			for (long i = 1; i < Nh; i <<= 1) {
+				keys.push_back(i);
+			}
+			search();
+			break;
+		}
+	}
+}
+
+void RotationPlan::search() {
+	dist.assign(Nh, -1);
+	last.assign(Nh, -1);
+	vector<long> queue(1, 0);
+	dist[0] = 0;
+	for (long i = 0; i < (long) queue.size(); ++i) {
+		long r = queue[i];
+		for (long j = 0; j < (long) keys.size(); ++j) {
+			long next = (r + keys[j]) % Nh;
+			if(dist[next] < 0) {
+				dist[next] = dist[r] + 1;
+				last[next] = j;
+				queue.push_back(next);
+			}
+		}
+	}
+}
+
+long RotationPlan::nearest(long rot, long slots) const {
+	long res = -1;
+	for (long r = ((rot % slots) + slots) % slots; r < Nh; r += slots) {
+		if(dist[r] >= 0 && (res < 0 || dist[r] < dist[res])) res = r;
+	}
+	return res;
+}
+
+long RotationPlan::cost(long rot, long slots) const {
+	long r = nearest(rot, slots);
+	return r < 0 ? -1 : dist[r];
+}
+
+vector<long> RotationPlan::path(long rot, long slots) const {
+	long r = nearest(rot, slots);
+	if(r < 0) {
+		throw invalid_argument("rotation cannot be reached by planned keys");
+	}
+	vector<long> res;
+	while(r != 0) {
+		long key = keys[last[r]];
+		res.push_back(key);
+		r = (r - key + Nh) % Nh;
+	}
+	return res;
+}
@@ -0,0 +1,70 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_ROTATIONPLAN_H_
+#define HEAAN_ROTATIONPLAN_H_
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Choice of left rotation keys for a known set of rotations under a bound on the number of keys,
+ * and shortest key switching paths over the chosen keys.
+ * Rotations are amounts mod Nh, so right rotations are the keys Nh - rot and negative amounts are allowed.
+ * If all rotations fit the bound, each gets its own key. Otherwise keys are picked greedily
+ * among the rotations and the signed powers of two 2^i, Nh - 2^i, each time the one
+ * that saves most key switches over the rotations.
+ * Paths come from a breadth-first search over Z_Nh, keys may be used several times on a path.
+ */
+class RotationPlan {
+public:
+
+	long Nh; ///< number of slots of full packing
+	vector<long> keys; ///< left rotation amounts of chosen keys
+
+	/**
+	 * @param[in] Nh: N / 2, power of two
+	 * @param[in] rots: rotation amounts the workload uses, mod Nh
+	 * @param[in] maxKeys: maximum number of keys
+	 * @throws invalid_argument if maxKeys keys cannot reach all rotations
+	 */
+	RotationPlan(long Nh, const vector<long>& rots, long maxKeys);
+
+	/**
+	 * @param[in] rot: left rotation amount
+	 * @param[in] slots: number of slots, power of two dividing Nh; rotations are taken mod slots
+	 * @return number of key switches of shortest path, -1 if rot cannot be reached
+	 */
+	long cost(long rot, long slots) const;
+
+	/**
+	 * @param[in] rot: left rotation amount
+	 * @param[in] slots: number of slots, power of two dividing Nh; rotations are taken mod slots
+	 * @return keys of shortest path, their sum is rot mod slots
+	 * @throws invalid_argument if rot cannot be reached
+	 */
+	vector<long> path(long rot, long slots) const;
+
+private:
+
+	vector<long> dist; ///< number of key switches to reach each amount, -1 if unreachable
+	vector<long> last; ///< index of last key of a shortest path to each amount
+
+	/**
+	 * fills dist and last for current keys
+	 */
+	void search();
+
+	/**
+	 * @return amount in [0, Nh) equal to rot mod slots with shortest path, -1 if none is reachable
+	 */
+	long nearest(long rot, long slots) const;
+
+};
+
+#endif
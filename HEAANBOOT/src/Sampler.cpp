@@ -0,0 +1,333 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "Sampler.h"
+
+#include <NTL/ZZ.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HEAAN_SAMPLER_SIMD
+#include <immintrin.h>
+#endif
+
+static mutex masterLock; ///< guards master seed and stream numbers
+static unsigned char masterSeed[SAMPLER_SEED_BYTES];
+static bool isMasterSeeded = false;
+static uint64_t nextStream = 0; ///< stream number of the next local stream
+static atomic<long> masterGeneration(0); ///< incremented by setMasterSeed
+
+Sampler::Sampler() : pos(16 * BLOCKS) {
+	unsigned char zero[SAMPLER_SEED_BYTES] = {0};
+	reseed(zero, 0);
+}
+
+Sampler::Sampler(const unsigned char* seed, uint64_t stream) : pos(16 * BLOCKS) {
+	reseed(seed, stream);
+}
+
+void Sampler::reseed(const unsigned char* seed, uint64_t stream) {
+	state[0] = 0x61707865;
+	state[1] = 0x3320646e;
+	state[2] = 0x79622d32;
+	state[3] = 0x6b206574;
+	for (long i = 0; i < 8; ++i) {
+		state[4 + i] = (uint32_t) seed[4 * i] | ((uint32_t) seed[4 * i + 1] << 8) | ((uint32_t) seed[4 * i + 2] << 16) | ((uint32_t) seed[4 * i + 3] << 24);
+	}
+	state[12] = 0;
+	state[13] = 0;
+	state[14] = (uint32_t) stream;
+	state[15] = (uint32_t) (stream >> 32);
+	pos = 16 * BLOCKS;
+}
+
+Sampler& Sampler::local() {
+	static thread_local Sampler sampler;
+	static thread_local long generation = -1;
+	if(generation != masterGeneration.load()) {
+		lock_guard<mutex> guard(masterLock);
+		if(!isMasterSeeded) {
+			GetCurrentRandomStream().get(masterSeed, SAMPLER_SEED_BYTES);
+			isMasterSeeded = true;
+		}
+		sampler.reseed(masterSeed, nextStream++);
+		generation = masterGeneration.load();
+	}
+	return sampler;
+}
+
+void Sampler::setMasterSeed(const unsigned char* seed) {
+	lock_guard<mutex> guard(masterLock);
+	copy(seed, seed + SAMPLER_SEED_BYTES, masterSeed);
+	isMasterSeeded = true;
+	nextStream = 0;
+	masterGeneration++;
+}
+
+
+//----------------------------------------------------------------------------------
+//   RAW OUTPUT
+//----------------------------------------------------------------------------------
+
+
+static inline uint32_t rotl(uint32_t x, int n) {
+	return (x << n) | (x >> (32 - n));
+}
+
+/**
+ * ChaCha quarter round on the same words of all blocks, which compilers vectorize over blocks
+ */
+template<long BLOCKS>
+static inline void quarterRound(uint32_t x[16][BLOCKS], int a, int b, int c, int d) {
+	for (long l = 0; l < BLOCKS; ++l) {
+		x[a][l] += x[b][l]; x[d][l] = rotl(x[d][l] ^ x[a][l], 16);
+		x[c][l] += x[d][l]; x[b][l] = rotl(x[b][l] ^ x[c][l], 12);
+		x[a][l] += x[b][l]; x[d][l] = rotl(x[d][l] ^ x[a][l], 8);
+		x[c][l] += x[d][l]; x[b][l] = rotl(x[b][l] ^ x[c][l], 7);
+	}
+}
+
+void Sampler::refill() {
+	uint32_t x[16][BLOCKS], y[16][BLOCKS];
+	uint64_t counter = (uint64_t) state[12] | ((uint64_t) state[13] << 32);
+	for (long i = 0; i < 16; ++i) {
+		for (long l = 0; l < BLOCKS; ++l) {
+			x[i][l] = state[i];
+		}
+	}
+	for (long l = 0; l < BLOCKS; ++l) {
+		x[12][l] = (uint32_t) (counter + l);
+		x[13][l] = (uint32_t) ((counter + l) >> 32);
+	}
+	copy(&x[0][0], &x[0][0] + 16 * BLOCKS, &y[0][0]);
+	for (long r = 0; r < 10; ++r) {
+		quarterRound<BLOCKS>(x, 0, 4, 8, 12);
+		quarterRound<BLOCKS>(x, 1, 5, 9, 13);
+		quarterRound<BLOCKS>(x, 2, 6, 10, 14);
+		quarterRound<BLOCKS>(x, 3, 7, 11, 15);
+		quarterRound<BLOCKS>(x, 0, 5, 10, 15);
+		quarterRound<BLOCKS>(x, 1, 6, 11, 12);
+		quarterRound<BLOCKS>(x, 2, 7, 8, 13);
+		quarterRound<BLOCKS>(x, 3, 4, 9, 14);
+	}
+	for (long l = 0; l < BLOCKS; ++l) {
+		for (long i = 0; i < 16; ++i) {
+			out[16 * l + i] = x[i][l] + y[i][l];
+		}
+	}
+	counter += BLOCKS;
+	state[12] = (uint32_t) counter;
+	state[13] = (uint32_t) (counter >> 32);
+	pos = 0;
+}
+
+void Sampler::get(unsigned char* res, long n) {
+	for (long i = 0; i < n; i += 4) {
+		if(pos == 16 * BLOCKS) refill();
+		uint32_t w = out[pos++];
+		for (long b = 0; b < 4 && i + b < n; ++b) {
+			res[i + b] = (unsigned char) (w >> (8 * b));
+		}
+	}
+}
+
+uint64_t Sampler::next() {
+	if(pos + 2 > 16 * BLOCKS) refill();
+	uint64_t w = (uint64_t) out[pos] | ((uint64_t) out[pos + 1] << 32);
+	pos += 2;
+	return w;
+}
+
+uint64_t Sampler::nextBelow(uint64_t bound) {
+	uint64_t mask = bound - 1;
+	for (long k = 1; k < 64; k <<= 1) {
+		mask |= mask >> k;
+	}
+	uint64_t r;
+	do {
+		r = next() & mask;
+	} while(r >= bound);
+	return r;
+}
+
+
+//----------------------------------------------------------------------------------
+//   POLYNOMIALS
+//----------------------------------------------------------------------------------
+
+
+/**
+ * table t of P(|x| <= k) * 2^63 for rounded Gaussian x, k < tail, shared between calls
+ */
+static const vector<int64_t>& gaussTable(const double stdev) {
+	static map<double, vector<int64_t>> tables;
+	static mutex tablesLock;
+	lock_guard<mutex> guard(tablesLock);
+	auto it = tables.find(stdev);
+	if(it == tables.end()) {
+		long tail = (long) ceil(8 * stdev);
+		vector<double> rho(tail + 1);
+		double sum = 0;
+		for (long k = 0; k <= tail; ++k) {
+			rho[k] = exp(-(double) k * k / (2 * stdev * stdev));
+			sum += k == 0 ? rho[k] : 2 * rho[k];
+		}
+		vector<int64_t> table(tail);
+		double cum = 0;
+		for (long k = 0; k < tail; ++k) {
+			cum += (k == 0 ? rho[k] : 2 * rho[k]) / sum;
+			table[k] = cum < 1 ? (int64_t) ldexp(cum, 63) : INT64_MAX;
+		}
+		it = tables.insert(pair<double, vector<int64_t>>(stdev, table)).first;
+	}
+	return it->second;
+}
+
+void Sampler::sampleUniform2(FlatPoly& res, const long size, const long bits) {
+	long limbs = limbsFor(bits);
+	res.reshape(size, limbs);
+	for (long i = 0; i < size * limbs; ++i) {
+		res.words[i] = next();
+	}
+	for (long i = 0; i < size; ++i) {
+		WordUtils::maskWords(res.coeff(i), bits, limbs);
+	}
+}
+
+/**
+ * a[j] = number of entries of t at most r[j] with sign bit cleared, j < 64.
+ * Every entry is compared with every sample, so the time does not depend on the samples.
+ */
+static void countBelowScalar(int64_t* a, const int64_t* r, const int64_t* t, const long tail) {
+	for (long j = 0; j < 64; ++j) {
+		int64_t x = r[j] & INT64_MAX;
+		int64_t acc = 0;
+		for (long k = 0; k < tail; ++k) {
+			acc += x >= t[k];
+		}
+		a[j] = acc;
+	}
+}
+
+#ifdef HEAAN_SAMPLER_SIMD
+
+__attribute__((target("avx2")))
+static void countBelowAvx2(int64_t* a, const int64_t* r, const int64_t* t, const long tail) {
+	__m256i mask = _mm256_set1_epi64x(INT64_MAX);
+	__m256i x[16], acc[16];
+	for (long j = 0; j < 16; ++j) {
+		x[j] = _mm256_and_si256(_mm256_loadu_si256((const __m256i*) (r + 4 * j)), mask);
+		acc[j] = _mm256_set1_epi64x(tail);
+	}
+	// acc = tail - #{k : x < t[k]}, compare lanes are -1 when true
+	for (long k = 0; k < tail; ++k) {
+		__m256i tk = _mm256_set1_epi64x(t[k]);
+		for (long j = 0; j < 16; ++j) {
+			acc[j] = _mm256_add_epi64(acc[j], _mm256_cmpgt_epi64(tk, x[j]));
+		}
+	}
+	for (long j = 0; j < 16; ++j) {
+		_mm256_storeu_si256((__m256i*) (a + 4 * j), acc[j]);
+	}
+}
+
+#endif
+
+typedef void (*CountBelow)(int64_t* a, const int64_t* r, const int64_t* t, const long tail);
+
+static CountBelow chooseCountBelow() {
+#ifdef HEAAN_SAMPLER_SIMD
+	if(__builtin_cpu_supports("avx2")) return countBelowAvx2;
+#endif
+	return countBelowScalar;
+}
+
+void Sampler::sampleGauss(int64_t* res, const long size, const double stdev) {
+	static const CountBelow countBelow = chooseCountBelow();
+	const vector<int64_t>& table = gaussTable(stdev);
+	int64_t r[64], a[64];
+	for (long i = 0; i < size; i += 64) {
+		long len = min(size - i, 64L);
+		for (long j = 0; j < 64; ++j) {
+			r[j] = (int64_t) next();
+		}
+		countBelow(a, r, table.data(), table.size());
+		for (long j = 0; j < len; ++j) {
+			res[i + j] = r[j] < 0 ? -a[j] : a[j];
+		}
+	}
+}
+
+void Sampler::sampleGauss(FlatPoly& res, const long size, const double stdev, const long logq) {
+	long limbs = limbsFor(logq);
+	int64_t* vals = new int64_t[size];
+	sampleGauss(vals, size, stdev);
+	res.reshape(size, limbs);
+	for (long i = 0; i < size; ++i) {
+		uint64_t* ri = res.coeff(i);
+		ri[0] = (uint64_t) vals[i];
+		fill(ri + 1, ri + limbs, vals[i] < 0 ? ~(uint64_t) 0 : 0);
+		WordUtils::maskWords(ri, logq, limbs);
+	}
+	delete[] vals;
+}
+
+void Sampler::sampleZO(int64_t* res, const long size) {
+	uint64_t w = 0;
+	for (long i = 0; i < size; ++i) {
+		if((i & 31) == 0) w = next();
+		res[i] = (w & 1) ? ((w & 2) ? -1 : 1) : 0;
+		w >>= 2;
+	}
+}
+
+void Sampler::sampleHWT(int64_t* res, const long size, const long h) {
+	if(h > size) {
+		throw invalid_argument("hamming weight must not exceed polynomial degree");
+	}
+	fill(res, res + size, 0);
+	uint64_t w = next();
+	long idx = 0;
+	while(idx < h) {
+		long i = nextBelow(size);
+		if(res[i] == 0) {
+			if((idx & 63) == 0 && idx > 0) w = next();
+			res[i] = ((w >> (idx & 63)) & 1) ? -1 : 1;
+			idx++;
+		}
+	}
+}
+
+void Sampler::sampleBinary(int64_t* res, const long size) {
+	uint64_t w = 0;
+	for (long i = 0; i < size; ++i) {
+		if((i & 63) == 0) w = next();
+		res[i] = w & 1;
+		w >>= 1;
+	}
+}
+
+void Sampler::sampleBinary(int64_t* res, const long size, const long h) {
+	if(h > size) {
+		throw invalid_argument("hamming weight must not exceed polynomial degree");
+	}
+	fill(res, res + size, 0);
+	long idx = 0;
+	while(idx < h) {
+		long i = nextBelow(size);
+		if(res[i] == 0) {
+			res[i] = 1;
+			idx++;
+		}
+	}
+}
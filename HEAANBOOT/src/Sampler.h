@@ -0,0 +1,153 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_SAMPLER_H_
+#define HEAAN_SAMPLER_H_
+
+#include <cstdint>
+
+#include "FlatPoly.h"
+
+using namespace std;
+
+static const long SAMPLER_SEED_BYTES = 32; ///< size of seeds of sampler streams
+
+/**
+ * Random stream of ChaCha20 blocks under a 32-byte seed, with a 64-bit stream number as nonce
+ * and a 64-bit block counter, and samplers that write into coefficient buffers.
+ * Streams with the same seed and different stream numbers are independent.
+ *
+ * Sampler::local() is the stream of the calling thread. All local streams derive from one
+ * master seed and get stream numbers in order of first use, so setMasterSeed makes
+ * single-threaded runs reproducible. A Sampler itself is not thread-safe.
+ */
+class Sampler {
+public:
+
+	Sampler();
+
+	/**
+	 * @param[in] seed: SAMPLER_SEED_BYTES bytes
+	 * @param[in] stream: stream number
+	 */
+	Sampler(const unsigned char* seed, uint64_t stream = 0);
+
+	/**
+	 * restarts at block 0 of given stream
+	 * @param[in] seed: SAMPLER_SEED_BYTES bytes
+	 * @param[in] stream: stream number
+	 */
+	void reseed(const unsigned char* seed, uint64_t stream = 0);
+
+	/**
+	 * @return stream of the calling thread, reseeded if the master seed changed since its last use
+	 */
+	static Sampler& local();
+
+	/**
+	 * sets master seed of local streams, which are renumbered from 0 on their next use.
+	 * Without it, the master seed is drawn from the current NTL random stream on first use.
+	 * @param[in] seed: SAMPLER_SEED_BYTES bytes
+	 */
+	static void setMasterSeed(const unsigned char* seed);
+
+
+	//----------------------------------------------------------------------------------
+	//   RAW OUTPUT
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * @param[out] res: n random bytes
+	 */
+	void get(unsigned char* res, long n);
+
+	/**
+	 * @return 64 random bits
+	 */
+	uint64_t next();
+
+	/**
+	 * @return uniform number in [0, bound), bound > 0
+	 */
+	uint64_t nextBelow(uint64_t bound);
+
+
+	//----------------------------------------------------------------------------------
+	//   POLYNOMIALS
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * uniform coefficients in [0, 2^bits)
+	 * @param[out] res: polynomial with limbsFor(bits) words per coefficient
+	 * @param[in] size: polynomial degree
+	 * @param[in] bits: number of bits
+	 */
+	void sampleUniform2(FlatPoly& res, const long size, const long bits);
+
+	/**
+	 * rounded Gaussian coefficients by inversion of a cumulative distribution table
+	 * over [-tail, tail], tail = 8 stdev rounded up
+	 * @param[out] res: size coefficients
+	 * @param[in] size: polynomial degree
+	 * @param[in] stdev: standard deviation
+	 */
+	void sampleGauss(int64_t* res, const long size, const double stdev);
+
+	/**
+	 * sampleGauss mod 2^logq, written to words directly
+	 * @param[out] res: polynomial with limbsFor(logq) words per coefficient
+	 * @param[in] size: polynomial degree
+	 * @param[in] stdev: standard deviation
+	 * @param[in] logq: log of modulus
+	 */
+	void sampleGauss(FlatPoly& res, const long size, const double stdev, const long logq);
+
+	/**
+	 * coefficients 0 with probability 1/2 and -1, 1 with probability 1/4 each
+	 * @param[out] res: size coefficients
+	 * @param[in] size: polynomial degree
+	 */
+	void sampleZO(int64_t* res, const long size);
+
+	/**
+	 * h coefficients -1 or 1 with probability 1/2 each at distinct uniform positions, 0 elsewhere
+	 * @param[out] res: size coefficients
+	 * @param[in] size: polynomial degree
+	 * @param[in] h: number of nonzero coefficients
+	 */
+	void sampleHWT(int64_t* res, const long size, const long h);
+
+	/**
+	 * coefficients 0 or 1 with probability 1/2 each
+	 * @param[out] res: size coefficients
+	 * @param[in] size: polynomial degree
+	 */
+	void sampleBinary(int64_t* res, const long size);
+
+	/**
+	 * h coefficients 1 at distinct uniform positions, 0 elsewhere
+	 * @param[out] res: size coefficients
+	 * @param[in] size: polynomial degree
+	 * @param[in] h: number of nonzero coefficients
+	 */
+	void sampleBinary(int64_t* res, const long size, const long h);
+
+private:
+
+	static const long BLOCKS = 8; ///< ChaCha20 blocks computed together
+
+	uint32_t state[16]; ///< constants, seed, block counter, stream number
+	uint32_t out[16 * BLOCKS]; ///< output of last blocks
+	long pos; ///< next unused word of out
+
+	void refill();
+
+};
+
+#endif
@@ -15,124 +15,214 @@
 #include "EvaluatorUtils.h"
 #include "NumUtils.h"
 #include "Ring2Utils.h"
+#include "RingMultiplier.h"
 #include "StringUtils.h"
 
 //-----------------------------------------
 
-Scheme::Scheme(Context& context) : context(context) {
+Scheme::Scheme(Context& context) : context(context), encPool(NULL), rotKeyStore(NULL), rotPlan(NULL) {
 }
 
-Scheme::Scheme(SecretKey& secretKey, Context& context) : context(context) {
+Scheme::Scheme(SecretKey& secretKey, Context& context) : context(context), encPool(NULL), rotKeyStore(NULL), rotPlan(NULL) {
 	addEncKey(secretKey);
 	addMultKey(secretKey);
 };
 
+Scheme::~Scheme() {
+	stopEncryptionPool();
+	closeRotationKeyStore();
+	delete rotPlan;
+}
+
 //----------------------------------------------------------------------------------
 //   KEYS GENERATION
 //----------------------------------------------------------------------------------
 
 
 void Scheme::addEncKey(SecretKey& secretKey) {
-	ZZX ex, ax, bx;
+	unsigned char seed[SEED_BYTES];
 
-	NumUtils::sampleUniform2(ax, context.N, context.logQQ);
-	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::mult(bx, secretKey.sx, ax, context.QQ, context.N);
-	Ring2Utils::sub(bx, ex, bx, context.QQ, context.N);
+	NumUtils::sampleSeed(seed);
+	FlatPoly fax, fex, fbx;
+	NumUtils::sampleGauss(fex, context.N, context.sigma, context.logQQ);
+	NumUtils::sampleUniform2(fax, seed, context.N, context.logQQ);
+	Ring2Utils::mult(fbx, fax, secretKey.tx, context.logQQ, context.N);
+	Ring2Utils::sub(fbx, fex, fbx, context.logQQ, context.N);
 
-	keyMap.insert(pair<long, Key>(ENCRYPTION, Key(ax, bx)));
+	keyMap.insert(pair<long, Key>(ENCRYPTION, Key(fax, fbx)));
+	keyMap.at(ENCRYPTION).setSeed(seed, context.logQQ);
+	transformEncKey(keyMap.at(ENCRYPTION));
 }
 
 void Scheme::addMultKey(SecretKey& secretKey) {
-	ZZX ex, ax, bx, sxsx;
-
-	Ring2Utils::mult(sxsx, secretKey.sx, secretKey.sx, context.Q, context.N);
-	Ring2Utils::leftShiftAndEqual(sxsx, context.logQ, context.QQ, context.N);
-	NumUtils::sampleUniform2(ax, context.N, context.logQQ);
-	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::addAndEqual(ex, sxsx, context.QQ, context.N);
-	Ring2Utils::mult(bx, secretKey.sx, ax, context.QQ, context.N);
-	Ring2Utils::sub(bx, ex, bx, context.QQ, context.N);
+	FlatPoly sxsx(secretKey.sx, context.logQP, context.N);
+	Ring2Utils::multAndEqual(sxsx, secretKey.tx, context.logQP, context.N);
 
-	keyMap.insert(pair<long, Key>(MULTIPLICATION, Key(ax, bx)));
+	keyMap.insert(pair<long, Key>(MULTIPLICATION, Key()));
+	generateSwitchKey(keyMap.at(MULTIPLICATION), sxsx, secretKey);
 }
 
 void Scheme::addConjKey(SecretKey& secretKey) {
-	ZZX ex, ax, bx, sxconj;
+	FlatPoly sxconj(secretKey.sx, context.logQP, context.N);
+	Ring2Utils::conjugate(sxconj, sxconj, context.logQP, context.N);
 
-	Ring2Utils::conjugate(sxconj, secretKey.sx, context.N);
-	Ring2Utils::leftShiftAndEqual(sxconj, context.logQ, context.QQ, context.N);
-	NumUtils::sampleUniform2(ax, context.N, context.logQQ);
-	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::addAndEqual(ex, sxconj, context.QQ, context.N);
-	Ring2Utils::mult(bx, secretKey.sx, ax, context.QQ, context.N);
-	Ring2Utils::sub(bx, ex, bx, context.QQ, context.N);
-
-	keyMap.insert(pair<long, Key>(CONJUGATION, Key(ax, bx)));
+	keyMap.insert(pair<long, Key>(CONJUGATION, Key()));
+	generateSwitchKey(keyMap.at(CONJUGATION), sxconj, secretKey);
 }
 
 void Scheme::addLeftRotKey(SecretKey& secretKey, long rot) {
-	ZZX ex, ax, bx, sxrot;
-
-	Ring2Utils::inpower(sxrot, secretKey.sx, context.rotGroup[rot], context.Q, context.N);
-	Ring2Utils::leftShiftAndEqual(sxrot, context.logQ, context.QQ, context.N);
-	NumUtils::sampleUniform2(ax, context.N, context.logQQ);
-	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::addAndEqual(ex, sxrot, context.QQ, context.N);
-	Ring2Utils::mult(bx, secretKey.sx, ax, context.QQ, context.N);
-	Ring2Utils::sub(bx, ex, bx, context.QQ, context.N);
+	leftRotKeyMap.insert(pair<long, Key>(rot, Key()));
+	generateLeftRotKey(leftRotKeyMap.at(rot), secretKey, rot);
+}
 
-	leftRotKeyMap.insert(pair<long, Key>(rot, Key(ax, bx)));
+void Scheme::addLeftRotKeys(SecretKey& secretKey, const vector<long>& rots) {
+	vector<long> missing;
+	for (long rot : rots) {
+		if(leftRotKeyMap.find(rot) == leftRotKeyMap.end()) {
+			missing.push_back(rot);
+			leftRotKeyMap.insert(pair<long, Key>(rot, Key()));
+		}
+	}
+	// map nodes are inserted up front, so threads only fill distinct keys
+	vector<Key*> keys;
+	for (long rot : missing) {
+		keys.push_back(&leftRotKeyMap.at(rot));
+	}
+	long size = missing.size();
+	NTL_EXEC_RANGE(size, first, last);
+	for (long j = first; j < last; ++j) {
+		generateLeftRotKey(*keys[j], secretKey, missing[j]);
+	}
+	NTL_EXEC_RANGE_END;
 }
 
 void Scheme::addLeftRotKeys(SecretKey& secretKey) {
+	vector<long> rots;
 	for (long i = 0; i < context.logNh; ++i) {
-		long idx = 1 << i;
-		if(leftRotKeyMap.find(idx) == leftRotKeyMap.end()) {
-			addLeftRotKey(secretKey, idx);
-		}
+		rots.push_back(1 << i);
 	}
+	addLeftRotKeys(secretKey, rots);
 }
 
 void Scheme::addRightRotKeys(SecretKey& secretKey) {
+	vector<long> rots;
 	for (long i = 0; i < context.logNh; ++i) {
-		long idx = context.N/2 - (1 << i);
-		if(leftRotKeyMap.find(idx) == leftRotKeyMap.end()) {
-			addLeftRotKey(secretKey, idx);
-		}
+		rots.push_back(context.N/2 - (1 << i));
 	}
+	addLeftRotKeys(secretKey, rots);
 }
 
 void Scheme::addBootKey(SecretKey& secretKey, long logSlots, long logp) {
 	context.addBootContext(logSlots, logp);
 
 	addConjKey(secretKey);
-	addLeftRotKeys(secretKey);
 
 	long logk = logSlots / 2;
 	long k = 1 << logk;
 	long m = 1 << (logSlots - logk);
 
+	vector<long> rots;
+	for (long i = 0; i < context.logNh; ++i) {
+		rots.push_back(1 << i);
+	}
 	for (long i = 1; i < k; ++i) {
-		if(leftRotKeyMap.find(i) == leftRotKeyMap.end()) {
-			addLeftRotKey(secretKey, i);
-		}
+		rots.push_back(i);
 	}
-
 	for (long i = 1; i < m; ++i) {
-		long idx = i * k;
-		if(leftRotKeyMap.find(idx) == leftRotKeyMap.end()) {
-			addLeftRotKey(secretKey, idx);
-		}
+		rots.push_back(i * k);
 	}
+	addLeftRotKeys(secretKey, rots);
 }
 
 void Scheme::addSortKeys(SecretKey& secretKey, long size) {
+	vector<long> rots;
 	for (long i = 1; i < size; ++i) {
-		if(leftRotKeyMap.find(i) == leftRotKeyMap.end()) {
-			addLeftRotKey(secretKey, i);
+		rots.push_back(i);
+	}
+	addLeftRotKeys(secretKey, rots);
+}
+
+void Scheme::addPlannedRotKeys(SecretKey& secretKey, const vector<long>& rots, long memoryBudget) {
+	RotationPlan* plan = new RotationPlan(context.Nh, rots, memoryBudget / rotKeyBytes());
+	delete rotPlan;
+	rotPlan = plan;
+	addLeftRotKeys(secretKey, rotPlan->keys);
+	// reductions to each level would take memory beyond the budget
+	for (long rot : rotPlan->keys) {
+		leftRotKeyMap.at(rot).setKeepsReduced(false);
+	}
+}
+
+long Scheme::rotKeyBytes() {
+	long np = keySwitchPrimes(context.logQ);
+	return sizeof(uint64_t) * context.N * context.dnum * (2 * np + limbsFor(context.logQP));
+}
+
+void Scheme::generateLeftRotKey(Key& key, SecretKey& secretKey, long rot) {
+	FlatPoly sxrot(secretKey.sx, context.logQP, context.N);
+	Ring2Utils::inpower(sxrot, sxrot, context.getInpowerTable(context.rotGroup[rot]), context.logQP, context.N);
+	generateSwitchKey(key, sxrot, secretKey);
+}
+
+void Scheme::generateSwitchKey(Key& key, FlatPoly& sxnew, SecretKey& secretKey) {
+	key.digitKeys.assign(context.dnum - 1, Key());
+	for (long j = 0; j < context.dnum; ++j) {
+		// digit j encrypts P * 2^(j * logP) * sxnew
+		Key& digitKey = j == 0 ? key : key.digitKeys[j - 1];
+		unsigned char seed[SEED_BYTES];
+		FlatPoly sxshift, fex;
+		Ring2Utils::leftShift(sxshift, sxnew, context.logP * (j + 1), context.logQP, context.N);
+		NumUtils::sampleSeed(seed);
+		NumUtils::sampleGauss(fex, context.N, context.sigma, context.logQP);
+		NumUtils::sampleUniform2(digitKey.ax, seed, context.N, context.logQP);
+		Ring2Utils::addAndEqual(fex, sxshift, context.logQP, context.N);
+		Ring2Utils::mult(digitKey.bx, digitKey.ax, secretKey.tx, context.logQP, context.N);
+		Ring2Utils::sub(digitKey.bx, fex, digitKey.bx, context.logQP, context.N);
+		digitKey.setSeed(seed, context.logQP);
+	}
+	transformKey(key);
+}
+
+void Scheme::transformKey(Key& key) {
+	if((long) key.digitKeys.size() != context.dnum - 1) {
+		throw invalid_argument("switching key was generated for other dnum");
+	}
+	long np = keySwitchPrimes(context.logQ);
+	key.transform(np, context.N);
+	key.releaseAx();
+	for (Key& digitKey : key.digitKeys) {
+		digitKey.transform(np, context.N);
+		digitKey.releaseAx();
+	}
+}
+
+void Scheme::transformEncKey(Key& key) {
+	RingMultiplier& multiplier = RingMultiplier::getInstance(context.N);
+	long np = multiplier.primesNeeded(context.logQQ + 1 + context.logN);
+	key.transform(np, context.N);
+	key.releaseAx();
+}
+
+void Scheme::transformKeys() {
+	for (auto& element : keyMap) {
+		if(element.first != ENCRYPTION) {
+			transformKey(element.second);
+		} else {
+			transformEncKey(element.second);
 		}
 	}
+	for (auto& element : leftRotKeyMap) {
+		transformKey(element.second);
+	}
+}
+
+void Scheme::releaseReducedKeys() {
+	for (auto& element : keyMap) {
+		element.second.releaseReduced();
+	}
+	for (auto& element : leftRotKeyMap) {
+		element.second.releaseReduced();
+	}
 }
 
 
@@ -142,33 +232,85 @@ void Scheme::addSortKeys(SecretKey& secretKey, long size) {
 
 
 Plaintext Scheme::encode(double* vals, long slots, long logp, long logq) {
-	ZZX mx = context.encode(vals, slots, logp + context.logQ);
-	return Plaintext(mx, logp, logq, slots, false);
+	FlatPoly mx;
+	context.encode(mx, vals, slots, logp + context.logQ, logq + context.logQ);
+	return Plaintext(move(mx), logp, logq, slots, false);
 }
 
 Plaintext Scheme::encode(complex<double>* vals, long slots, long logp, long logq) {
-	ZZX mx = context.encode(vals, slots, logp + context.logQ);
-	return Plaintext(mx, logp, logq, slots, true);
+	FlatPoly mx;
+	context.encode(mx, vals, slots, logp + context.logQ, logq + context.logQ);
+	return Plaintext(move(mx), logp, logq, slots, true);
 }
 
 complex<double>* Scheme::decode(Plaintext& msg) {
-	ZZ q = context.qpowvec[msg.logq];
 	long slots = msg.slots;
 	long gap = context.Nh / slots;
 	complex<double>* res = new complex<double>[slots];
-	ZZ tmp;
+	EvaluatorUtils::scaleDownToReal((double*) res, 2, msg.mx, 0, gap, slots, msg.logq, msg.logp);
+	EvaluatorUtils::scaleDownToReal((double*) res + 1, 2, msg.mx, context.Nh, gap, slots, msg.logq, msg.logp);
+	context.fftSpecial(res, slots);
+	return res;
+}
 
-	for (long i = 0, idx = 0; i < slots; ++i, idx += gap) {
-		rem(tmp, msg.mx[idx], q);
-		if(NumBits(tmp) == msg.logq) tmp -= q;
-		res[i].real(EvaluatorUtils::scaleDownToReal(tmp, msg.logp));
+void Scheme::encodeBatch(Plaintext* res, complex<double>** vals, long count, long slots, long logp, long logq) {
+	const FftPlan& plan = context.getFftPlan(slots);
+	NTL_EXEC_RANGE(count, first, last);
+	complex<double>* uvals = new complex<double>[slots];
+	complex<double>* buf = new complex<double>[slots];
+	for (long k = first; k < last; ++k) {
+		copy(vals[k], vals[k] + slots, uvals);
+		plan.specialInv(uvals, 1.0 / slots, buf);
+		context.encodeTransformed(res[k].mx, uvals, slots, logp + context.logQ, logq + context.logQ);
+		res[k].logp = logp;
+		res[k].logq = logq;
+		res[k].slots = slots;
+		res[k].isComplex = true;
+	}
+	delete[] uvals;
+	delete[] buf;
+	NTL_EXEC_RANGE_END;
+}
 
-		rem(tmp, msg.mx[idx + context.Nh], q);
-		if(NumBits(tmp) == msg.logq) tmp -= q;
-		res[i].imag(EvaluatorUtils::scaleDownToReal(tmp, msg.logp));
+void Scheme::encodeBatch(Plaintext* res, double** vals, long count, long slots, long logp, long logq) {
+	const FftPlan& plan = context.getFftPlan(slots);
+	NTL_EXEC_RANGE(count, first, last);
+	complex<double>* uvals = new complex<double>[slots];
+	complex<double>* buf = new complex<double>[slots];
+	for (long k = first; k < last; ++k) {
+		for (long i = 0; i < slots; ++i) {
+			uvals[i] = complex<double>(vals[k][i], 0);
+		}
+		plan.specialInv(uvals, 1.0 / slots, buf);
+		context.encodeTransformed(res[k].mx, uvals, slots, logp + context.logQ, logq + context.logQ);
+		res[k].logp = logp;
+		res[k].logq = logq;
+		res[k].slots = slots;
+		res[k].isComplex = false;
 	}
-	context.fftSpecial(res, slots);
-	return res;
+	delete[] uvals;
+	delete[] buf;
+	NTL_EXEC_RANGE_END;
+}
+
+void Scheme::decodeBatch(complex<double>** res, Plaintext* msgs, long count) {
+	NTL_EXEC_RANGE(count, first, last);
+	complex<double>* buf = NULL;
+	long bufSize = 0;
+	for (long k = first; k < last; ++k) {
+		long slots = msgs[k].slots;
+		long gap = context.Nh / slots;
+		if(slots > bufSize) {
+			delete[] buf;
+			buf = new complex<double>[slots];
+			bufSize = slots;
+		}
+		EvaluatorUtils::scaleDownToReal((double*) res[k], 2, msgs[k].mx, 0, gap, slots, msgs[k].logq, msgs[k].logp);
+		EvaluatorUtils::scaleDownToReal((double*) res[k] + 1, 2, msgs[k].mx, context.Nh, gap, slots, msgs[k].logq, msgs[k].logp);
+		context.getFftPlan(slots).special(res[k], buf);
+	}
+	delete[] buf;
+	NTL_EXEC_RANGE_END;
 }
 
 Plaintext Scheme::encodeSingle(complex<double> val, long logp, long logq) {
@@ -176,26 +318,29 @@ Plaintext Scheme::encodeSingle(complex<double> val, long logp, long logq) {
 	mx.SetLength(context.N);
 	mx.rep[0] = EvaluatorUtils::scaleUpToZZ(val.real(), logp + context.logQ);
 	mx.rep[context.Nh] = EvaluatorUtils::scaleUpToZZ(val.imag(), logp + context.logQ);
-	return Plaintext(mx, logp, logq, 1, true);
+	return Plaintext(FlatPoly(mx, logq + context.logQ, context.N), logp, logq, 1, true);
 }
 
 Plaintext Scheme::encodeSingle(double val, long logp, long logq) {
 	ZZX mx;
 	mx.SetLength(context.N);
 	mx.rep[0] = EvaluatorUtils::scaleUpToZZ(val, logp + context.logQ);
-	return Plaintext(mx, logp, logq, 1, false);
+	return Plaintext(FlatPoly(mx, logq + context.logQ, context.N), logp, logq, 1, false);
 }
 
 complex<double> Scheme::decodeSingle(Plaintext& msg) {
 	ZZ q = context.qpowvec[msg.logq];
 
 	complex<double> res;
-	ZZ tmp = msg.mx.rep[0] % q;
+	ZZ tmp;
+	msg.mx.getCoeff(tmp, 0);
+	trunc(tmp, tmp, msg.logq);
 	if(NumBits(tmp) == msg.logq) tmp -= q;
 	res.real(EvaluatorUtils::scaleDownToReal(tmp, msg.logp));
 
 	if(msg.isComplex) {
-		tmp = msg.mx.rep[context.Nh] % q;
+		msg.mx.getCoeff(tmp, context.Nh);
+		trunc(tmp, tmp, msg.logq);
 		if(NumBits(tmp) == msg.logq) tmp -= q;
 		res.imag(EvaluatorUtils::scaleDownToReal(tmp, msg.logp));
 	}
@@ -210,33 +355,141 @@ complex<double> Scheme::decodeSingle(Plaintext& msg) {
 
 
 Ciphertext Scheme::encryptMsg(Plaintext& msg) {
-	ZZX ax, bx, vx, ex;
-	Key key = keyMap.at(ENCRYPTION);
-	ZZ qQ = context.qpowvec[msg.logq + context.logQ];
+	FlatPoly ax, bx;
+	long logqQ = msg.logq + context.logQ;
+
+	if(encPool != NULL && logqQ <= context.logQQ && encPool->pop(ax, bx)) {
+		Ring2Utils::modAndEqual(ax, logqQ, context.N);
+		Ring2Utils::modAndEqual(bx, logqQ, context.N);
+	} else {
+		encryptZero(ax, bx, logqQ);
+	}
+
+	Ring2Utils::addAndEqual(bx, msg.mx, logqQ, context.N);
+
+	Ring2Utils::rightShiftAndEqual(ax, context.logQ, msg.logq, context.N);
+	Ring2Utils::rightShiftAndEqual(bx, context.logQ, msg.logq, context.N);
+
+	return Ciphertext(ax, bx, msg.logp, msg.logq, msg.slots, msg.isComplex);
+}
+
+Ciphertext Scheme::encryptSymmetric(SecretKey& secretKey, Plaintext& msg) {
+	FlatPoly ax, bx, fx;
+	unsigned char seed[SEED_BYTES];
+
+	NumUtils::sampleSeed(seed);
+	NumUtils::sampleUniform2(ax, seed, context.N, msg.logq);
+	Ring2Utils::mult(bx, ax, secretKey.tx, msg.logq, context.N);
+	NumUtils::sampleGauss(fx, context.N, context.sigma, msg.logq);
+	Ring2Utils::sub(bx, fx, bx, msg.logq, context.N);
+	Ring2Utils::rightShift(fx, msg.mx, context.logQ, msg.logq, context.N);
+	Ring2Utils::addAndEqual(bx, fx, msg.logq, context.N);
+
+	Ciphertext cipher(ax, bx, msg.logp, msg.logq, msg.slots, msg.isComplex);
+	cipher.setSeed(seed);
+	return cipher;
+}
+
+void Scheme::encryptZero(FlatPoly& ax, FlatPoly& bx, long logqQ) {
+	ZZX vx;
+	FlatPoly fex;
+	Key& key = keyMap.at(ENCRYPTION);
 
 	NumUtils::sampleZO(vx, context.N);
-	Ring2Utils::mult(ax, vx, key.ax, qQ, context.N);
-	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::addAndEqual(ax, ex, qQ, context.N);
+	TernaryPoly tvx(vx);
+	RingMultiplier& multiplier = RingMultiplier::getInstance(context.N);
+	long np = multiplier.primesNeeded(min(logqQ, context.logQQ) + 1 + context.logN);
+	uint64_t* rv = new uint64_t[np << context.logN];
+	multiplier.CRT(rv, tvx, np);
+	multByKeyNTT(ax, bx, rv, np, key, logqQ, context.logQQ);
+	delete[] rv;
 
-	Ring2Utils::mult(bx, vx, key.bx, qQ, context.N);
-	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::addAndEqual(bx, ex, qQ, context.N);
+	NumUtils::sampleGauss(fex, context.N, context.sigma, logqQ);
+	Ring2Utils::addAndEqual(ax, fex, logqQ, context.N);
 
-	Ring2Utils::addAndEqual(bx, msg.mx, qQ, context.N);
+	NumUtils::sampleGauss(fex, context.N, context.sigma, logqQ);
+	Ring2Utils::addAndEqual(bx, fex, logqQ, context.N);
+}
 
-	Ring2Utils::rightShiftAndEqual(ax, context.logQ, context.N);
-	Ring2Utils::rightShiftAndEqual(bx, context.logQ, context.N);
+void Scheme::startEncryptionPool(long size, long threads) {
+	if(keyMap.find(ENCRYPTION) == keyMap.end()) {
+		throw std::invalid_argument("encryption key is needed for encryption pool");
+	}
+	stopEncryptionPool();
+	encPool = new EncryptionPool([this](FlatPoly& ax, FlatPoly& bx) { encryptZero(ax, bx, context.logQQ); }, size, threads);
+}
 
-	return Ciphertext(ax, bx, msg.logp, msg.logq, msg.slots, msg.isComplex);
+void Scheme::stopEncryptionPool() {
+	delete encPool;
+	encPool = NULL;
 }
 
-Plaintext Scheme::decryptMsg(SecretKey& secretKey, Ciphertext& cipher) {
-	ZZ q = context.qpowvec[cipher.logq];
+void Scheme::openRotationKeyStore(string path, long maxResident) {
+	closeRotationKeyStore();
+	rotKeyStore = new RotationKeyStore(path, [this](Key& key) { transformKey(key); }, maxResident);
+}
 
-	ZZX mx;
-	Ring2Utils::mult(mx, cipher.ax, secretKey.sx, q, context.N);
-	Ring2Utils::addAndEqual(mx, cipher.bx, q, context.N);
+void Scheme::closeRotationKeyStore() {
+	delete rotKeyStore;
+	rotKeyStore = NULL;
+}
+
+shared_ptr<Key> Scheme::getLeftRotKey(long rot) {
+	auto it = leftRotKeyMap.find(rot);
+	if(it == leftRotKeyMap.end() && rotKeyStore != NULL && rotKeyStore->contains(rot)) {
+		return rotKeyStore->get(rot);
+	}
+	// non-owning pointer, keys in leftRotKeyMap live as long as the scheme
+	return shared_ptr<Key>(shared_ptr<Key>(), &leftRotKeyMap.at(rot));
+}
+
+bool Scheme::hasLeftRotKey(long rot) {
+	return leftRotKeyMap.find(rot) != leftRotKeyMap.end() || (rotKeyStore != NULL && rotKeyStore->contains(rot));
+}
+
+vector<long> Scheme::rotationPath(long rot, long slots) {
+	vector<long> res;
+	long left = (rot + slots) % slots;
+	if(left == 0) return res;
+	if(hasLeftRotKey(left)) {
+		res.push_back(left);
+		return res;
+	}
+	if(rotPlan != NULL && rotPlan->cost(left, slots) >= 0) {
+		res = rotPlan->path(left, slots);
+	}
+
+	// non-adjacent form of left, digit -1 at 2^i is right rotation by 2^i,
+	// digits at 2^i >= slots vanish mod slots
+	vector<long> naf;
+	bool isAvailable = true;
+	for (long r = left, i = 1; r != 0 && i < slots; r >>= 1, i <<= 1) {
+		if(r & 1) {
+			long digit = 2 - (r & 3);
+			long key = digit > 0 ? i : context.Nh - i;
+			isAvailable &= hasLeftRotKey(key);
+			naf.push_back(key);
+			r -= digit;
+		}
+	}
+	if(isAvailable && (res.empty() || naf.size() < res.size())) {
+		return naf;
+	}
+	if(!res.empty()) return res;
+
+	long amount = rot > 0 ? left : slots - left;
+	for (long i = 1; i <= amount; i <<= 1) {
+		if(amount & i) {
+			res.push_back(rot > 0 ? i : context.Nh - i);
+		}
+	}
+	return res;
+}
+
+Plaintext Scheme::decryptMsg(SecretKey& secretKey, Ciphertext& cipher) {
+	FlatPoly mx;
+	Ring2Utils::mult(mx, cipher.ax, secretKey.tx, cipher.logq, context.N);
+	Ring2Utils::addAndEqual(mx, cipher.bx, cipher.logq, context.N);
 
 	return Plaintext(mx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
@@ -284,288 +537,253 @@ complex<double> Scheme::decryptSingle(SecretKey& secretKey, Ciphertext& cipher)
 
 
 Ciphertext Scheme::negate(Ciphertext& cipher) {
-	return Ciphertext(-cipher.ax, -cipher.bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
+	FlatPoly ax, bx;
+	Ring2Utils::negate(ax, cipher.ax, cipher.logq, context.N);
+	Ring2Utils::negate(bx, cipher.bx, cipher.logq, context.N);
+	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::negateAndEqual(Ciphertext& cipher) {
-	cipher.ax = -cipher.ax;
-	cipher.bx = -cipher.bx;
+	Ring2Utils::negateAndEqual(cipher.ax, cipher.logq, context.N);
+	Ring2Utils::negateAndEqual(cipher.bx, cipher.logq, context.N);
 }
 
 Ciphertext Scheme::add(Ciphertext& cipher1, Ciphertext& cipher2) {
-	ZZ q = context.qpowvec[cipher1.logq];
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
-	Ring2Utils::add(ax, cipher1.ax, cipher2.ax, q, context.N);
-	Ring2Utils::add(bx, cipher1.bx, cipher2.bx, q, context.N);
+	Ring2Utils::add(ax, cipher1.ax, cipher2.ax, cipher1.logq, context.N);
+	Ring2Utils::add(bx, cipher1.bx, cipher2.bx, cipher1.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher1.logp, cipher1.logq, cipher1.slots, cipher1.isComplex);
 }
 
 void Scheme::addAndEqual(Ciphertext& cipher1, Ciphertext& cipher2) {
-	ZZ q = context.qpowvec[cipher1.logq];
 
-	Ring2Utils::addAndEqual(cipher1.ax, cipher2.ax, q, context.N);
-	Ring2Utils::addAndEqual(cipher1.bx, cipher2.bx, q, context.N);
+	Ring2Utils::addAndEqual(cipher1.ax, cipher2.ax, cipher1.logq, context.N);
+	Ring2Utils::addAndEqual(cipher1.bx, cipher2.bx, cipher1.logq, context.N);
 }
 
 Ciphertext Scheme::addConst(Ciphertext& cipher, double cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
 
-	ZZX ax = cipher.ax;
-	ZZX bx = cipher.bx;
+	FlatPoly ax = cipher.ax;
+	FlatPoly bx = cipher.bx;
 
 	ZZ cnstZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst, cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst, logp);
 
-	AddMod(bx.rep[0], cipher.bx.rep[0], cnstZZ, q);
+	Ring2Utils::addConstAndEqual(bx, 0, cnstZZ, cipher.logq);
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 Ciphertext Scheme::addConst(Ciphertext& cipher, RR& cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
 
-	ZZX ax = cipher.ax;
-	ZZX bx = cipher.bx;
+	FlatPoly ax = cipher.ax;
+	FlatPoly bx = cipher.bx;
 
 	ZZ cnstZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst, cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst, logp);
 
-	AddMod(bx.rep[0], cipher.bx.rep[0], cnstZZ, q);
+	Ring2Utils::addConstAndEqual(bx, 0, cnstZZ, cipher.logq);
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 Ciphertext Scheme::addConst(Ciphertext& cipher, complex<double> cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZX ax = cipher.ax;
-	ZZX bx = cipher.bx;
+	FlatPoly ax = cipher.ax;
+	FlatPoly bx = cipher.bx;
 
 	ZZ cnstrZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst.real(), cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst.real(), logp);
 	ZZ cnstiZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst.imag(), cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst.imag(), logp);
 
-	AddMod(bx.rep[0], cipher.bx.rep[0], cnstrZZ, q);
-	AddMod(bx.rep[context.Nh], cipher.bx.rep[context.Nh], cnstiZZ, q);
+	Ring2Utils::addConstAndEqual(bx, 0, cnstrZZ, cipher.logq);
+	Ring2Utils::addConstAndEqual(bx, context.Nh, cnstiZZ, cipher.logq);
 
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::addConstAndEqual(Ciphertext& cipher, double cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
 	ZZ cnstZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst, cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst, logp);
-	AddMod(cipher.bx.rep[0], cipher.bx.rep[0], cnstZZ, q);
+	Ring2Utils::addConstAndEqual(cipher.bx, 0, cnstZZ, cipher.logq);
 }
 
 void Scheme::addConstAndEqual(Ciphertext& cipher, RR& cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
 	ZZ cnstZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst, cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst, logp);
-	AddMod(cipher.bx.rep[0], cipher.bx.rep[0], cnstZZ, q);
+	Ring2Utils::addConstAndEqual(cipher.bx, 0, cnstZZ, cipher.logq);
 }
 
 void Scheme::addConstAndEqual(Ciphertext& cipher, complex<double> cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
 
 	ZZ cnstrZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst.real(), cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst.real(), logp);
 	ZZ cnstiZZ = logp < 0 ? EvaluatorUtils::scaleUpToZZ(cnst.imag(), cipher.logp) : EvaluatorUtils::scaleUpToZZ(cnst.imag(), logp);
 
-	AddMod(cipher.bx.rep[0], cipher.bx.rep[0], cnstrZZ, q);
-	AddMod(cipher.bx.rep[context.Nh], cipher.bx.rep[context.Nh], cnstiZZ, q);
+	Ring2Utils::addConstAndEqual(cipher.bx, 0, cnstrZZ, cipher.logq);
+	Ring2Utils::addConstAndEqual(cipher.bx, context.Nh, cnstiZZ, cipher.logq);
 }
 
 //-----------------------------------------
 
 Ciphertext Scheme::sub(Ciphertext& cipher1, Ciphertext& cipher2) {
-	ZZ q = context.qpowvec[cipher1.logq];
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
-	Ring2Utils::sub(ax, cipher1.ax, cipher2.ax, q, context.N);
-	Ring2Utils::sub(bx, cipher1.bx, cipher2.bx, q, context.N);
+	Ring2Utils::sub(ax, cipher1.ax, cipher2.ax, cipher1.logq, context.N);
+	Ring2Utils::sub(bx, cipher1.bx, cipher2.bx, cipher1.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher1.logp, cipher1.logq, cipher1.slots, cipher1.isComplex);
 }
 
 void Scheme::subAndEqual(Ciphertext& cipher1, Ciphertext& cipher2) {
-	ZZ q = context.qpowvec[cipher1.logq];
 
-	Ring2Utils::subAndEqual(cipher1.ax, cipher2.ax, q, context.N);
-	Ring2Utils::subAndEqual(cipher1.bx, cipher2.bx, q, context.N);
+	Ring2Utils::subAndEqual(cipher1.ax, cipher2.ax, cipher1.logq, context.N);
+	Ring2Utils::subAndEqual(cipher1.bx, cipher2.bx, cipher1.logq, context.N);
 }
 
 void Scheme::subAndEqual2(Ciphertext& cipher1, Ciphertext& cipher2) {
-	ZZ q = context.qpowvec[cipher1.logq];
 
-	Ring2Utils::subAndEqual2(cipher1.ax, cipher2.ax, q, context.N);
-	Ring2Utils::subAndEqual2(cipher1.bx, cipher2.bx, q, context.N);
+	Ring2Utils::subAndEqual2(cipher1.ax, cipher2.ax, cipher1.logq, context.N);
+	Ring2Utils::subAndEqual2(cipher1.bx, cipher2.bx, cipher1.logq, context.N);
 }
 
 Ciphertext Scheme::imult(Ciphertext& cipher) {
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
-	Ring2Utils::multByMonomial(ax, cipher.ax, context.Nh, context.N);
-	Ring2Utils::multByMonomial(bx, cipher.bx, context.Nh, context.N);
+	Ring2Utils::multByMonomial(ax, cipher.ax, context.Nh, cipher.logq, context.N);
+	Ring2Utils::multByMonomial(bx, cipher.bx, context.Nh, cipher.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 Ciphertext Scheme::idiv(Ciphertext& cipher) {
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
-	Ring2Utils::multByMonomial(ax, cipher.ax, 3 * context.Nh, context.N);
-	Ring2Utils::multByMonomial(bx, cipher.bx, 3 * context.Nh, context.N);
+	Ring2Utils::multByMonomial(ax, cipher.ax, 3 * context.Nh, cipher.logq, context.N);
+	Ring2Utils::multByMonomial(bx, cipher.bx, 3 * context.Nh, cipher.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::imultAndEqual(Ciphertext& cipher) {
-	Ring2Utils::multByMonomialAndEqual(cipher.ax, context.Nh, context.N);
-	Ring2Utils::multByMonomialAndEqual(cipher.bx, context.Nh, context.N);
+	Ring2Utils::multByMonomialAndEqual(cipher.ax, context.Nh, cipher.logq, context.N);
+	Ring2Utils::multByMonomialAndEqual(cipher.bx, context.Nh, cipher.logq, context.N);
 }
 
 void Scheme::idivAndEqual(Ciphertext& cipher) {
-	Ring2Utils::multByMonomialAndEqual(cipher.ax, 3 * context.Nh, context.N);
-	Ring2Utils::multByMonomialAndEqual(cipher.bx, 3 * context.Nh, context.N);
+	Ring2Utils::multByMonomialAndEqual(cipher.ax, 3 * context.Nh, cipher.logq, context.N);
+	Ring2Utils::multByMonomialAndEqual(cipher.bx, 3 * context.Nh, cipher.logq, context.N);
 }
 
 Ciphertext Scheme::mult(Ciphertext& cipher1, Ciphertext& cipher2) {
-	ZZ q = context.qpowvec[cipher1.logq];
-	ZZ qQ = context.qpowvec[cipher1.logq + context.logQ];
-
-	ZZX axbx1, axbx2, axax, bxbx, axmult, bxmult;
-	Key key = keyMap.at(MULTIPLICATION);
 
-	Ring2Utils::add(axbx1, cipher1.ax, cipher1.bx, q, context.N);
-	Ring2Utils::add(axbx2, cipher2.ax, cipher2.bx, q, context.N);
-	Ring2Utils::multAndEqual(axbx1, axbx2, q, context.N);
+	FlatPoly axbx1, axbx2, axax, bxbx, axmult, bxmult;
+	Key& key = keyMap.at(MULTIPLICATION);
 
-	Ring2Utils::mult(axax, cipher1.ax, cipher2.ax, q, context.N);
-	Ring2Utils::mult(bxbx, cipher1.bx, cipher2.bx, q, context.N);
+	Ring2Utils::add(axbx1, cipher1.ax, cipher1.bx, cipher1.logq, context.N);
+	Ring2Utils::add(axbx2, cipher2.ax, cipher2.bx, cipher1.logq, context.N);
+	Ring2Utils::multAndEqual(axbx1, axbx2, cipher1.logq, context.N);
 
-	Ring2Utils::mult(axmult, axax, key.ax, qQ, context.N);
-	Ring2Utils::mult(bxmult, axax, key.bx, qQ, context.N);
+	Ring2Utils::mult(axax, cipher1.ax, cipher2.ax, cipher1.logq, context.N);
+	Ring2Utils::mult(bxbx, cipher1.bx, cipher2.bx, cipher1.logq, context.N);
 
-	Ring2Utils::rightShiftAndEqual(axmult, context.logQ, context.N);
-	Ring2Utils::rightShiftAndEqual(bxmult, context.logQ, context.N);
+	keySwitch(axmult, bxmult, axax, key, cipher1.logq);
 
-	Ring2Utils::addAndEqual(axmult, axbx1, q, context.N);
-	Ring2Utils::subAndEqual(axmult, bxbx, q, context.N);
-	Ring2Utils::subAndEqual(axmult, axax, q, context.N);
-	Ring2Utils::addAndEqual(bxmult, bxbx, q, context.N);
+	Ring2Utils::addAndEqual(axmult, axbx1, cipher1.logq, context.N);
+	Ring2Utils::subAndEqual(axmult, bxbx, cipher1.logq, context.N);
+	Ring2Utils::subAndEqual(axmult, axax, cipher1.logq, context.N);
+	Ring2Utils::addAndEqual(bxmult, bxbx, cipher1.logq, context.N);
 
 	return Ciphertext(axmult, bxmult, cipher1.logp + cipher2.logp, cipher1.logq, cipher1.slots, cipher1.isComplex);
 }
 
 void Scheme::multAndEqual(Ciphertext& cipher1, Ciphertext& cipher2) {
-	ZZ q = context.qpowvec[cipher1.logq];
-	ZZ qQ = context.qpowvec[cipher1.logq + context.logQ];
-	ZZX axbx1, axbx2, axax, bxbx;
-	Key key = keyMap.at(MULTIPLICATION);
-
-	Ring2Utils::add(axbx1, cipher1.ax, cipher1.bx, q, context.N);
-	Ring2Utils::add(axbx2, cipher2.ax, cipher2.bx, q, context.N);
-	Ring2Utils::multAndEqual(axbx1, axbx2, q, context.N);
+	FlatPoly axbx1, axbx2, axax, bxbx;
+	Key& key = keyMap.at(MULTIPLICATION);
 
-	Ring2Utils::mult(axax, cipher1.ax, cipher2.ax, q, context.N);
-	Ring2Utils::mult(bxbx, cipher1.bx, cipher2.bx, q, context.N);
+	Ring2Utils::add(axbx1, cipher1.ax, cipher1.bx, cipher1.logq, context.N);
+	Ring2Utils::add(axbx2, cipher2.ax, cipher2.bx, cipher1.logq, context.N);
+	Ring2Utils::multAndEqual(axbx1, axbx2, cipher1.logq, context.N);
 
-	Ring2Utils::mult(cipher1.ax, axax, key.ax, qQ, context.N);
-	Ring2Utils::mult(cipher1.bx, axax, key.bx, qQ, context.N);
+	Ring2Utils::mult(axax, cipher1.ax, cipher2.ax, cipher1.logq, context.N);
+	Ring2Utils::mult(bxbx, cipher1.bx, cipher2.bx, cipher1.logq, context.N);
 
-	Ring2Utils::rightShiftAndEqual(cipher1.ax, context.logQ, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher1.bx, context.logQ, context.N);
+	keySwitch(cipher1.ax, cipher1.bx, axax, key, cipher1.logq);
 
-	Ring2Utils::addAndEqual(cipher1.ax, axbx1, q, context.N);
-	Ring2Utils::subAndEqual(cipher1.ax, bxbx, q, context.N);
-	Ring2Utils::subAndEqual(cipher1.ax, axax, q, context.N);
-	Ring2Utils::addAndEqual(cipher1.bx, bxbx, q, context.N);
+	Ring2Utils::addAndEqual(cipher1.ax, axbx1, cipher1.logq, context.N);
+	Ring2Utils::subAndEqual(cipher1.ax, bxbx, cipher1.logq, context.N);
+	Ring2Utils::subAndEqual(cipher1.ax, axax, cipher1.logq, context.N);
+	Ring2Utils::addAndEqual(cipher1.bx, bxbx, cipher1.logq, context.N);
 
 	cipher1.logp += cipher2.logp;
 }
 
 Ciphertext Scheme::square(Ciphertext& cipher) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZ qQ = context.qpowvec[cipher.logq + context.logQ];
-	ZZX axax, axbx, bxbx, bxmult, axmult;
-	Key key = keyMap.at(MULTIPLICATION);
+	FlatPoly axax, axbx, bxbx, bxmult, axmult;
+	Key& key = keyMap.at(MULTIPLICATION);
 
-	Ring2Utils::square(bxbx, cipher.bx, q, context.N);
-	Ring2Utils::mult(axbx, cipher.ax, cipher.bx, q, context.N);
-	Ring2Utils::addAndEqual(axbx, axbx, q, context.N);
-	Ring2Utils::square(axax, cipher.ax, q, context.N);
+	Ring2Utils::square(bxbx, cipher.bx, cipher.logq, context.N);
+	Ring2Utils::mult(axbx, cipher.ax, cipher.bx, cipher.logq, context.N);
+	Ring2Utils::addAndEqual(axbx, axbx, cipher.logq, context.N);
+	Ring2Utils::square(axax, cipher.ax, cipher.logq, context.N);
 
-	Ring2Utils::mult(axmult, axax, key.ax, qQ, context.N);
-	Ring2Utils::mult(bxmult, axax, key.bx, qQ, context.N);
+	keySwitch(axmult, bxmult, axax, key, cipher.logq);
 
-	Ring2Utils::rightShiftAndEqual(axmult, context.logQ, context.N);
-	Ring2Utils::rightShiftAndEqual(bxmult, context.logQ, context.N);
-
-	Ring2Utils::addAndEqual(axmult, axbx, q, context.N);
-	Ring2Utils::addAndEqual(bxmult, bxbx, q, context.N);
+	Ring2Utils::addAndEqual(axmult, axbx, cipher.logq, context.N);
+	Ring2Utils::addAndEqual(bxmult, bxbx, cipher.logq, context.N);
 
 	return Ciphertext(axmult, bxmult, cipher.logp * 2, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::squareAndEqual(Ciphertext& cipher) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZ qQ = context.qpowvec[cipher.logq + context.logQ];
-	ZZX bxbx, axbx, axax;
-	Key key = keyMap.at(MULTIPLICATION);
-
-	Ring2Utils::square(bxbx, cipher.bx, q, context.N);
-	Ring2Utils::mult(axbx, cipher.bx, cipher.ax, q, context.N);
-	Ring2Utils::addAndEqual(axbx, axbx, q, context.N);
-	Ring2Utils::square(axax, cipher.ax, q, context.N);
+	FlatPoly bxbx, axbx, axax;
+	Key& key = keyMap.at(MULTIPLICATION);
 
-	Ring2Utils::mult(cipher.ax, axax, key.ax, qQ, context.N);
-	Ring2Utils::mult(cipher.bx, axax, key.bx, qQ, context.N);
+	Ring2Utils::square(bxbx, cipher.bx, cipher.logq, context.N);
+	Ring2Utils::mult(axbx, cipher.bx, cipher.ax, cipher.logq, context.N);
+	Ring2Utils::addAndEqual(axbx, axbx, cipher.logq, context.N);
+	Ring2Utils::square(axax, cipher.ax, cipher.logq, context.N);
 
-	Ring2Utils::rightShiftAndEqual(cipher.ax, context.logQ, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher.bx, context.logQ, context.N);
+	keySwitch(cipher.ax, cipher.bx, axax, key, cipher.logq);
 
-	Ring2Utils::addAndEqual(cipher.ax, axbx, q, context.N);
-	Ring2Utils::addAndEqual(cipher.bx, bxbx, q, context.N);
+	Ring2Utils::addAndEqual(cipher.ax, axbx, cipher.logq, context.N);
+	Ring2Utils::addAndEqual(cipher.bx, bxbx, cipher.logq, context.N);
 	cipher.logp *= 2;
 }
 
 Ciphertext Scheme::multByConst(Ciphertext& cipher, double cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
 	ZZ cnstZZ = EvaluatorUtils::scaleUpToZZ(cnst, logp);
 
-	Ring2Utils::multByConst(ax, cipher.ax, cnstZZ, q, context.N);
-	Ring2Utils::multByConst(bx, cipher.bx, cnstZZ, q, context.N);
+	Ring2Utils::multByConst(ax, cipher.ax, cnstZZ, cipher.logq, context.N);
+	Ring2Utils::multByConst(bx, cipher.bx, cnstZZ, cipher.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp + logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 Ciphertext Scheme::multByConst(Ciphertext& cipher, RR& cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
 	ZZ cnstZZ = EvaluatorUtils::scaleUpToZZ(cnst, logp);
 
-	Ring2Utils::multByConst(ax, cipher.ax, cnstZZ, q, context.N);
-	Ring2Utils::multByConst(bx, cipher.bx, cnstZZ, q, context.N);
+	Ring2Utils::multByConst(ax, cipher.ax, cnstZZ, cipher.logq, context.N);
+	Ring2Utils::multByConst(bx, cipher.bx, cnstZZ, cipher.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp + logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 Ciphertext Scheme::multByConst(Ciphertext& cipher, complex<double> cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
 
-	ZZX axr, bxr, axi, bxi;
+	FlatPoly axr, bxr, axi, bxi;
 
 	ZZ cnstrZZ = EvaluatorUtils::scaleUpToZZ(cnst.real(), logp);
 	ZZ cnstiZZ = EvaluatorUtils::scaleUpToZZ(cnst.imag(), logp);
 
-	Ring2Utils::multByMonomial(axi, cipher.ax, context.Nh, context.N);
-	Ring2Utils::multByMonomial(bxi, cipher.bx, context.Nh, context.N);
+	Ring2Utils::multByMonomial(axi, cipher.ax, context.Nh, cipher.logq, context.N);
+	Ring2Utils::multByMonomial(bxi, cipher.bx, context.Nh, cipher.logq, context.N);
 
-	Ring2Utils::multByConst(axr, cipher.ax, cnstrZZ, q, context.N);
-	Ring2Utils::multByConst(bxr, cipher.bx, cnstrZZ, q, context.N);
+	Ring2Utils::multByConst(axr, cipher.ax, cnstrZZ, cipher.logq, context.N);
+	Ring2Utils::multByConst(bxr, cipher.bx, cnstrZZ, cipher.logq, context.N);
 
-	Ring2Utils::multByConstAndEqual(axi, cnstiZZ, q, context.N);
-	Ring2Utils::multByConstAndEqual(bxi, cnstiZZ, q, context.N);
+	Ring2Utils::multByConstAndEqual(axi, cnstiZZ, cipher.logq, context.N);
+	Ring2Utils::multByConstAndEqual(bxi, cnstiZZ, cipher.logq, context.N);
 
-	Ring2Utils::addAndEqual(axr, axi, q, context.N);
-	Ring2Utils::addAndEqual(bxr, bxi, q, context.N);
+	Ring2Utils::addAndEqual(axr, axi, cipher.logq, context.N);
+	Ring2Utils::addAndEqual(bxr, bxi, cipher.logq, context.N);
 
 	return Ciphertext(axr, bxr, cipher.logp + logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
@@ -581,41 +799,38 @@ Ciphertext Scheme::multByConstVec(Ciphertext& cipher, double* cnstVec, long slot
 }
 
 void Scheme::multByConstAndEqual(Ciphertext& cipher, double cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
 	ZZ cnstZZ = EvaluatorUtils::scaleUpToZZ(cnst, logp);
 
-	Ring2Utils::multByConstAndEqual(cipher.ax, cnstZZ, q, context.N);
-	Ring2Utils::multByConstAndEqual(cipher.bx, cnstZZ, q, context.N);
+	Ring2Utils::multByConstAndEqual(cipher.ax, cnstZZ, cipher.logq, context.N);
+	Ring2Utils::multByConstAndEqual(cipher.bx, cnstZZ, cipher.logq, context.N);
 	cipher.logp += logp;
 }
 
 void Scheme::multByConstAndEqual(Ciphertext& cipher, RR& cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
 	ZZ cnstZZ = EvaluatorUtils::scaleUpToZZ(cnst, logp);
 
-	Ring2Utils::multByConstAndEqual(cipher.ax, cnstZZ, q, context.N);
-	Ring2Utils::multByConstAndEqual(cipher.bx, cnstZZ, q, context.N);
+	Ring2Utils::multByConstAndEqual(cipher.ax, cnstZZ, cipher.logq, context.N);
+	Ring2Utils::multByConstAndEqual(cipher.bx, cnstZZ, cipher.logq, context.N);
 	cipher.logp += logp;
 }
 
 void Scheme::multByConstAndEqual(Ciphertext& cipher, complex<double> cnst, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZX axi, bxi;
+	FlatPoly axi, bxi;
 
 	ZZ cnstrZZ = EvaluatorUtils::scaleUpToZZ(cnst.real(), logp);
 	ZZ cnstiZZ = EvaluatorUtils::scaleUpToZZ(cnst.imag(), logp);
 
-	Ring2Utils::multByMonomial(axi, cipher.ax, context.Nh, context.N);
-	Ring2Utils::multByMonomial(bxi, cipher.bx, context.Nh, context.N);
+	Ring2Utils::multByMonomial(axi, cipher.ax, context.Nh, cipher.logq, context.N);
+	Ring2Utils::multByMonomial(bxi, cipher.bx, context.Nh, cipher.logq, context.N);
 
-	Ring2Utils::multByConstAndEqual(cipher.ax, cnstrZZ, q, context.N);
-	Ring2Utils::multByConstAndEqual(cipher.bx, cnstrZZ, q, context.N);
+	Ring2Utils::multByConstAndEqual(cipher.ax, cnstrZZ, cipher.logq, context.N);
+	Ring2Utils::multByConstAndEqual(cipher.bx, cnstrZZ, cipher.logq, context.N);
 
-	Ring2Utils::multByConstAndEqual(axi, cnstiZZ, q, context.N);
-	Ring2Utils::multByConstAndEqual(bxi, cnstiZZ, q, context.N);
+	Ring2Utils::multByConstAndEqual(axi, cnstiZZ, cipher.logq, context.N);
+	Ring2Utils::multByConstAndEqual(bxi, cnstiZZ, cipher.logq, context.N);
 
-	Ring2Utils::addAndEqual(cipher.ax, axi, q, context.N);
-	Ring2Utils::addAndEqual(cipher.bx, bxi, q, context.N);
+	Ring2Utils::addAndEqual(cipher.ax, axi, cipher.logq, context.N);
+	Ring2Utils::addAndEqual(cipher.bx, bxi, cipher.logq, context.N);
 	cipher.logp += logp;
 }
 
@@ -630,74 +845,98 @@ void Scheme::multByConstVecAndEqual(Ciphertext& cipher, double* cnstVec, long sl
 }
 
 Ciphertext Scheme::multByPoly(Ciphertext& cipher, ZZX& poly, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
-	Ring2Utils::mult(ax, cipher.ax, poly, q, context.N);
-	Ring2Utils::mult(bx, cipher.bx, poly, q, context.N);
+	Ring2Utils::mult(ax, cipher.ax, poly, cipher.logq, context.N);
+	Ring2Utils::mult(bx, cipher.bx, poly, cipher.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp + logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::multByPolyAndEqual(Ciphertext& cipher, ZZX& poly, long logp) {
-	ZZ q = context.qpowvec[cipher.logq];
 
-	Ring2Utils::multAndEqual(cipher.ax, poly, q, context.N);
-	Ring2Utils::multAndEqual(cipher.bx, poly, q, context.N);
+	Ring2Utils::multAndEqual(cipher.ax, poly, cipher.logq, context.N);
+	Ring2Utils::multAndEqual(cipher.bx, poly, cipher.logq, context.N);
+	cipher.logp += logp;
+}
+
+Ciphertext Scheme::multByPoly(Ciphertext& cipher, FlatPoly& poly, long logp) {
+	FlatPoly ax, bx;
+
+	Ring2Utils::mult(ax, cipher.ax, poly, cipher.logq, context.N);
+	Ring2Utils::mult(bx, cipher.bx, poly, cipher.logq, context.N);
+
+	return Ciphertext(ax, bx, cipher.logp + logp, cipher.logq, cipher.slots, cipher.isComplex);
+}
+
+void Scheme::multByPolyAndEqual(Ciphertext& cipher, FlatPoly& poly, long logp) {
+
+	Ring2Utils::multAndEqual(cipher.ax, poly, cipher.logq, context.N);
+	Ring2Utils::multAndEqual(cipher.bx, poly, cipher.logq, context.N);
+	cipher.logp += logp;
+}
+
+Ciphertext Scheme::multByPoly(Ciphertext& cipher, SmallPoly& poly, long logp) {
+	FlatPoly ax, bx;
+
+	multBySmallPoly(ax, bx, cipher, poly);
+
+	return Ciphertext(ax, bx, cipher.logp + logp, cipher.logq, cipher.slots, cipher.isComplex);
+}
+
+void Scheme::multByPolyAndEqual(Ciphertext& cipher, SmallPoly& poly, long logp) {
+	multBySmallPoly(cipher.ax, cipher.bx, cipher, poly);
 	cipher.logp += logp;
 }
 
 Ciphertext Scheme::multByMonomial(Ciphertext& cipher, const long degree) {
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
-	Ring2Utils::multByMonomial(ax, cipher.ax, degree, context.N);
-	Ring2Utils::multByMonomial(bx, cipher.bx, degree, context.N);
+	Ring2Utils::multByMonomial(ax, cipher.ax, degree, cipher.logq, context.N);
+	Ring2Utils::multByMonomial(bx, cipher.bx, degree, cipher.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::multByMonomialAndEqual(Ciphertext& cipher, const long degree) {
-	Ring2Utils::multByMonomialAndEqual(cipher.ax, degree, context.N);
-	Ring2Utils::multByMonomialAndEqual(cipher.bx, degree, context.N);
+	Ring2Utils::multByMonomialAndEqual(cipher.ax, degree, cipher.logq, context.N);
+	Ring2Utils::multByMonomialAndEqual(cipher.bx, degree, cipher.logq, context.N);
 }
 
 Ciphertext Scheme::multByPo2(Ciphertext& cipher, long deg) {
-	ZZ q = context.qpowvec[cipher.logq];
 
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
-	Ring2Utils::leftShift(ax, cipher.ax, deg, q, context.N);
-	Ring2Utils::leftShift(bx, cipher.bx, deg, q, context.N);
+	Ring2Utils::leftShift(ax, cipher.ax, deg, cipher.logq, context.N);
+	Ring2Utils::leftShift(bx, cipher.bx, deg, cipher.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::multByPo2AndEqual(Ciphertext& cipher, long deg) {
-	ZZ q = context.qpowvec[cipher.logq];
 
-	Ring2Utils::leftShiftAndEqual(cipher.ax, deg, q, context.N);
-	Ring2Utils::leftShiftAndEqual(cipher.bx, deg, q, context.N);
+	Ring2Utils::leftShiftAndEqual(cipher.ax, deg, cipher.logq, context.N);
+	Ring2Utils::leftShiftAndEqual(cipher.bx, deg, cipher.logq, context.N);
 }
 
 void Scheme::multBy2AndEqual(Ciphertext& cipher) {
-	ZZ q = context.qpowvec[cipher.logq];
 
-	Ring2Utils::doubleAndEqual(cipher.ax, q, context.N);
-	Ring2Utils::doubleAndEqual(cipher.bx, q, context.N);
+	Ring2Utils::doubleAndEqual(cipher.ax, cipher.logq, context.N);
+	Ring2Utils::doubleAndEqual(cipher.bx, cipher.logq, context.N);
 }
 
 Ciphertext Scheme::divByPo2(Ciphertext& cipher, long degree) {
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
-	Ring2Utils::rightShift(ax, cipher.ax, degree, context.N);
-	Ring2Utils::rightShift(bx, cipher.bx, degree, context.N);
+	Ring2Utils::rightShift(ax, cipher.ax, degree, cipher.logq - degree, context.N);
+	Ring2Utils::rightShift(bx, cipher.bx, degree, cipher.logq - degree, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq - degree, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::divByPo2AndEqual(Ciphertext& cipher, long degree) {
-	Ring2Utils::rightShiftAndEqual(cipher.ax, degree, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher.bx, degree, context.N);
+	Ring2Utils::rightShiftAndEqual(cipher.ax, degree, cipher.logq - degree, context.N);
+	Ring2Utils::rightShiftAndEqual(cipher.bx, degree, cipher.logq - degree, context.N);
 
 	cipher.logq -= degree;
 }
@@ -709,27 +948,27 @@ void Scheme::divByPo2AndEqual(Ciphertext& cipher, long degree) {
 
 
 Ciphertext Scheme::reScaleBy(Ciphertext& cipher, long bitsDown) {
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 
-	Ring2Utils::rightShift(ax, cipher.ax, bitsDown, context.N);
-	Ring2Utils::rightShift(bx, cipher.bx, bitsDown, context.N);
+	Ring2Utils::rightShift(ax, cipher.ax, bitsDown, cipher.logq - bitsDown, context.N);
+	Ring2Utils::rightShift(bx, cipher.bx, bitsDown, cipher.logq - bitsDown, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp - bitsDown, cipher.logq - bitsDown, cipher.slots, cipher.isComplex);
 }
 
 Ciphertext Scheme::reScaleTo(Ciphertext& cipher, long newlogq) {
-	ZZX ax, bx;
+	FlatPoly ax, bx;
 	long bitsDown = cipher.logq - newlogq;
 
-	Ring2Utils::rightShift(ax, cipher.ax, bitsDown, context.N);
-	Ring2Utils::rightShift(bx, cipher.bx, bitsDown, context.N);
+	Ring2Utils::rightShift(ax, cipher.ax, bitsDown, cipher.logq - bitsDown, context.N);
+	Ring2Utils::rightShift(bx, cipher.bx, bitsDown, cipher.logq - bitsDown, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp - bitsDown, newlogq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::reScaleByAndEqual(Ciphertext& cipher, long bitsDown) {
-	Ring2Utils::rightShiftAndEqual(cipher.ax, bitsDown, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher.bx, bitsDown, context.N);
+	Ring2Utils::rightShiftAndEqual(cipher.ax, bitsDown, cipher.logq - bitsDown, context.N);
+	Ring2Utils::rightShiftAndEqual(cipher.bx, bitsDown, cipher.logq - bitsDown, context.N);
 
 	cipher.logq -= bitsDown;
 	cipher.logp -= bitsDown;
@@ -740,44 +979,40 @@ void Scheme::reScaleToAndEqual(Ciphertext& cipher, long logq) {
 	cipher.logq = logq;
 	cipher.logp -= bitsDown;
 
-	Ring2Utils::rightShiftAndEqual(cipher.ax, bitsDown, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher.bx, bitsDown, context.N);
+	Ring2Utils::rightShiftAndEqual(cipher.ax, bitsDown, logq, context.N);
+	Ring2Utils::rightShiftAndEqual(cipher.bx, bitsDown, logq, context.N);
 }
 
 Ciphertext Scheme::modDownBy(Ciphertext& cipher, long bitsDown) {
-	ZZX bx, ax;
+	FlatPoly bx, ax;
 	long newlogq = cipher.logq - bitsDown;
-	ZZ q = context.qpowvec[newlogq];
 
-	Ring2Utils::mod(ax, cipher.ax, q, context.N);
-	Ring2Utils::mod(bx, cipher.bx, q, context.N);
+	Ring2Utils::mod(ax, cipher.ax, newlogq, context.N);
+	Ring2Utils::mod(bx, cipher.bx, newlogq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp, newlogq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::modDownByAndEqual(Ciphertext& cipher, long bitsDown) {
 	cipher.logq -= bitsDown;
-	ZZ q = context.qpowvec[cipher.logq];
 
-	Ring2Utils::modAndEqual(cipher.ax, q, context.N);
-	Ring2Utils::modAndEqual(cipher.bx, q, context.N);
+	Ring2Utils::modAndEqual(cipher.ax, cipher.logq, context.N);
+	Ring2Utils::modAndEqual(cipher.bx, cipher.logq, context.N);
 }
 
 Ciphertext Scheme::modDownTo(Ciphertext& cipher, long logq) {
-	ZZX bx, ax;
-	ZZ q = context.qpowvec[logq];
+	FlatPoly bx, ax;
 
-	Ring2Utils::mod(ax, cipher.ax, q, context.N);
-	Ring2Utils::mod(bx, cipher.bx, q, context.N);
+	Ring2Utils::mod(ax, cipher.ax, logq, context.N);
+	Ring2Utils::mod(bx, cipher.bx, logq, context.N);
 	return Ciphertext(ax, bx, cipher.logp, logq, cipher.slots);
 }
 
 void Scheme::modDownToAndEqual(Ciphertext& cipher, long logq) {
 	cipher.logq = logq;
-	ZZ q = context.qpowvec[logq];
 
-	Ring2Utils::modAndEqual(cipher.ax, q, context.N);
-	Ring2Utils::modAndEqual(cipher.bx, q, context.N);
+	Ring2Utils::modAndEqual(cipher.ax, logq, context.N);
+	Ring2Utils::modAndEqual(cipher.bx, logq, context.N);
 }
 
 
@@ -786,43 +1021,180 @@ void Scheme::modDownToAndEqual(Ciphertext& cipher, long logq) {
 //----------------------------------------------------------------------------------
 
 
-Ciphertext Scheme::leftRotateFast(Ciphertext& cipher, long rotSlots) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZ qQ = context.qpowvec[cipher.logq + context.logQ];
+long Scheme::keySwitchDigits(long logq) {
+	return min(context.dnum, (logq + context.logP - 1) / context.logP);
+}
+
+long Scheme::keySwitchPrimes(long logq) {
+	RingMultiplier& multiplier = RingMultiplier::getInstance(context.N);
+	long logDigits = 0;
+	while((1 << logDigits) < keySwitchDigits(logq)) logDigits++;
+	return multiplier.primesNeeded(min(logq, context.logP) + min(logq + context.logP, context.logQP) + logDigits + context.logN);
+}
+
+void Scheme::decomposeNTT(uint64_t* ra, FlatPoly& ax, long np, long logq) {
+	RingMultiplier& multiplier = RingMultiplier::getInstance(context.N);
+	long digits = keySwitchDigits(logq);
+	if(digits == 1) {
+		multiplier.CRT(ra, ax, np);
+		return;
+	}
+	FlatPoly* axdigits = new FlatPoly[digits];
+	Ring2Utils::decompose(axdigits, ax, context.logP, digits, logq, context.N);
+	for (long j = 0; j < digits; ++j) {
+		multiplier.CRT(ra + ((j * np) << context.logN), axdigits[j], np);
+	}
+	delete[] axdigits;
+}
+
+void Scheme::keySwitch(FlatPoly& axres, FlatPoly& bxres, FlatPoly& ax, Key& key, long logq) {
+	long np = keySwitchPrimes(logq);
+	uint64_t* ra = new uint64_t[(keySwitchDigits(logq) * np) << context.logN];
+	decomposeNTT(ra, ax, np, logq);
+	keySwitchNTT(axres, bxres, ra, np, key, logq);
+	delete[] ra;
+}
+
+void Scheme::keySwitchNTT(FlatPoly& axres, FlatPoly& bxres, uint64_t* ra, long np, Key& key, long logq) {
+	multByKeyNTT(axres, bxres, ra, np, key, logq + context.logP, context.logQP, keySwitchDigits(logq));
+	Ring2Utils::rightShiftAndEqual(axres, context.logP, logq, context.N);
+	Ring2Utils::rightShiftAndEqual(bxres, context.logP, logq, context.N);
+}
+
+void Scheme::multByKeyNTT(FlatPoly& axres, FlatPoly& bxres, uint64_t* ra, long np, Key& key, long logqQ, long logKey, long digits) {
+	RingMultiplier& multiplier = RingMultiplier::getInstance(context.N);
+	uint64_t* rx = new uint64_t[np << context.logN];
+	uint64_t* rkax = NULL;
+	uint64_t* rkbx = NULL;
+	bool isReduced = logqQ < logKey;
+	for (long j = 0; j < digits; ++j) {
+		Key& digitKey = j == 0 ? key : key.digitKeys[j - 1];
+		uint64_t* raj = ra + ((j * np) << context.logN);
+		uint64_t* rkaxj = digitKey.rax;
+		uint64_t* rkbxj = digitKey.rbx;
+		bool isOwned = digitKey.rax == NULL || digitKey.N != context.N || (!isReduced && digitKey.np < np);
+		if(isReduced && !isOwned) {
+			// products are needed mod 2^logqQ only, and the key reduced to it takes fewer primes
+			if(digitKey.keepsReduced) {
+				const ReducedKey& reduced = digitKey.getReduced(logqQ, np, context.N);
+				rkaxj = reduced.rax;
+				rkbxj = reduced.rbx;
+				isOwned = reduced.np < np;
+			} else {
+				isOwned = true;
+			}
+		}
+		if(isOwned) {
+			FlatPoly tmp;
+			if(rkax == NULL) {
+				rkax = new uint64_t[np << context.logN];
+				rkbx = new uint64_t[np << context.logN];
+			}
+			rkaxj = rkax;
+			rkbxj = rkbx;
+			if(isReduced) {
+				digitKey.transformReduced(rkaxj, rkbxj, logqQ, np, context.N);
+			} else {
+				multiplier.CRT(rkaxj, digitKey.getAx(tmp, context.N), np);
+				multiplier.CRT(rkbxj, digitKey.bx, np);
+			}
+		}
+		// products of all digits are summed in place of the first one
+		if(j == 0) {
+			multiplier.mulPointwise(rx, raj, rkaxj, np);
+			multiplier.mulPointwise(ra, raj, rkbxj, np);
+		} else {
+			multiplier.mulAddPointwise(rx, raj, rkaxj, np);
+			multiplier.mulAddPointwise(ra, raj, rkbxj, np);
+		}
+	}
+	multiplier.reconstruct(axres, rx, np, logqQ);
+	multiplier.reconstruct(bxres, ra, np, logqQ);
+	delete[] rkax;
+	delete[] rkbx;
+	delete[] rx;
+}
 
-	ZZX bxrot, ax, bx;
-	Key key = leftRotKeyMap.at(rotSlots);
+void Scheme::multBySmallPoly(FlatPoly& axres, FlatPoly& bxres, Ciphertext& cipher, SmallPoly& poly) {
+	RingMultiplier& multiplier = RingMultiplier::getInstance(context.N);
+	long bits = max(RingMultiplier::maxBits(cipher.ax, context.N), RingMultiplier::maxBits(cipher.bx, context.N));
+	long np = multiplier.primesNeeded(bits + poly.bits + context.logN);
+	uint64_t* rp = new uint64_t[np << context.logN];
+	uint64_t* rx = new uint64_t[np << context.logN];
+	multiplier.CRT(rp, poly, np);
 
-	Ring2Utils::inpower(bxrot, cipher.bx, context.rotGroup[rotSlots], context.Q, context.N);
-	Ring2Utils::inpower(bx, cipher.ax, context.rotGroup[rotSlots], context.Q, context.N);
+	multiplier.CRT(rx, cipher.ax, np);
+	multiplier.mulPointwise(rx, rx, rp, np);
+	multiplier.reconstruct(axres, rx, np, cipher.logq);
+
+	multiplier.CRT(rx, cipher.bx, np);
+	multiplier.mulPointwise(rx, rx, rp, np);
+	multiplier.reconstruct(bxres, rx, np, cipher.logq);
+
+	delete[] rp;
+	delete[] rx;
+}
+
+Ciphertext Scheme::leftRotateFast(Ciphertext& cipher, long rotSlots) {
 
-	Ring2Utils::mult(ax, bx, key.ax, qQ, context.N);
-	Ring2Utils::multAndEqual(bx, key.bx, qQ, context.N);
+	FlatPoly bxrot, ax, bx;
+	shared_ptr<Key> key = getLeftRotKey(rotSlots);
 
-	Ring2Utils::rightShiftAndEqual(ax, context.logQ, context.N);
-	Ring2Utils::rightShiftAndEqual(bx, context.logQ, context.N);
+	long* table = context.getInpowerTable(context.rotGroup[rotSlots]);
+	Ring2Utils::inpower(bxrot, cipher.bx, table, cipher.logq, context.N);
+	Ring2Utils::inpower(bx, cipher.ax, table, cipher.logq, context.N);
 
-	Ring2Utils::addAndEqual(bx, bxrot, q, context.N);
+	keySwitch(ax, bx, bx, *key, cipher.logq);
+
+	Ring2Utils::addAndEqual(bx, bxrot, cipher.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::leftRotateAndEqualFast(Ciphertext& cipher, long rotSlots) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZ qQ = context.qpowvec[cipher.logq + context.logQ];
-	ZZX bxrot;
-	Key key = leftRotKeyMap.at(rotSlots);
+	FlatPoly bxrot;
+	shared_ptr<Key> key = getLeftRotKey(rotSlots);
+
+	long* table = context.getInpowerTable(context.rotGroup[rotSlots]);
+	Ring2Utils::inpower(bxrot, cipher.bx, table, cipher.logq, context.N);
+	Ring2Utils::inpower(cipher.bx, cipher.ax, table, cipher.logq, context.N);
+
+	keySwitch(cipher.ax, cipher.bx, cipher.bx, *key, cipher.logq);
+
+	Ring2Utils::addAndEqual(cipher.bx, bxrot, cipher.logq, context.N);
+}
 
-	Ring2Utils::inpower(bxrot, cipher.bx, context.rotGroup[rotSlots], context.Q, context.N);
-	Ring2Utils::inpower(cipher.bx, cipher.ax, context.rotGroup[rotSlots], context.Q, context.N);
+Ciphertext* Scheme::leftRotateManyFast(Ciphertext& cipher, vector<long> rots) {
+	long size = rots.size();
+	Ciphertext* res = new Ciphertext[size];
 
-	Ring2Utils::mult(cipher.ax, cipher.bx, key.ax, qQ, context.N);
-	Ring2Utils::multAndEqual(cipher.bx, key.bx, qQ, context.N);
+	RingMultiplier& multiplier = RingMultiplier::getInstance(context.N);
+	long np = keySwitchPrimes(cipher.logq);
+	long nr = keySwitchDigits(cipher.logq) * np;
+	uint64_t* ra = new uint64_t[nr << context.logN];
+	decomposeNTT(ra, cipher.ax, np, cipher.logq);
 
-	Ring2Utils::rightShiftAndEqual(cipher.ax, context.logQ, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher.bx, context.logQ, context.N);
+	NTL_EXEC_RANGE(size, first, last);
+	uint64_t* rarot = new uint64_t[nr << context.logN];
+	for (long j = first; j < last; ++j) {
+		long rot = ((rots[j] % context.Nh) + context.Nh) % context.Nh;
+		if(rot == 0) {
+			res[j] = cipher;
+			continue;
+		}
+		FlatPoly ax, bx, bxrot;
+		shared_ptr<Key> key = getLeftRotKey(rot);
+		Ring2Utils::inpower(bxrot, cipher.bx, context.getInpowerTable(context.rotGroup[rot]), cipher.logq, context.N);
+		multiplier.inpower(rarot, ra, context.rotGroup[rot], nr);
+		keySwitchNTT(ax, bx, rarot, np, *key, cipher.logq);
+		Ring2Utils::addAndEqual(bx, bxrot, cipher.logq, context.N);
+		res[j] = Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
+	}
+	delete[] rarot;
+	NTL_EXEC_RANGE_END;
 
-	Ring2Utils::addAndEqual(cipher.bx, bxrot, q, context.N);
+	delete[] ra;
+	return res;
 }
 
 Ciphertext Scheme::leftRotateByPo2(Ciphertext& cipher, long logrotSlots) {
@@ -852,12 +1224,8 @@ Ciphertext Scheme::leftRotate(Ciphertext& cipher, long rotSlots) {
 }
 
 void Scheme::leftRotateAndEqual(Ciphertext& cipher, long rotSlots) {
-	long remrotSlots = rotSlots % cipher.slots;
-	long logrotSlots = log2((double)remrotSlots) + 1;
-	for (long i = 0; i < logrotSlots; ++i) {
-		if(bit(remrotSlots, i)) {
-			leftRotateByPo2AndEqual(cipher, i);
-		}
+	for (long rot : rotationPath(rotSlots % cipher.slots, cipher.slots)) {
+		leftRotateAndEqualFast(cipher, rot);
 	}
 }
 
@@ -868,52 +1236,36 @@ Ciphertext Scheme::rightRotate(Ciphertext& cipher, long rotSlots) {
 }
 
 void Scheme::rightRotateAndEqual(Ciphertext& cipher, long rotSlots) {
-	long remrotSlots = rotSlots % cipher.slots;
-	long logrotSlots = log2((double)remrotSlots) + 1;
-	for (long i = 0; i < logrotSlots; ++i) {
-		if(bit(remrotSlots, i)) {
-			rightRotateByPo2AndEqual(cipher, i);
-		}
+	for (long rot : rotationPath(-(rotSlots % cipher.slots), cipher.slots)) {
+		leftRotateAndEqualFast(cipher, rot);
 	}
 }
 
 Ciphertext Scheme::conjugate(Ciphertext& cipher) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZ qQ = context.qpowvec[cipher.logq + context.logQ];
-
-	ZZX bxconj, ax, bx;
-	Key key = keyMap.at(CONJUGATION);
 
-	Ring2Utils::conjugate(bxconj, cipher.bx, context.N);
-	Ring2Utils::conjugate(bx, cipher.ax, context.N);
+	FlatPoly bxconj, ax, bx;
+	Key& key = keyMap.at(CONJUGATION);
 
-	Ring2Utils::mult(ax, bx, key.ax, qQ, context.N);
-	Ring2Utils::multAndEqual(bx, key.bx, qQ, context.N);
+	Ring2Utils::conjugate(bxconj, cipher.bx, cipher.logq, context.N);
+	Ring2Utils::conjugate(bx, cipher.ax, cipher.logq, context.N);
 
-	Ring2Utils::rightShiftAndEqual(ax, context.logQ, context.N);
-	Ring2Utils::rightShiftAndEqual(bx, context.logQ, context.N);
+	keySwitch(ax, bx, bx, key, cipher.logq);
 
-	Ring2Utils::addAndEqual(bx, bxconj, q, context.N);
+	Ring2Utils::addAndEqual(bx, bxconj, cipher.logq, context.N);
 
 	return Ciphertext(ax, bx, cipher.logp, cipher.logq, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::conjugateAndEqual(Ciphertext& cipher) {
-	ZZ q = context.qpowvec[cipher.logq];
-	ZZ qQ = context.qpowvec[cipher.logq + context.logQ];
-	ZZX bxconj;
-	Key key = keyMap.at(CONJUGATION);
-
-	Ring2Utils::conjugate(bxconj, cipher.bx, context.N);
-	Ring2Utils::conjugate(cipher.bx, cipher.ax, context.N);
+	FlatPoly bxconj;
+	Key& key = keyMap.at(CONJUGATION);
 
-	Ring2Utils::mult(cipher.ax, cipher.bx, key.ax, qQ, context.N);
-	Ring2Utils::multAndEqual(cipher.bx, key.bx, qQ, context.N);
+	Ring2Utils::conjugate(bxconj, cipher.bx, cipher.logq, context.N);
+	Ring2Utils::conjugate(cipher.bx, cipher.ax, cipher.logq, context.N);
 
-	Ring2Utils::rightShiftAndEqual(cipher.ax, context.logQ, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher.bx, context.logQ, context.N);
+	keySwitch(cipher.ax, cipher.bx, cipher.bx, key, cipher.logq);
 
-	Ring2Utils::addAndEqual(cipher.bx, bxconj, q, context.N);
+	Ring2Utils::addAndEqual(cipher.bx, bxconj, cipher.logq, context.N);
 }
 
 
@@ -923,12 +1275,8 @@ void Scheme::conjugateAndEqual(Ciphertext& cipher) {
 
 
 void Scheme::normalizeAndEqual(Ciphertext& cipher) {
-	ZZ q = context.qpowvec[cipher.logq];
-
-	for (int i = 0; i < context.N; ++i) {
-		if(NumBits(cipher.ax.rep[i]) == cipher.logq) cipher.ax.rep[i] -= q;
-		if(NumBits(cipher.bx.rep[i]) == cipher.logq) cipher.bx.rep[i] -= q;
-	}
+	Ring2Utils::liftAndEqual(cipher.ax, cipher.logq, context.logQ, context.N);
+	Ring2Utils::liftAndEqual(cipher.bx, cipher.logq, context.logQ, context.N);
 }
 
 void Scheme::coeffToSlotAndEqual(Ciphertext& cipher) {
@@ -937,38 +1285,34 @@ void Scheme::coeffToSlotAndEqual(Ciphertext& cipher) {
 	long logk = logSlots / 2;
 	long k = 1 << logk;
 
-	long ki, j;
-	Ciphertext* rotvec = new Ciphertext[k];
-	rotvec[0] = cipher;
-
-	NTL_EXEC_RANGE(k - 1, first, last);
-	for (j = first; j < last; ++j) {
-		rotvec[j + 1] = leftRotateFast(rotvec[0], j + 1);
+	vector<long> rots(k);
+	for (long j = 0; j < k; ++j) {
+		rots[j] = j;
 	}
-	NTL_EXEC_RANGE_END;
+	Ciphertext* rotvec = leftRotateManyFast(cipher, rots);
 
 	BootContext bootContext = context.bootContextMap.at(logSlots);
 
 	Ciphertext* tmpvec = new Ciphertext[k];
 
 	NTL_EXEC_RANGE(k, first, last);
-	for (j = first; j < last; ++j) {
+	for (long j = first; j < last; ++j) {
 		tmpvec[j] = multByPoly(rotvec[j], bootContext.pvec[j], bootContext.logp);
 	}
 	NTL_EXEC_RANGE_END;
 
-	for (j = 1; j < k; ++j) {
+	for (long j = 1; j < k; ++j) {
 		addAndEqual(tmpvec[0], tmpvec[j]);
 	}
 	cipher = tmpvec[0];
 
-	for (ki = k; ki < slots; ki += k) {
+	for (long ki = k; ki < slots; ki += k) {
 		NTL_EXEC_RANGE(k, first, last);
-		for (j = first; j < last; ++j) {
+		for (long j = first; j < last; ++j) {
 			tmpvec[j] = multByPoly(rotvec[j], bootContext.pvec[j + ki], bootContext.logp);
 		}
 		NTL_EXEC_RANGE_END;
-		for (j = 1; j < k; ++j) {
+		for (long j = 1; j < k; ++j) {
 			addAndEqual(tmpvec[0], tmpvec[j]);
 		}
 		leftRotateAndEqualFast(tmpvec[0], ki);
@@ -985,39 +1329,35 @@ void Scheme::slotToCoeffAndEqual(Ciphertext& cipher) {
 	long logk = logSlots / 2;
 	long k = 1 << logk;
 
-	long ki, j;
-	Ciphertext* rotvec = new Ciphertext[k];
-	rotvec[0] = cipher;
-
-	NTL_EXEC_RANGE(k-1, first, last);
-	for (j = first; j < last; ++j) {
-		rotvec[j + 1] = leftRotateFast(rotvec[0], j + 1);
+	vector<long> rots(k);
+	for (long j = 0; j < k; ++j) {
+		rots[j] = j;
 	}
-	NTL_EXEC_RANGE_END;
+	Ciphertext* rotvec = leftRotateManyFast(cipher, rots);
 
 	BootContext bootContext = context.bootContextMap.at(logSlots);
 
 	Ciphertext* tmpvec = new Ciphertext[k];
 
 	NTL_EXEC_RANGE(k, first, last);
-	for (j = first; j < last; ++j) {
+	for (long j = first; j < last; ++j) {
 		tmpvec[j] = multByPoly(rotvec[j], bootContext.pvecInv[j], bootContext.logp);
 	}
 	NTL_EXEC_RANGE_END;
 
-	for (j = 1; j < k; ++j) {
+	for (long j = 1; j < k; ++j) {
 		addAndEqual(tmpvec[0], tmpvec[j]);
 	}
 	cipher = tmpvec[0];
 
-	for (ki = k; ki < slots; ki+=k) {
+	for (long ki = k; ki < slots; ki+=k) {
 		NTL_EXEC_RANGE(k, first, last);
-		for (j = first; j < last; ++j) {
+		for (long j = first; j < last; ++j) {
 			tmpvec[j] = multByPoly(rotvec[j], bootContext.pvecInv[j + ki], bootContext.logp);
 		}
 		NTL_EXEC_RANGE_END;
 
-		for (j = 1; j < k; ++j) {
+		for (long j = 1; j < k; ++j) {
 			addAndEqual(tmpvec[0], tmpvec[j]);
 		}
 
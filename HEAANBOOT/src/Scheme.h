@@ -11,18 +11,22 @@
 #include "Common.h"
 #include "Ciphertext.h"
 #include "Context.h"
+#include "EncryptionPool.h"
 #include "Key.h"
 #include "Plaintext.h"
+#include "RotationKeyStore.h"
+#include "RotationPlan.h"
 #include "SecretKey.h"
 
 #include <complex>
+#include <memory>
 
 using namespace std;
 using namespace NTL;
 
-static long ENCRYPTION = 0;
-static long MULTIPLICATION  = 1;
-static long CONJUGATION = 2;
+static const long ENCRYPTION = 0;
+static const long MULTIPLICATION  = 1;
+static const long CONJUGATION = 2;
 
 class Scheme {
 private:
@@ -32,10 +36,19 @@ public:
 	map<long, Key> keyMap; ///< contain Encryption, Multiplication and Conjugation keys, if generated
 	map<long, Key> leftRotKeyMap; ///< contain left rotation keys, if generated
 
+	EncryptionPool* encPool; ///< precomputed encryptions of zero mod 2^logQQ for encryptMsg, NULL if not started
+	RotationKeyStore* rotKeyStore; ///< left rotation keys loaded on first use, NULL if not opened
+	RotationPlan* rotPlan; ///< planned rotation keys and their shortest paths, NULL if not planned
+
 	Scheme(Context& context);
 
 	Scheme(SecretKey& secretKey, Context& context);
 
+	~Scheme();
+
+	Scheme(const Scheme&) = delete;
+	Scheme& operator=(const Scheme&) = delete;
+
 	//----------------------------------------------------------------------------------
 	//   KEYS GENERATION
 	//----------------------------------------------------------------------------------
@@ -61,6 +74,13 @@ public:
 	 */
 	void addLeftRotKey(SecretKey& secretKey, long rot);
 
+	/**
+	 * generates keys for left rotations that are not in leftRotKeyMap yet,
+	 * in parallel over the NTL thread pool (keys are stored in leftRotKeyMap)
+	 * @param[in] rots: rotation amounts, duplicates are generated once
+	 */
+	void addLeftRotKeys(SecretKey& secretKey, const vector<long>& rots);
+
 	/**
 	 * generates all keys for power-of-two left rotations (keys are stored in leftRotKeyMap)
 	 */
@@ -72,7 +92,7 @@ public:
 	void addRightRotKeys(SecretKey& secretKey);
 
 	/**
-	 * generates key for bootstrapping (keys are stored in leftRotKeyMap and bootKeyMap)
+	 * generates key for bootstrapping, rotation keys in parallel (keys are stored in leftRotKeyMap and bootKeyMap)
 	 */
 	void addBootKey(SecretKey& secretKey, long logl, long logp);
 
@@ -81,6 +101,47 @@ public:
 	 */
 	void addSortKeys(SecretKey& secretKey, long size);
 
+	/**
+	 * chooses rotation keys for given rotations within a memory budget (see RotationPlan),
+	 * generates them, and makes leftRotate and rightRotate follow their shortest paths;
+	 * the keys are reduced to lower levels on each use rather than kept reduced (see Key::keepsReduced)
+	 * @param[in] rots: left rotation amounts used by the workload, negative for right rotations
+	 * @param[in] memoryBudget: bytes available for the rotation keys, see rotKeyBytes
+	 * @throws invalid_argument if the budget is too small to reach all rotations
+	 */
+	void addPlannedRotKeys(SecretKey& secretKey, const vector<long>& rots, long memoryBudget);
+
+	/**
+	 * @return bytes of one rotation key in ntt form with ax kept as its seed, without kept reductions
+	 */
+	long rotKeyBytes();
+
+	/**
+	 * stores switching key in ntt form, so key switching transforms only the ciphertext part;
+	 * ax of seeded key is released and kept as its seed
+	 * @param[in, out] key: multiplication, conjugation or rotation key
+	 * @throws invalid_argument if key has other than context.dnum - 1 digit keys
+	 */
+	void transformKey(Key& key);
+
+	/**
+	 * stores all multiplication, conjugation and rotation keys in ntt form (e.g. after keys are read from file)
+	 */
+	void transformKeys();
+
+	/**
+	 * stores encryption key in ntt form with the primes needed for products with ternary polynomials
+	 * @param[in, out] key: encryption key
+	 */
+	void transformEncKey(Key& key);
+
+	/**
+	 * drops the reductions to ciphertext levels that keys with keepsReduced set keep from their first use
+	 * at each level (see Key::getReduced), e.g. after a circuit no longer runs at those levels;
+	 * they are computed again on next use. Keys without keepsReduced keep none and are unchanged
+	 */
+	void releaseReducedKeys();
+
 
 	//----------------------------------------------------------------------------------
 	//   ENCODING & DECODING
@@ -113,6 +174,36 @@ public:
 	 */
 	complex<double>* decode(Plaintext& msg);
 
+	/**
+	 * encodes count arrays of complex values in parallel over the NTL thread pool
+	 * @param[out] res: count messages, their buffers are reused if the shape allows
+	 * @param[in] vals: count arrays of complex values
+	 * @param[in] count: number of arrays
+	 * @param[in] slots: size of each array
+	 * @param[in] logp: log of message quantize value
+	 * @param[in] logq: log of ciphertext modulus
+	 */
+	void encodeBatch(Plaintext* res, complex<double>** vals, long count, long slots, long logp, long logq);
+
+	/**
+	 * encodes count arrays of double values in parallel over the NTL thread pool
+	 * @param[out] res: count messages, their buffers are reused if the shape allows
+	 * @param[in] vals: count arrays of double values
+	 * @param[in] count: number of arrays
+	 * @param[in] slots: size of each array
+	 * @param[in] logp: log of message quantize value
+	 * @param[in] logq: log of ciphertext modulus
+	 */
+	void encodeBatch(Plaintext* res, double** vals, long count, long slots, long logp, long logq);
+
+	/**
+	 * decodes count messages in parallel over the NTL thread pool
+	 * @param[out] res: count arrays, res[k] holds msgs[k].slots values
+	 * @param[in] msgs: count messages
+	 * @param[in] count: number of messages
+	 */
+	void decodeBatch(complex<double>** res, Plaintext* msgs, long count);
+
 	/**
 	 * encodes a single double value into a ZZX polynomial using special fft inverse
 	 * @param[in] val: double value
@@ -145,12 +236,55 @@ public:
 
 
 	/**
-	 * encrypts message into ciphertext using public key encyption
+	 * encrypts message into ciphertext using public key encyption,
+	 * with an encryption of zero from the pool if it is started and not empty
 	 * @param[in] msg: message
 	 * @return ciphertext
 	 */
 	Ciphertext encryptMsg(Plaintext& msg);
 
+	/**
+	 * encrypts message into ciphertext using secret key, with ax expanded from a fresh seed
+	 * that is kept in the ciphertext, so that it serializes at about half size
+	 * @param[in] secretKey: secret key
+	 * @param[in] msg: message
+	 * @return ciphertext
+	 */
+	Ciphertext encryptSymmetric(SecretKey& secretKey, Plaintext& msg);
+
+	/**
+	 * starts background generation of encryptions of zero at the top level for encryptMsg,
+	 * restarting the pool if it is running
+	 * @param[in] size: maximum number of pooled encryptions
+	 * @param[in] threads: number of refill threads
+	 */
+	void startEncryptionPool(long size, long threads = 1);
+
+	/**
+	 * stops background generation and drops pooled encryptions
+	 */
+	void stopEncryptionPool();
+
+	/**
+	 * opens file of left rotation keys (see SerializationUtils::writeRotationKeyStore);
+	 * rotations with no key in leftRotKeyMap load it from the file on first use
+	 * @param[in] path: rotation key store file
+	 * @param[in] maxResident: maximum number of loaded keys in memory, 0 for no bound
+	 */
+	void openRotationKeyStore(string path, long maxResident = 0);
+
+	/**
+	 * closes rotation key store and drops its loaded keys
+	 */
+	void closeRotationKeyStore();
+
+	/**
+	 * @param[in] rot: rotation amount
+	 * @return key from leftRotKeyMap, or loaded from the rotation key store
+	 * @throws out_of_range if there is no key for rot
+	 */
+	shared_ptr<Key> getLeftRotKey(long rot);
+
 	/**
 	 * decrypts ciphertext into message
 	 * @param[in] secretKey: secret key
@@ -491,6 +625,41 @@ public:
 	 */
 	void multByPolyAndEqual(Ciphertext& cipher, ZZX& poly, long logp);
 
+	/**
+	 * polynomial multiplication by a precomputed encoding, e.g. from BootContext
+	 * @param[in] cipher: ciphertext(m)
+	 * @param[in] poly: polynomial - encoding(cnst) with signed coefficients in two's complement
+	 * @param[in] logp: number of quantized bits
+	 * @return ciphertext(m * cnst)
+	 */
+	Ciphertext multByPoly(Ciphertext& cipher, FlatPoly& poly, long logp);
+
+	/**
+	 * polynomial multiplication by a precomputed encoding, e.g. from BootContext
+	 * @param[in] cipher: ciphertext(m) -> ciphertext(m * cnst)
+	 * @param[in] poly: polynomial - encoding(cnst) with signed coefficients in two's complement
+	 * @param[in] logp: number of quantized bits
+	 */
+	void multByPolyAndEqual(Ciphertext& cipher, FlatPoly& poly, long logp);
+
+	/**
+	 * polynomial multiplication by an encoding with int64_t coefficients, e.g. from BootContext;
+	 * the encoding is transformed once for both parts and bounds the ntt primes by its bits
+	 * @param[in] cipher: ciphertext(m)
+	 * @param[in] poly: polynomial - encoding(cnst)
+	 * @param[in] logp: number of quantized bits
+	 * @return ciphertext(m * cnst)
+	 */
+	Ciphertext multByPoly(Ciphertext& cipher, SmallPoly& poly, long logp);
+
+	/**
+	 * polynomial multiplication by an encoding with int64_t coefficients, e.g. from BootContext
+	 * @param[in] cipher: ciphertext(m) -> ciphertext(m * cnst)
+	 * @param[in] poly: polynomial - encoding(cnst)
+	 * @param[in] logp: number of quantized bits
+	 */
+	void multByPolyAndEqual(Ciphertext& cipher, SmallPoly& poly, long logp);
+
 	/**
 	 * multiplication by monomial X^degree
 	 * @param[in] cipher: ciphertext(m)
@@ -659,6 +828,15 @@ public:
 	 */
 	void leftRotateAndEqualFast(Ciphertext& cipher, long rotSlots);
 
+	/**
+	 * calculates ciphertexts of array rotated by several amounts, sharing the ntt of ax:
+	 * each rotation is a permutation of its residues followed by the product with the cached key
+	 * @param[in] cipher: ciphertext(m(v_1, v_2, ..., v_slots))
+	 * @param[in] rots: rotation slots, taken mod Nh so negative amounts rotate right; 0 gives a copy of cipher
+	 * @return array of ciphertexts(m(v_{1+rots[j]}, v_{2+rots[j]}, ..., v_{slots+rots[j]}), delete[] by caller
+	 */
+	Ciphertext* leftRotateManyFast(Ciphertext& cipher, vector<long> rots);
+
 	/**
 	 * calculates ciphertext of array with rotated indexes
 	 * @param[in] cipher: ciphertext(m(v_1, v_2, ..., v_slots))
@@ -710,6 +888,7 @@ public:
 
 	/**
 	 * part of bootstrapping procedure: normalizes coefficients of ax and bx in ciphertext
+	 * to (-q/2, q/2] and stores them mod 2^logQ, so that cipher.logq can be raised to logQ
 	 * @param[in, out] cipher: ciphertext with ax, bx -> ciphertext with normalized ax, bx
 	 */
 	void normalizeAndEqual(Ciphertext& cipher);
@@ -748,6 +927,105 @@ public:
 	 */
 	void bootstrapAndEqual(Ciphertext& cipher, long logq, long logQ, long logT, long logI = 4);
 
+private:
+
+	/**
+	 * samples key for left rotation and stores it in ntt form, safe to call concurrently for different keys
+	 * @param[out] key: rotation key
+	 * @param[in] rot: rotation amount
+	 */
+	void generateLeftRotKey(Key& key, SecretKey& secretKey, long rot);
+
+	/**
+	 * @return true if leftRotKeyMap or the rotation key store has key for rot
+	 */
+	bool hasLeftRotKey(long rot);
+
+	/**
+	 * left rotations whose sum is rot mod slots, with fewest key switches among:
+	 * the key for rot itself, the path of the rotation plan, signed binary digits of rot
+	 * over left and right power-of-two keys when all of them exist,
+	 * otherwise binary digits over left (rot > 0) or right (rot < 0) power-of-two keys
+	 * @param[in] rot: rotation amount in (-slots, slots), negative for right rotation
+	 * @param[in] slots: number of slots
+	 */
+	vector<long> rotationPath(long rot, long slots);
+
+	/**
+	 * samples switching key from secret key to sxnew, with context.dnum digits
+	 * (digit j encrypts P * 2^(j logP) * sxnew mod PQ), and stores it in ntt form
+	 * @param[out] key: switching key
+	 * @param[in] sxnew: polynomial mod PQ
+	 */
+	void generateSwitchKey(Key& key, FlatPoly& sxnew, SecretKey& secretKey);
+
+	/**
+	 * @return number of digits of logP bits of a polynomial mod 2^logq in key switching
+	 */
+	long keySwitchDigits(long logq);
+
+	/**
+	 * @return number of ntt primes for the sum of products of keySwitchDigits(logq) digits
+	 * with switching key parts mod 2^(logq + logP)
+	 */
+	long keySwitchPrimes(long logq);
+
+	/**
+	 * balanced digits of ax in base 2^logP (see Ring2Utils::decompose) in ntt domain,
+	 * ax itself if it has one digit
+	 * @param[out] ra: array of keySwitchDigits(logq) * np * N residues, digit after digit
+	 * @param[in] ax: polynomial in Z_q[X] / (X^N + 1)
+	 * @param[in] np: number of ntt primes
+	 * @param[in] logq: log of q
+	 */
+	void decomposeNTT(uint64_t* ra, FlatPoly& ax, long np, long logq);
+
+	/**
+	 * key switching part shared by multiplication, rotation and conjugation
+	 * @param[out] axres: (sum_j ax_j * key_j.ax mod qP) / P over digits ax_j of ax
+	 * @param[out] bxres: (sum_j ax_j * key_j.bx mod qP) / P over digits ax_j of ax
+	 * @param[in] ax: polynomial in Z_q[X] / (X^N + 1), may alias axres or bxres
+	 * @param[in] key: switching key
+	 * @param[in] logq: log of q
+	 */
+	void keySwitch(FlatPoly& axres, FlatPoly& bxres, FlatPoly& ax, Key& key, long logq);
+
+	/**
+	 * key switching with ax given by its residues in ntt domain (see RingMultiplier)
+	 * @param[in, out] ra: residues of digits of ax (see decomposeNTT), destroyed
+	 * @param[in] np: number of ntt primes
+	 */
+	void keySwitchNTT(FlatPoly& axres, FlatPoly& bxres, uint64_t* ra, long np, Key& key, long logq);
+
+	/**
+	 * products of polynomials given by their residues in ntt domain with both parts of a key,
+	 * summed over digits, shared by encryption and key switching
+	 * @param[out] axres: sum_j a_j * key_j.ax mod 2^logqQ
+	 * @param[out] bxres: sum_j a_j * key_j.bx mod 2^logqQ
+	 * @param[in, out] ra: array of digits * np * N residues of a_j, destroyed
+	 * @param[in] np: number of ntt primes
+	 * @param[in] key: key, in ntt form with at least np primes or as polynomials; key_j is its digit j;
+	 * for logqQ < logKey its reduction mod 2^logqQ is used, kept in the key if it is in ntt form
+	 * @param[in] logqQ: log of modulus of products
+	 * @param[in] logKey: log of modulus of key
+	 * @param[in] digits: number of digits
+	 */
+	void multByKeyNTT(FlatPoly& axres, FlatPoly& bxres, uint64_t* ra, long np, Key& key, long logqQ, long logKey, long digits = 1);
+
+	/**
+	 * fresh encryption of zero before rescaling by Q
+	 * @param[out] ax, bx: (vx * key.ax + e0, vx * key.bx + e1) mod 2^logqQ
+	 * @param[in] logqQ: log of q * Q
+	 */
+	void encryptZero(FlatPoly& ax, FlatPoly& bx, long logqQ);
+
+	/**
+	 * products of both parts of a ciphertext with one small polynomial
+	 * @param[out] axres: cipher.ax * poly mod 2^logq, may be cipher.ax
+	 * @param[out] bxres: cipher.bx * poly mod 2^logq, may be cipher.bx
+	 */
+	void multBySmallPoly(FlatPoly& axres, FlatPoly& bxres, Ciphertext& cipher, SmallPoly& poly);
+
 };
 
 #endif
@@ -7,7 +7,8 @@
 */
 #include "SecretKey.h"
 
-SecretKey::SecretKey(long logN, long h) {
+SecretKey::SecretKey(long logN, long h) : tx(sx) {
 	long N = 1 << logN;
 	NumUtils::sampleHWT(sx, N, h);
+	tx = TernaryPoly(sx);
 }
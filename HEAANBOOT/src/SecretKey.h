@@ -11,6 +11,7 @@
 #include <NTL/ZZX.h>
 
 #include "NumUtils.h"
+#include "TernaryPoly.h"
 
 using namespace std;
 using namespace NTL;
@@ -20,11 +21,12 @@ class SecretKey {
 public:
 
 	ZZX sx; ///< secret key
+	TernaryPoly tx; ///< nonzero coefficients of sx for multiplication by sx
 
 	SecretKey(long logN, long h = 64);
 
-	SecretKey(ZZX sx = ZZX::zero()) : sx(sx) {};
-	SecretKey(const SecretKey& o) : sx(o.sx) {};
+	SecretKey(ZZX sx = ZZX::zero()) : sx(sx), tx(sx) {};
+	SecretKey(const SecretKey& o) : sx(o.sx), tx(o.tx) {};
 
 };
 
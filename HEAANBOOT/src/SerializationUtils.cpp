@@ -7,21 +7,54 @@
 */
 #include "SerializationUtils.h"
 
+#include <algorithm>
+#include <cstring>
+
+/**
+ * seed as 2 * SEED_BYTES hex digits
+ */
+static string seedToHex(const unsigned char* seed) {
+	static const char* digits = "0123456789abcdef";
+	string res;
+	for (long i = 0; i < SEED_BYTES; ++i) {
+		res += digits[seed[i] >> 4];
+		res += digits[seed[i] & 15];
+	}
+	return res;
+}
+
+static void seedFromHex(unsigned char* seed, const string& hex) {
+	if((long) hex.size() < 2 * SEED_BYTES) {
+		throw std::invalid_argument("Seed is too short");
+	}
+	for (long i = 0; i < SEED_BYTES; ++i) {
+		seed[i] = (unsigned char) stoi(hex.substr(2 * i, 2), NULL, 16);
+	}
+}
+
 void SerializationUtils::writeCiphertext(Ciphertext& cipher, string path) {
 	ofstream myfile;
 	myfile.open(path);
-	myfile << "Ciphertext" << endl;
-	myfile << deg(cipher.ax) << endl;
-	myfile << deg(cipher.bx) << endl;
+	bool seeded = cipher.hasValidSeed();
+	myfile << (seeded ? "SeededCiphertext" : "Ciphertext") << endl;
+	ZZX ax, bx;
+	cipher.bx.toZZX(bx);
+	if(seeded) {
+		myfile << seedToHex(cipher.seed) << endl;
+	} else {
+		cipher.ax.toZZX(ax);
+		myfile << deg(ax) << endl;
+	}
+	myfile << deg(bx) << endl;
 	myfile << cipher.logp << endl;
 	myfile << cipher.logq << endl;
 	myfile << cipher.slots << endl;
 	myfile << cipher.isComplex << endl;
-	for(long i = 0; i < deg(cipher.ax) + 1; i++) {
-		myfile << cipher.ax[i] << endl;
+	for(long i = 0; !seeded && i < deg(ax) + 1; i++) {
+		myfile << ax[i] << endl;
 	}
-	for(long i = 0; i < deg(cipher.bx) + 1; i++) {
-		myfile << cipher.bx[i] << endl;
+	for(long i = 0; i < deg(bx) + 1; i++) {
+		myfile << bx[i] << endl;
 	}
 	myfile.close();
 }
@@ -33,9 +66,15 @@ Ciphertext SerializationUtils::readCiphertext(string path) {
 		long temp;
 		string line;
 		getline(myfile, line);
+		bool seeded = line == "SeededCiphertext";
+		unsigned char seed[SEED_BYTES];
 		getline(myfile, line);
-		temp = atol(line.c_str());
-		ax.SetLength(temp + 1);
+		if(seeded) {
+			seedFromHex(seed, line);
+		} else {
+			temp = atol(line.c_str());
+			ax.SetLength(temp + 1);
+		}
 		getline(myfile, line);
 		temp = atol(line.c_str());
 		bx.SetLength(temp + 1);
@@ -48,7 +87,7 @@ Ciphertext SerializationUtils::readCiphertext(string path) {
 		getline(myfile, line);
 		bool isComplex = atoi(line.c_str());
 
-		for(long i = 0; i < deg(ax) + 1; i++) {
+		for(long i = 0; !seeded && i < deg(ax) + 1; i++) {
 			getline(myfile, line);
 			ax[i] = conv<ZZ>(line.c_str());
 		}
@@ -57,7 +96,14 @@ Ciphertext SerializationUtils::readCiphertext(string path) {
 			bx[i] = conv<ZZ>(line.c_str());
 		}
 		myfile.close();
-		return Ciphertext(ax, bx, logp, logq, slots, isComplex);
+		if(seeded) {
+			FlatPoly fax;
+			NumUtils::sampleUniform2(fax, seed, deg(bx) + 1, logq);
+			Ciphertext cipher(fax, FlatPoly(bx, logq, deg(bx) + 1), logp, logq, slots, isComplex);
+			cipher.setSeed(seed);
+			return cipher;
+		}
+		return Ciphertext(FlatPoly(ax, logq, deg(ax) + 1), FlatPoly(bx, logq, deg(bx) + 1), logp, logq, slots, isComplex);
 	} else {
 		throw std::invalid_argument("Unable to open file");
 	}
@@ -67,13 +113,15 @@ void SerializationUtils::writePlaintext(Plaintext& message, string path) {
 	ofstream myfile;
 	myfile.open(path);
 	myfile << "Plaintext" << endl;
-	myfile << deg(message.mx) << endl;
+	ZZX mx;
+	message.mx.toZZX(mx);
+	myfile << deg(mx) << endl;
 	myfile << message.logp << endl;
 	myfile << message.logq << endl;
 	myfile << message.slots << endl;
 	myfile << message.isComplex << endl;
-	for(long i = 0; i < deg(message.mx) + 1; i++) {
-		myfile << message.mx[i] << endl;
+	for(long i = 0; i < deg(mx) + 1; i++) {
+		myfile << mx[i] << endl;
 	}
 	myfile.close();
 }
@@ -102,7 +150,7 @@ Plaintext SerializationUtils::readPlaintext(string path) {
 			mx[i] = conv<ZZ>(line.c_str());
 		}
 		myfile.close();
-		return Plaintext(mx, logp, logq, slots, isComplex);
+		return Plaintext(FlatPoly(mx, deg(mx) + 1), logp, logq, slots, isComplex);
 	} else {
 		throw std::invalid_argument("Unable to open file");
 	}
@@ -116,6 +164,7 @@ void SerializationUtils::writeContext(Context& context, string path) {
 	myfile << context.logQ << endl;
 	myfile << context.sigma << endl;
 	myfile << context.h << endl;
+	myfile << context.dnum << endl;
 	myfile << "BootContext" << endl;
 	myfile << context.bootContextMap.size() << endl;
 	for (auto const& element : context.bootContextMap) {
@@ -143,9 +192,15 @@ Context SerializationUtils::readContext(string path) {
 		//h
 		getline(myfile, line);
 		long h = atol(line.c_str());
-		Context context(logN, logQ, sigma, h);
-
+		//dnum, missing in files written before it was added
 		getline(myfile, line);
+		long dnum = 1;
+		if(line != "BootContext") {
+			dnum = atol(line.c_str());
+			getline(myfile, line);
+		}
+		Context context(logN, logQ, sigma, h, dnum);
+
 		getline(myfile, line);
 		long bootsize = atol(line.c_str());
 		for (long i = 0; i < bootsize; ++i) {
@@ -161,34 +216,110 @@ Context SerializationUtils::readContext(string path) {
 	}
 }
 
+/**
+ * bits of key coefficients: encryption key is mod QQ, switching keys are mod Q * P
+ */
+static long keyBits(Scheme& scheme, long keyID) {
+	return keyID == ENCRYPTION ? scheme.context.logQQ : scheme.context.logQP;
+}
+
+/**
+ * key followed by the number of its digit keys and their entries
+ */
+static void writeKeyEntry(ofstream& myfile, const Key& key, bool seeded, long N) {
+	ZZX ax, bx;
+	key.bx.toZZX(bx);
+	if(seeded) {
+		myfile << seedToHex(key.seed) << endl;
+	} else {
+		FlatPoly tmp;
+		key.getAx(tmp, N).toZZX(ax);
+		myfile << deg(ax) << endl;
+	}
+	myfile << deg(bx) << endl;
+	for (long i = 0; !seeded && i < deg(ax) + 1; ++i) {
+		myfile << ax[i] << endl;
+	}
+	for (long i = 0; i < deg(bx) + 1; ++i) {
+		myfile << bx[i] << endl;
+	}
+	myfile << key.digitKeys.size() << endl;
+	for (const Key& digitKey : key.digitKeys) {
+		writeKeyEntry(myfile, digitKey, seeded, N);
+	}
+}
+
+/**
+ * @param[in] hasDigits: entry is followed by digit keys, false for files written before dnum was added
+ */
+static Key readKeyEntry(ifstream& myfile, bool seeded, bool hasDigits, long logq, long N) {
+	string line;
+	ZZX ax, bx;
+	unsigned char seed[SEED_BYTES];
+
+	getline(myfile, line);
+	if(seeded) {
+		seedFromHex(seed, line);
+	} else {
+		long axdeg = atol(line.c_str());
+		ax.SetLength(axdeg + 1);
+	}
+
+	getline(myfile, line);
+	long bxdeg = atol(line.c_str());
+	bx.SetLength(bxdeg + 1);
+	for(long j = 0; !seeded && j < deg(ax) + 1; j++) {
+		getline(myfile, line);
+		ax[j] = conv<ZZ>(line.c_str());
+	}
+	for(long j = 0; j < bxdeg + 1; j++) {
+		getline(myfile, line);
+		bx[j] = conv<ZZ>(line.c_str());
+	}
+	Key key(seeded ? FlatPoly() : FlatPoly(ax, logq, N), FlatPoly(bx, logq, N));
+	if(seeded) key.setSeed(seed, logq);
+	if(hasDigits) {
+		getline(myfile, line);
+		long digitNum = atol(line.c_str());
+		for (long j = 0; j < digitNum; ++j) {
+			key.digitKeys.push_back(readKeyEntry(myfile, seeded, hasDigits, logq, N));
+		}
+	}
+	return key;
+}
+
+/**
+ * whether key and its digit keys have ax expanded from seed
+ */
+static bool isSeededWithDigits(const Key& key) {
+	bool seeded = key.isSeeded;
+	for (const Key& digitKey : key.digitKeys) {
+		seeded = seeded && digitKey.isSeeded;
+	}
+	return seeded;
+}
+
 void SerializationUtils::writeSchemeKeys(Scheme& scheme, string path) {
+	bool seeded = true;
+	for (auto const& element : scheme.keyMap) {
+		seeded = seeded && isSeededWithDigits(element.second);
+	}
+	for (auto const& element : scheme.leftRotKeyMap) {
+		seeded = seeded && isSeededWithDigits(element.second);
+	}
 	ofstream myfile;
 	myfile.open(path);
-	myfile << "Keys" << endl;
+	myfile << (seeded ? "SeededKeysWithDigits" : "KeysWithDigits") << endl;
 	myfile << scheme.keyMap.size() << endl;
 	for (auto const& element : scheme.keyMap) {
 		myfile << element.first << endl;
-		myfile << deg(element.second.ax) << endl;
-		myfile << deg(element.second.bx) << endl;
-		for (long i = 0; i < deg(element.second.ax) + 1; ++i) {
-			myfile << element.second.ax[i] << endl;
-		}
-		for (long i = 0; i < deg(element.second.bx) + 1; ++i) {
-			myfile << element.second.bx[i] << endl;
-		}
+		writeKeyEntry(myfile, element.second, seeded, scheme.context.N);
 	}
 	myfile << "Left Rotation Keys" << endl;
 	myfile << scheme.leftRotKeyMap.size() << endl;
 	for (auto const& element : scheme.leftRotKeyMap) {
 		myfile << element.first << endl;
-		myfile << deg(element.second.ax) << endl;
-		myfile << deg(element.second.bx) << endl;
-		for (long i = 0; i < deg(element.second.ax) + 1; ++i) {
-			myfile << element.second.ax[i] << endl;
-		}
-		for (long i = 0; i < deg(element.second.bx) + 1; ++i) {
-			myfile << element.second.bx[i] << endl;
-		}
+		writeKeyEntry(myfile, element.second, seeded, scheme.context.N);
 	}
 	myfile.close();
 }
@@ -199,6 +330,8 @@ void SerializationUtils::readSchemeKeys(Scheme& scheme, string path) {
 		string line;
 		//Keys
 		getline(myfile, line);
+		bool seeded = line == "SeededKeys" || line == "SeededKeysWithDigits";
+		bool hasDigits = line == "KeysWithDigits" || line == "SeededKeysWithDigits";
 		//Num of Keys
 		getline(myfile, line);
 		long keyNum = atol(line.c_str());
@@ -206,24 +339,7 @@ void SerializationUtils::readSchemeKeys(Scheme& scheme, string path) {
 		for (long i = 0; i < keyNum; ++i) {
 			getline(myfile, line);
 			long keyID = atol(line.c_str());
-			ZZX ax, bx;
-
-			getline(myfile, line);
-			long axdeg = atol(line.c_str());
-			ax.SetLength(axdeg + 1);
-
-			getline(myfile, line);
-			long bxdeg = atol(line.c_str());
-			bx.SetLength(bxdeg + 1);
-			for(long j = 0; j < axdeg + 1; j++) {
-				getline(myfile, line);
-				ax[j] = conv<ZZ>(line.c_str());
-			}
-			for(long j = 0; j < bxdeg + 1; j++) {
-				getline(myfile, line);
-				bx[j] = conv<ZZ>(line.c_str());
-			}
-			scheme.keyMap.insert(pair<long, Key>(keyID, Key(ax, bx)));
+			scheme.keyMap.insert(pair<long, Key>(keyID, readKeyEntry(myfile, seeded, hasDigits, keyBits(scheme, keyID), scheme.context.N)));
 		}
 
 		getline(myfile, line);
@@ -234,25 +350,9 @@ void SerializationUtils::readSchemeKeys(Scheme& scheme, string path) {
 		for (long i = 0; i < leftRotKeyNum; ++i) {
 			getline(myfile, line);
 			long keyID = atol(line.c_str());
-			ZZX ax, bx;
-			getline(myfile, line);
-			long axdeg = atol(line.c_str());
-			ax.SetLength(axdeg + 1);
-
-			getline(myfile, line);
-			long bxdeg = atol(line.c_str());
-			bx.SetLength(bxdeg + 1);
-
-			for(long j = 0; j < axdeg + 1; j++) {
-				getline(myfile, line);
-				ax[j] = conv<ZZ>(line.c_str());
-			}
-			for(long j = 0; j < bxdeg + 1; j++) {
-				getline(myfile, line);
-				bx[j] = conv<ZZ>(line.c_str());
-			}
-			scheme.leftRotKeyMap.insert(pair<long, Key>(keyID, Key(ax, bx)));
+			scheme.leftRotKeyMap.insert(pair<long, Key>(keyID, readKeyEntry(myfile, seeded, hasDigits, scheme.context.logQP, scheme.context.N)));
 		}
+		scheme.transformKeys();
 		cout << scheme.context.N << endl;
 	} else {
 		throw std::invalid_argument("Unable to open file");
@@ -291,45 +391,540 @@ SecretKey SerializationUtils::readSecretKey(string path) {
 	}
 }
 
+/**
+ * key followed by the number of its digit keys and their lines
+ */
+static void writeKeyLines(ofstream& myfile, const Key& key) {
+	myfile << (key.isSeeded ? "SeededKey" : "Key") << endl;
+	ZZX ax, bx;
+	key.bx.toZZX(bx);
+	if(key.isSeeded) {
+		myfile << seedToHex(key.seed) << endl;
+		myfile << key.logq << endl;
+	} else {
+		key.ax.toZZX(ax);
+		myfile << deg(ax) << endl;
+	}
+	myfile << deg(bx) << endl;
+	for(long i = 0; !key.isSeeded && i < deg(ax) + 1; i++) {
+		myfile << ax[i] << endl;
+	}
+	for(long i = 0; i < deg(bx) + 1; i++) {
+		myfile << bx[i] << endl;
+	}
+	myfile << key.digitKeys.size() << endl;
+	for (const Key& digitKey : key.digitKeys) {
+		writeKeyLines(myfile, digitKey);
+	}
+}
+
+static Key readKeyLines(ifstream& myfile) {
+	ZZX ax, bx;
+	long temp, logq = 0;
+	string line;
+	getline(myfile, line);
+	bool seeded = line == "SeededKey";
+	unsigned char seed[SEED_BYTES];
+	getline(myfile, line);
+	if(seeded) {
+		seedFromHex(seed, line);
+		getline(myfile, line);
+		logq = atol(line.c_str());
+	} else {
+		temp = atol(line.c_str());
+		ax.SetLength(temp + 1);
+	}
+	getline(myfile, line);
+	temp = atol(line.c_str());
+	bx.SetLength(temp + 1);
+	for(long i = 0; !seeded && i < deg(ax) + 1; i++) {
+		getline(myfile, line);
+		ax[i] = conv<ZZ>(line.c_str());
+	}
+	for(long i = 0; i < deg(bx) + 1; i++) {
+		getline(myfile, line);
+		bx[i] = conv<ZZ>(line.c_str());
+	}
+	Key key(seeded ? FlatPoly() : FlatPoly(ax, deg(ax) + 1), seeded ? FlatPoly(bx, logq, deg(bx) + 1) : FlatPoly(bx, deg(bx) + 1));
+	if(seeded) key.setSeed(seed, logq);
+	//number of digit keys, missing in files written before dnum was added
+	long digitNum = getline(myfile, line) ? atol(line.c_str()) : 0;
+	for (long j = 0; j < digitNum; ++j) {
+		key.digitKeys.push_back(readKeyLines(myfile));
+	}
+	return key;
+}
+
 void SerializationUtils::writeKey(Key& key, string path) {
 	ofstream myfile;
 	myfile.open(path);
-	myfile << "Key" << endl;
-	myfile << deg(key.ax) << endl;
-	myfile << deg(key.bx) << endl;
-	for(long i = 0; i < deg(key.ax) + 1; i++) {
-		myfile << key.ax[i] << endl;
-	}
-	for(long i = 0; i < deg(key.bx) + 1; i++) {
-		myfile << key.bx[i] << endl;
-	}
+	writeKeyLines(myfile, key);
 	myfile.close();
 }
 
 Key SerializationUtils::readKey(string path) {
 	ifstream myfile(path);
 	if(myfile.is_open()) {
-		ZZX ax, bx;
-		long temp;
-		string line;
-		getline(myfile, line);
-		getline(myfile, line);
-		temp = atol(line.c_str());
-		ax.SetLength(temp + 1);
-		getline(myfile, line);
-		temp = atol(line.c_str());
-		bx.SetLength(temp + 1);
-		for(long i = 0; i < deg(ax) + 1; i++) {
-			getline(myfile, line);
-			ax[i] = conv<ZZ>(line.c_str());
+		Key key = readKeyLines(myfile);
+		myfile.close();
+		return key;
+	} else {
+		throw std::invalid_argument("Unable to open file");
+	}
+}
+
+//----------------------------------------------------------------------------------
+//   BINARY FORMAT
+//----------------------------------------------------------------------------------
+
+
+/**
+ * version of all binary records, raised whenever a record layout changes
+ * 2: coefficients of BootContext records take (bits + 8) / 8 bytes each
+ * 3: Context records hold dnum, key records are followed by their digit keys
+ */
+static const int64_t BINARY_VERSION = 3;
+
+static void writeInt(ostream& out, int64_t x) {
+	unsigned char bytes[8];
+	for (long i = 0; i < 8; ++i) {
+		bytes[i] = (unsigned char) ((uint64_t) x >> (8 * i));
+	}
+	out.write((const char*) bytes, 8);
+}
+
+static int64_t readInt(istream& in) {
+	unsigned char bytes[8];
+	if(!in.read((char*) bytes, 8)) {
+		throw std::invalid_argument("Unexpected end of binary data");
+	}
+	uint64_t x = 0;
+	for (long i = 0; i < 8; ++i) {
+		x |= (uint64_t) bytes[i] << (8 * i);
+	}
+	return (int64_t) x;
+}
+
+static void readBytes(istream& in, unsigned char* bytes, long size) {
+	if(!in.read((char*) bytes, size)) {
+		throw std::invalid_argument("Unexpected end of binary data");
+	}
+}
+
+/**
+ * 4-byte magic of the record type followed by the format version
+ */
+static void writeHeader(ostream& out, const char* magic) {
+	out.write(magic, 4);
+	writeInt(out, BINARY_VERSION);
+}
+
+static void readHeader(istream& in, const char* magic) {
+	char bytes[4];
+	readBytes(in, (unsigned char*) bytes, 4);
+	if(!equal(bytes, bytes + 4, magic)) {
+		throw std::invalid_argument("Unexpected binary record type");
+	}
+	if(readInt(in) != BINARY_VERSION) {
+		throw std::invalid_argument("Unsupported binary format version");
+	}
+}
+
+static long logOf(long N) {
+	long logN = 0;
+	while((1L << logN) < N) logN++;
+	return logN;
+}
+
+/**
+ * coefficients mod 2^bits, ceil(bits / 8) little-endian bytes each
+ */
+static void writePoly(ostream& out, const FlatPoly& p, long bits) {
+	long size = (bits + 7) / 8;
+	writeInt(out, bits);
+	unsigned char* bytes = new unsigned char[p.N * size];
+	for (long n = 0; n < p.N; ++n) {
+		const uint64_t* c = p.coeff(n);
+		unsigned char* b = bytes + n * size;
+		for (long i = 0; i < size; ++i) {
+			b[i] = (i >> 3) < p.limbs ? (unsigned char) (c[i >> 3] >> (8 * (i & 7))) : 0;
 		}
-		for(long i = 0; i < deg(bx) + 1; i++) {
-			getline(myfile, line);
-			bx[i] = conv<ZZ>(line.c_str());
+		if(bits & 7) b[size - 1] &= (1 << (bits & 7)) - 1;
+	}
+	out.write((const char*) bytes, p.N * size);
+	delete[] bytes;
+}
+
+static void readPoly(istream& in, FlatPoly& p, long N) {
+	long bits = readInt(in);
+	long size = (bits + 7) / 8;
+	p = FlatPoly(N, limbsFor(bits));
+	unsigned char* bytes = new unsigned char[N * size];
+	try {
+		readBytes(in, bytes, N * size);
+	} catch(...) {
+		delete[] bytes;
+		throw;
+	}
+	for (long n = 0; n < N; ++n) {
+		uint64_t* c = p.coeff(n);
+		const unsigned char* b = bytes + n * size;
+		for (long i = 0; i < size; ++i) {
+			c[i >> 3] |= (uint64_t) b[i] << (8 * (i & 7));
 		}
-		myfile.close();
-		return Key(ax, bx);
+	}
+	delete[] bytes;
+}
+
+/**
+ * key followed by the number of its digit keys and their records
+ */
+static void writeKeyRecord(ostream& out, const Key& key, long logq) {
+	if(key.isSeeded) logq = key.logq;
+	writeInt(out, logOf(key.bx.N));
+	writeInt(out, logq);
+	writeInt(out, key.isSeeded);
+	if(key.isSeeded) {
+		out.write((const char*) key.seed, SEED_BYTES);
 	} else {
+		writePoly(out, key.ax, logq);
+	}
+	writePoly(out, key.bx, logq);
+	writeInt(out, key.digitKeys.size());
+	for (const Key& digitKey : key.digitKeys) {
+		writeKeyRecord(out, digitKey, logq);
+	}
+}
+
+static Key readKeyRecord(istream& in) {
+	long N = 1L << readInt(in);
+	long logq = readInt(in);
+	bool seeded = readInt(in);
+	unsigned char seed[SEED_BYTES];
+	FlatPoly ax, bx;
+	if(seeded) {
+		readBytes(in, seed, SEED_BYTES);
+	} else {
+		readPoly(in, ax, N);
+	}
+	readPoly(in, bx, N);
+	Key key(move(ax), move(bx));
+	if(seeded) key.setSeed(seed, logq);
+	long digitNum = readInt(in);
+	if(digitNum < 0) {
+		throw std::invalid_argument("Negative number of digit keys");
+	}
+	for (long j = 0; j < digitNum; ++j) {
+		key.digitKeys.push_back(readKeyRecord(in));
+	}
+	return key;
+}
+
+void SerializationUtils::writeCiphertextBinary(Ciphertext& cipher, ostream& out) {
+	bool seeded = cipher.hasValidSeed();
+	writeHeader(out, "HECT");
+	writeInt(out, logOf(cipher.bx.N));
+	writeInt(out, cipher.logp);
+	writeInt(out, cipher.logq);
+	writeInt(out, cipher.slots);
+	writeInt(out, cipher.isComplex);
+	writeInt(out, seeded);
+	if(seeded) {
+		out.write((const char*) cipher.seed, SEED_BYTES);
+	} else {
+		writePoly(out, cipher.ax, cipher.logq);
+	}
+	writePoly(out, cipher.bx, cipher.logq);
+}
+
+Ciphertext SerializationUtils::readCiphertextBinary(istream& in) {
+	readHeader(in, "HECT");
+	long N = 1L << readInt(in);
+	long logp = readInt(in);
+	long logq = readInt(in);
+	long slots = readInt(in);
+	bool isComplex = readInt(in);
+	bool seeded = readInt(in);
+	unsigned char seed[SEED_BYTES];
+	FlatPoly ax, bx;
+	if(seeded) {
+		readBytes(in, seed, SEED_BYTES);
+		NumUtils::sampleUniform2(ax, seed, N, logq);
+	} else {
+		readPoly(in, ax, N);
+	}
+	readPoly(in, bx, N);
+	Ciphertext cipher(move(ax), move(bx), logp, logq, slots, isComplex);
+	if(seeded) cipher.setSeed(seed);
+	return cipher;
+}
+
+void SerializationUtils::writePlaintextBinary(Plaintext& msg, ostream& out) {
+	writeHeader(out, "HEPT");
+	writeInt(out, logOf(msg.mx.N));
+	writeInt(out, msg.logp);
+	writeInt(out, msg.logq);
+	writeInt(out, msg.slots);
+	writeInt(out, msg.isComplex);
+	writePoly(out, msg.mx, 64 * msg.mx.limbs);
+}
+
+Plaintext SerializationUtils::readPlaintextBinary(istream& in) {
+	readHeader(in, "HEPT");
+	long N = 1L << readInt(in);
+	long logp = readInt(in);
+	long logq = readInt(in);
+	long slots = readInt(in);
+	bool isComplex = readInt(in);
+	FlatPoly mx;
+	readPoly(in, mx, N);
+	return Plaintext(move(mx), logp, logq, slots, isComplex);
+}
+
+void SerializationUtils::writeContextBinary(Context& context, ostream& out) {
+	writeHeader(out, "HECX");
+	writeInt(out, context.logN);
+	writeInt(out, context.logQ);
+	int64_t sigma;
+	memcpy(&sigma, &context.sigma, 8);
+	writeInt(out, sigma);
+	writeInt(out, context.h);
+	writeInt(out, context.dnum);
+	writeInt(out, context.bootContextMap.size());
+	for (auto const& element : context.bootContextMap) {
+		writeInt(out, element.first);
+		writeInt(out, element.second.logp);
+	}
+}
+
+Context SerializationUtils::readContextBinary(istream& in) {
+	readHeader(in, "HECX");
+	long logN = readInt(in);
+	long logQ = readInt(in);
+	int64_t sigmaBits = readInt(in);
+	double sigma;
+	memcpy(&sigma, &sigmaBits, 8);
+	long h = readInt(in);
+	long dnum = readInt(in);
+	Context context(logN, logQ, sigma, h, dnum);
+	long bootsize = readInt(in);
+	for (long i = 0; i < bootsize; ++i) {
+		long logSlots = readInt(in);
+		long logp = readInt(in);
+		context.addBootContext(logSlots, logp);
+	}
+	return context;
+}
+
+void SerializationUtils::writeSchemeKeysBinary(Scheme& scheme, ostream& out) {
+	writeHeader(out, "HEKS");
+	writeInt(out, scheme.keyMap.size());
+	for (auto const& element : scheme.keyMap) {
+		writeInt(out, element.first);
+		writeKeyRecord(out, element.second, keyBits(scheme, element.first));
+	}
+	writeInt(out, scheme.leftRotKeyMap.size());
+	for (auto const& element : scheme.leftRotKeyMap) {
+		writeInt(out, element.first);
+		writeKeyRecord(out, element.second, scheme.context.logQP);
+	}
+}
+
+void SerializationUtils::readSchemeKeysBinary(Scheme& scheme, istream& in) {
+	readHeader(in, "HEKS");
+	long keyNum = readInt(in);
+	for (long i = 0; i < keyNum; ++i) {
+		long keyID = readInt(in);
+		scheme.keyMap.insert(pair<long, Key>(keyID, readKeyRecord(in)));
+	}
+	long leftRotKeyNum = readInt(in);
+	for (long i = 0; i < leftRotKeyNum; ++i) {
+		long keyID = readInt(in);
+		scheme.leftRotKeyMap.insert(pair<long, Key>(keyID, readKeyRecord(in)));
+	}
+	scheme.transformKeys();
+}
+
+void SerializationUtils::writeKeyBinary(Key& key, long logq, ostream& out) {
+	writeHeader(out, "HEKY");
+	writeKeyRecord(out, key, logq);
+}
+
+Key SerializationUtils::readKeyBinary(istream& in) {
+	readHeader(in, "HEKY");
+	return readKeyRecord(in);
+}
+
+void SerializationUtils::writeRotationKeyStore(Scheme& scheme, string path) {
+	ofstream out(path, ios::binary);
+	if(!out.is_open()) {
 		throw std::invalid_argument("Unable to open file");
 	}
+	writeHeader(out, "HERK");
+	writeInt(out, scheme.leftRotKeyMap.size());
+	streampos indexPos = out.tellp();
+	for (long i = 0; i < (long) scheme.leftRotKeyMap.size(); ++i) {
+		writeInt(out, 0);
+		writeInt(out, 0);
+	}
+	vector<pair<long, long>> offsets;
+	for (auto& element : scheme.leftRotKeyMap) {
+		offsets.push_back(make_pair(element.first, (long) out.tellp()));
+		writeKeyBinary(element.second, scheme.context.logQP, out);
+	}
+	out.seekp(indexPos);
+	for (auto const& offset : offsets) {
+		writeInt(out, offset.first);
+		writeInt(out, offset.second);
+	}
+	out.close();
+}
+
+map<long, long> SerializationUtils::readRotationKeyIndex(istream& in) {
+	readHeader(in, "HERK");
+	map<long, long> index;
+	long keyNum = readInt(in);
+	for (long i = 0; i < keyNum; ++i) {
+		long rot = readInt(in);
+		index[rot] = readInt(in);
+	}
+	return index;
+}
+
+/**
+ * coefficients as (bits + 8) / 8 little-endian bytes each in two's complement
+ */
+static void writeSmallPoly(ostream& out, const SmallPoly& p) {
+	long size = (p.bits + 8) / 8;
+	writeInt(out, p.bits);
+	unsigned char* bytes = new unsigned char[p.N * size];
+	for (long n = 0; n < p.N; ++n) {
+		uint64_t c = (uint64_t) p.coeffs[n];
+		for (long i = 0; i < size; ++i) {
+			bytes[n * size + i] = (unsigned char) (c >> (8 * i));
+		}
+	}
+	out.write((const char*) bytes, p.N * size);
+	delete[] bytes;
+}
+
+static void readSmallPoly(istream& in, SmallPoly& p, long N) {
+	long bits = readInt(in);
+	if(bits < 0 || bits > 63) {
+		throw std::invalid_argument("Coefficients of small polynomial must be below 2^63");
+	}
+	long size = (bits + 8) / 8;
+	p = SmallPoly(N);
+	p.bits = bits;
+	unsigned char* bytes = new unsigned char[N * size];
+	try {
+		readBytes(in, bytes, N * size);
+	} catch(...) {
+		delete[] bytes;
+		throw;
+	}
+	for (long n = 0; n < N; ++n) {
+		uint64_t c = 0;
+		for (long i = 0; i < size; ++i) {
+			c |= (uint64_t) bytes[n * size + i] << (8 * i);
+		}
+		long shift = 64 - 8 * size;
+		p.coeffs[n] = shift ? ((int64_t) (c << shift)) >> shift : (int64_t) c;
+	}
+	delete[] bytes;
+}
+
+/**
+ * FNV-1a over little-endian bytes of coefficients
+ */
+static uint64_t hashPoly(uint64_t hash, const SmallPoly& p) {
+	for (long n = 0; n < p.N; ++n) {
+		uint64_t c = (uint64_t) p.coeffs[n];
+		for (long j = 0; j < 8; ++j) {
+			hash = (hash ^ ((c >> (8 * j)) & 0xff)) * 0x100000001b3ULL;
+		}
+	}
+	return hash;
+}
+
+static uint64_t hashBootContext(const BootContext& bootContext, long slots) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (long i = 0; i < slots; ++i) {
+		hash = hashPoly(hash, bootContext.pvec[i]);
+		hash = hashPoly(hash, bootContext.pvecInv[i]);
+	}
+	hash = hashPoly(hash, bootContext.p1);
+	return hashPoly(hash, bootContext.p2);
+}
+
+void SerializationUtils::writeBootContextBinary(Context& context, long logSlots, ostream& out) {
+	BootContext& bootContext = context.bootContextMap.at(logSlots);
+	long slots = 1 << logSlots;
+	writeHeader(out, "HEBC");
+	writeInt(out, context.logN);
+	writeInt(out, logSlots);
+	writeInt(out, bootContext.logp);
+	writeInt(out, hashBootContext(bootContext, slots));
+	for (long i = 0; i < slots; ++i) {
+		writeSmallPoly(out, bootContext.pvec[i]);
+		writeSmallPoly(out, bootContext.pvecInv[i]);
+	}
+	writeSmallPoly(out, bootContext.p1);
+	writeSmallPoly(out, bootContext.p2);
+}
+
+long SerializationUtils::readBootContextBinary(Context& context, istream& in, long logp) {
+	readHeader(in, "HEBC");
+	long logN = readInt(in);
+	long logSlots = readInt(in);
+	long storedLogp = readInt(in);
+	uint64_t hash = readInt(in);
+	if(logN != context.logN || logSlots < 0 || logSlots > context.logNh || (logp >= 0 && storedLogp != logp)) {
+		throw std::invalid_argument("BootContext was computed for other parameters");
+	}
+	long slots = 1 << logSlots;
+	SmallPoly* pvec = new SmallPoly[slots];
+	SmallPoly* pvecInv = new SmallPoly[slots];
+	BootContext bootContext(pvec, pvecInv, SmallPoly(), SmallPoly(), storedLogp);
+	try {
+		for (long i = 0; i < slots; ++i) {
+			readSmallPoly(in, pvec[i], context.N);
+			readSmallPoly(in, pvecInv[i], context.N);
+		}
+		readSmallPoly(in, bootContext.p1, context.N);
+		readSmallPoly(in, bootContext.p2, context.N);
+		if(hashBootContext(bootContext, slots) != hash) {
+			throw std::invalid_argument("BootContext hash does not match");
+		}
+	} catch(...) {
+		delete[] pvec;
+		delete[] pvecInv;
+		throw;
+	}
+	if(context.bootContextMap.find(logSlots) != context.bootContextMap.end()) {
+		delete[] pvec;
+		delete[] pvecInv;
+	} else {
+		context.bootContextMap.insert(pair<long, BootContext>(logSlots, bootContext));
+	}
+	return logSlots;
+}
+
+void SerializationUtils::addBootContextCached(Context& context, long logSlots, long logp, string dir) {
+	if(context.bootContextMap.find(logSlots) != context.bootContextMap.end()) return;
+	string path = dir + "/BootContext_" + to_string(context.logN) + "_" + to_string(logSlots) + "_" + to_string(logp) + ".bin";
+	ifstream in(path, ios::binary);
+	if(in.is_open()) {
+		try {
+			if(readBootContextBinary(context, in, logp) == logSlots) return;
+		} catch(std::invalid_argument&) {
+			// stale or damaged cache, recomputed below
+		}
+	}
+	in.close();
+	context.addBootContext(logSlots, logp);
+	ofstream out(path, ios::binary);
+	if(out.is_open()) {
+		writeBootContextBinary(context, logSlots, out);
+	}
 }
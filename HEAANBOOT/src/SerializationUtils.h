@@ -9,6 +9,7 @@
 #define HEAAN_SERIALIZATIONUTILS_H_
 
 #include <iostream>
+#include <map>
 
 #include "Ciphertext.h"
 #include "Plaintext.h"
@@ -22,6 +23,9 @@ using namespace NTL;
 class SerializationUtils {
 public:
 
+	/**
+	 * writes ciphertext, with ax replaced by its seed if it is still the expansion of the seed
+	 */
 	static void writeCiphertext(Ciphertext& ciphertext, string path);
 	static Ciphertext readCiphertext(string path);
 
@@ -31,6 +35,10 @@ public:
 	static void writeContext(Context& context, string path);
 	static Context readContext(string path);
 
+	/**
+	 * writes switching keys with their digit keys, with ax replaced by its seed if all keys are seeded
+	 * @throws invalid_argument on reading keys generated for other dnum
+	 */
 	static void writeSchemeKeys(Scheme& scheme, string path);
 	static void readSchemeKeys(Scheme& scheme, string path);
 
@@ -39,6 +47,76 @@ public:
 
 	static void writeKey(Key& key, string path);
 	static Key readKey(string path);
+
+	//----------------------------------------------------------------------------------
+	//   BINARY FORMAT
+	//----------------------------------------------------------------------------------
+
+	/*
+	 * Versioned binary records: 4-byte magic of the record type, format version, header fields
+	 * as little-endian 64-bit integers, then each polynomial as its coefficient width in bits
+	 * followed by exactly ceil(bits / 8) little-endian bytes per coefficient.
+	 * Streams may be files opened with ios::binary or stringstreams over in-memory buffers;
+	 * reading throws invalid_argument on a wrong record type, version or truncated data.
+	 */
+
+	/**
+	 * writes ciphertext, with ax replaced by its seed if it is still the expansion of the seed
+	 */
+	static void writeCiphertextBinary(Ciphertext& cipher, ostream& out);
+	static Ciphertext readCiphertextBinary(istream& in);
+
+	static void writePlaintextBinary(Plaintext& msg, ostream& out);
+	static Plaintext readPlaintextBinary(istream& in);
+
+	static void writeContextBinary(Context& context, ostream& out);
+	static Context readContextBinary(istream& in);
+
+	/**
+	 * writes encoded diagonals of bootContextMap.at(logSlots), keyed by (logN, logSlots, logp)
+	 * and with a hash of their contents
+	 */
+	static void writeBootContextBinary(Context& context, long logSlots, ostream& out);
+
+	/**
+	 * restores BootContext into context.bootContextMap without recomputation
+	 * @param[in] logp: expected number of quantized bits, -1 for any
+	 * @return logSlots of BootContext
+	 * @throws invalid_argument if it was written for other parameters or its hash does not match
+	 */
+	static long readBootContextBinary(Context& context, istream& in, long logp = -1);
+
+	/**
+	 * Context::addBootContext through a file cache in dir: a valid cached BootContext for
+	 * (logN, logSlots, logp) is read, a missing or stale one is recomputed and rewritten
+	 */
+	static void addBootContextCached(Context& context, long logSlots, long logp, string dir);
+
+	/**
+	 * writes switching keys with their digit keys, seeded keys as seed and bx
+	 * @throws invalid_argument on reading keys generated for other dnum
+	 */
+	static void writeSchemeKeysBinary(Scheme& scheme, ostream& out);
+	static void readSchemeKeysBinary(Scheme& scheme, istream& in);
+
+	/**
+	 * @param[in] key: key, seeded key is written as seed and bx
+	 * @param[in] logq: bits of key coefficients, e.g. logQQ for encryption key and logQP for switching keys of Scheme
+	 * @param[in, out] out: binary stream
+	 */
+	static void writeKeyBinary(Key& key, long logq, ostream& out);
+	static Key readKeyBinary(istream& in);
+
+	/**
+	 * writes left rotation keys as index of file offsets by rotation amount followed by
+	 * binary key records, to be mapped by RotationKeyStore
+	 */
+	static void writeRotationKeyStore(Scheme& scheme, string path);
+
+	/**
+	 * @return file offset of key record by rotation amount
+	 */
+	static map<long, long> readRotationKeyIndex(istream& in);
 };
 
 #endif /* SERIALIZATIONUTILS_H_ */
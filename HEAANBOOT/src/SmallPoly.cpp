@@ -0,0 +1,66 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "SmallPoly.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+SmallPoly::SmallPoly(long N) : N(N), bits(0), coeffs(N ? new int64_t[N]() : NULL) {}
+
+SmallPoly::SmallPoly(ZZX& p, const long N) : N(N), bits(0), coeffs(new int64_t[N]()) {
+	long len = min(N, p.rep.length());
+	for (long n = 0; n < len; ++n) {
+		long nbits = NumBits(p.rep[n]);
+		if(nbits > 63) {
+			delete[] coeffs;
+			throw invalid_argument("coefficients of small polynomial must be below 2^63");
+		}
+		bits = max(bits, nbits);
+		coeffs[n] = conv<long>(p.rep[n]);
+	}
+}
+
+SmallPoly::SmallPoly(const SmallPoly& o) : N(o.N), bits(o.bits), coeffs(o.N ? new int64_t[o.N] : NULL) {
+	copy(o.coeffs, o.coeffs + N, coeffs);
+}
+
+SmallPoly::SmallPoly(SmallPoly&& o) : N(o.N), bits(o.bits), coeffs(o.coeffs) {
+	o.N = 0;
+	o.bits = 0;
+	o.coeffs = NULL;
+}
+
+SmallPoly& SmallPoly::operator=(const SmallPoly& o) {
+	if(this == &o) return *this;
+	delete[] coeffs;
+	N = o.N;
+	bits = o.bits;
+	coeffs = N ? new int64_t[N] : NULL;
+	copy(o.coeffs, o.coeffs + N, coeffs);
+	return *this;
+}
+
+SmallPoly& SmallPoly::operator=(SmallPoly&& o) {
+	if(this == &o) return *this;
+	delete[] coeffs;
+	N = o.N;
+	bits = o.bits;
+	coeffs = o.coeffs;
+	o.N = 0;
+	o.bits = 0;
+	o.coeffs = NULL;
+	return *this;
+}
+
+SmallPoly::~SmallPoly() {
+	delete[] coeffs;
+}
+
+bool SmallPoly::operator==(const SmallPoly& o) const {
+	return N == o.N && equal(coeffs, coeffs + N, o.coeffs);
+}
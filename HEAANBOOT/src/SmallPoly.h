@@ -0,0 +1,57 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_SMALLPOLY_H_
+#define HEAAN_SMALLPOLY_H_
+
+#include <NTL/ZZX.h>
+#include <cstdint>
+
+using namespace std;
+using namespace NTL;
+
+/**
+ * Polynomial in Z[X] / (X^N + 1) with signed coefficients below 2^63 in absolute value,
+ * one int64_t each, e.g. encoded diagonals of BootContext and other plaintext multiplicands.
+ * Its residues are single reductions, and it bounds the number of ntt primes of a product
+ * by bits instead of a scan (see Scheme::multByPoly).
+ */
+class SmallPoly {
+public:
+
+	long N; ///< ring degree
+	long bits; ///< maximal bit size of absolute values of coefficients
+	int64_t* coeffs; ///< N coefficients
+
+	SmallPoly(long N = 0);
+
+	/**
+	 * @param[in] p: polynomial of degree less than N
+	 * @param[in] N: ring degree
+	 * @throws invalid_argument if a coefficient has 64 bits or more
+	 */
+	SmallPoly(ZZX& p, const long N);
+
+	SmallPoly(const SmallPoly& o);
+
+	SmallPoly(SmallPoly&& o);
+
+	SmallPoly& operator=(const SmallPoly& o);
+
+	SmallPoly& operator=(SmallPoly&& o);
+
+	~SmallPoly();
+
+	bool operator==(const SmallPoly& o) const;
+
+	bool operator!=(const SmallPoly& o) const {
+		return !(*this == o);
+	}
+
+};
+
+#endif
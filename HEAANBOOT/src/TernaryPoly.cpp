@@ -0,0 +1,50 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#include "TernaryPoly.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+TernaryPoly::TernaryPoly(ZZX& p) : h(0), hplus(0), idx(NULL) {
+	long len = p.rep.length();
+	for (long n = 0; n < len; ++n) {
+		if(p.rep[n] == 1) {
+			hplus++;
+		} else if(p.rep[n] != 0 && p.rep[n] != -1) {
+			throw invalid_argument("coefficients of ternary polynomial must be in {-1, 0, 1}");
+		}
+		if(p.rep[n] != 0) h++;
+	}
+	idx = new long[h];
+	long kplus = 0, kminus = hplus;
+	for (long n = 0; n < len; ++n) {
+		if(p.rep[n] == 1) {
+			idx[kplus++] = n;
+		} else if(p.rep[n] == -1) {
+			idx[kminus++] = n;
+		}
+	}
+}
+
+TernaryPoly::TernaryPoly(const TernaryPoly& o) : h(o.h), hplus(o.hplus), idx(new long[o.h]) {
+	copy(o.idx, o.idx + h, idx);
+}
+
+TernaryPoly& TernaryPoly::operator=(const TernaryPoly& o) {
+	if(this == &o) return *this;
+	delete[] idx;
+	h = o.h;
+	hplus = o.hplus;
+	idx = new long[h];
+	copy(o.idx, o.idx + h, idx);
+	return *this;
+}
+
+TernaryPoly::~TernaryPoly() {
+	delete[] idx;
+}
@@ -0,0 +1,43 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_TERNARYPOLY_H_
+#define HEAAN_TERNARYPOLY_H_
+
+#include <NTL/ZZX.h>
+
+using namespace std;
+using namespace NTL;
+
+/**
+ * Sparse polynomial with coefficients in {-1, 0, 1}, stored as the indices of its nonzero
+ * coefficients: idx[0], ..., idx[hplus - 1] hold +1 and idx[hplus], ..., idx[h - 1] hold -1.
+ * Multiplication by it is h signed shifted additions (see Ring2Utils::mult),
+ * which is much cheaper than a full ring multiplication for a small hamming weight h.
+ */
+class TernaryPoly {
+public:
+
+	long h; ///< number of nonzero coefficients
+	long hplus; ///< number of coefficients equal to 1
+	long* idx; ///< indices of nonzero coefficients
+
+	/**
+	 * @param[in] p: polynomial with coefficients in {-1, 0, 1}
+	 * @throws invalid_argument if p has other coefficients
+	 */
+	TernaryPoly(ZZX& p);
+
+	TernaryPoly(const TernaryPoly& o);
+
+	TernaryPoly& operator=(const TernaryPoly& o);
+
+	~TernaryPoly();
+
+};
+
+#endif
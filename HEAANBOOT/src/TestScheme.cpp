@@ -6,6 +6,8 @@
 * work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
 */
 #include "TestScheme.h"
+#include <fstream>
+#include <sstream>
 
 #include <NTL/BasicThreadPool.h>
 #include <NTL/RR.h>
@@ -15,6 +17,11 @@
 #include "Ciphertext.h"
 #include "EvaluatorUtils.h"
 #include "NumUtils.h"
+#include "RNSCiphertext.h"
+#include "RNSContext.h"
+#include "RNSScheme.h"
+#include "Ring2Utils.h"
+#include "Sampler.h"
 #include "Scheme.h"
 #include "SchemeAlgo.h"
 #include "SecretKey.h"
@@ -58,6 +65,201 @@ void TestScheme::testEncodeBatch(long logN, long logQ, long logp, long logSlots)
 	cout << "!!! END TEST ENCODE BATCH !!!" << endl;
 }
 
+void TestScheme::testEncryptionPool(long logN, long logQ, long logp, long logSlots, long poolSize, long poolThreads) {
+	cout << "!!! START TEST ENCRYPTION POOL !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Context context(logN, logQ);
+	SecretKey secretKey(logN);
+	Scheme scheme(secretKey, context);
+	//-----------------------------------------
+	srand(time(NULL));
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	complex<double>* mvec = EvaluatorUtils::randomComplexArray(slots);
+
+	timeutils.start("Encrypt batch");
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logp, logQ);
+	timeutils.stop("Encrypt batch");
+
+	timeutils.start("Fill pool");
+	scheme.startEncryptionPool(poolSize, poolThreads);
+	while(scheme.encPool->available() < poolSize) {
+		this_thread::yield();
+	}
+	timeutils.stop("Fill pool");
+
+	timeutils.start("Encrypt batch from pool");
+	Ciphertext pooled = scheme.encrypt(mvec, slots, logp, logQ);
+	timeutils.stop("Encrypt batch from pool");
+
+	scheme.stopEncryptionPool();
+
+	complex<double>* dvec = scheme.decrypt(secretKey, pooled);
+
+	StringUtils::showcompare(mvec, dvec, slots, "val");
+
+	cout << "!!! END TEST ENCRYPTION POOL !!!" << endl;
+}
+
+void TestScheme::testEncodeMany(long logN, long logQ, long logp, long logSlots, long count, long numThreads) {
+	cout << "!!! START TEST ENCODE MANY !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Context context(logN, logQ);
+	SecretKey secretKey(logN);
+	Scheme scheme(secretKey, context);
+	//-----------------------------------------
+	SetNumThreads(numThreads);
+	//-----------------------------------------
+	srand(time(NULL));
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	complex<double>** mvecs = new complex<double>*[count];
+	complex<double>** dvecs = new complex<double>*[count];
+	for (long k = 0; k < count; ++k) {
+		mvecs[k] = EvaluatorUtils::randomComplexArray(slots);
+		dvecs[k] = new complex<double>[slots];
+	}
+	Plaintext* msgs = new Plaintext[count];
+
+	timeutils.start("Encode one at a time");
+	for (long k = 0; k < count; ++k) {
+		msgs[k] = scheme.encode(mvecs[k], slots, logp, logQ);
+	}
+	timeutils.stop("Encode one at a time");
+
+	timeutils.start("Encode many");
+	scheme.encodeBatch(msgs, mvecs, count, slots, logp, logQ);
+	timeutils.stop("Encode many");
+
+	for (long k = 0; k < count; ++k) {
+		Ciphertext cipher = scheme.encryptMsg(msgs[k]);
+		msgs[k] = scheme.decryptMsg(secretKey, cipher);
+	}
+
+	timeutils.start("Decode one at a time");
+	for (long k = 0; k < count; ++k) {
+		complex<double>* dvec = scheme.decode(msgs[k]);
+		delete[] dvec;
+	}
+	timeutils.stop("Decode one at a time");
+
+	timeutils.start("Decode many");
+	scheme.decodeBatch(dvecs, msgs, count);
+	timeutils.stop("Decode many");
+
+	double err = 0;
+	for (long k = 0; k < count; ++k) {
+		for (long i = 0; i < slots; ++i) {
+			err = max(err, abs(mvecs[k][i] - dvecs[k][i]));
+		}
+	}
+	cout << "max error: " << err << endl;
+
+	for (long k = 0; k < count; ++k) {
+		delete[] mvecs[k];
+		delete[] dvecs[k];
+	}
+	delete[] mvecs;
+	delete[] dvecs;
+	delete[] msgs;
+
+	cout << "!!! END TEST ENCODE MANY !!!" << endl;
+}
+
+void TestScheme::testSampler(long logN, long logQ, long numThreads) {
+	cout << "!!! START TEST SAMPLER !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Context context(logN, logQ);
+	//-----------------------------------------
+	SetNumThreads(numThreads);
+	//-----------------------------------------
+	unsigned char seed[SAMPLER_SEED_BYTES] = {0};
+	Sampler::setMasterSeed(seed);
+	//-----------------------------------------
+	ZZX ex, vx;
+	FlatPoly fex, fax;
+
+	timeutils.start("Gauss");
+	NumUtils::sampleGauss(fex, context.N, context.sigma, context.logQQ);
+	timeutils.stop("Gauss");
+
+	timeutils.start("ZO");
+	NumUtils::sampleZO(vx, context.N);
+	timeutils.stop("ZO");
+
+	timeutils.start("HWT");
+	NumUtils::sampleHWT(vx, context.N, context.h);
+	timeutils.stop("HWT");
+
+	timeutils.start("Uniform");
+	Sampler::local().sampleUniform2(fax, context.N, context.logQQ);
+	timeutils.stop("Uniform");
+
+	NumUtils::sampleGauss(ex, context.N, context.sigma);
+	double mean = 0, var = 0;
+	for (long i = 0; i < context.N; ++i) {
+		double x = to_double(ex.rep[i]);
+		mean += x;
+		var += x * x;
+	}
+	mean /= context.N;
+	var = var / context.N - mean * mean;
+	cout << "Gauss mean: " << mean << ", stdev: " << sqrt(var) << " (sigma = " << context.sigma << ")" << endl;
+
+	Sampler::setMasterSeed(seed);
+	FlatPoly again;
+	NumUtils::sampleGauss(again, context.N, context.sigma, context.logQQ);
+	cout << "same master seed gives same samples: " << (again == fex ? "yes" : "no") << endl;
+
+	FlatPoly* polys = new FlatPoly[numThreads];
+	timeutils.start("Gauss on each thread");
+	NTL_EXEC_RANGE(numThreads, first, last);
+	for (long j = first; j < last; ++j) {
+		NumUtils::sampleGauss(polys[j], context.N, context.sigma, context.logQQ);
+	}
+	NTL_EXEC_RANGE_END;
+	timeutils.stop("Gauss on each thread");
+	delete[] polys;
+
+	cout << "!!! END TEST SAMPLER !!!" << endl;
+}
+
+void TestScheme::testEncryptSymmetric(long logN, long logQ, long logp, long logSlots) {
+	cout << "!!! START TEST ENCRYPT SYMMETRIC !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Context context(logN, logQ);
+	SecretKey secretKey(logN);
+	Scheme scheme(secretKey, context);
+	//-----------------------------------------
+	srand(time(NULL));
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	complex<double>* mvec = EvaluatorUtils::randomComplexArray(slots);
+
+	Plaintext msg = scheme.encode(mvec, slots, logp, logQ);
+	timeutils.start("Encrypt symmetric batch");
+	Ciphertext cipher = scheme.encryptSymmetric(secretKey, msg);
+	timeutils.stop("Encrypt symmetric batch");
+
+	string cipherPath = "testSeededCiphertext.txt";
+	SerializationUtils::writeCiphertext(cipher, cipherPath);
+	Ciphertext newcipher = SerializationUtils::readCiphertext(cipherPath);
+
+	if(newcipher.ax != cipher.ax || newcipher.bx != cipher.bx || !newcipher.isSeeded) {
+		cerr << "Write and Read for seeded ciphertext does not work" << endl;
+	}
+
+	complex<double>* dvec = scheme.decrypt(secretKey, newcipher);
+
+	StringUtils::showcompare(mvec, dvec, slots, "val");
+
+	cout << "!!! END TEST ENCRYPT SYMMETRIC !!!" << endl;
+}
+
 void TestScheme::testEncodeSingle(long logN, long logQ, long logp) {
 	cout << "!!! START TEST ENCODE SINGLE !!!" << endl;
 	//-----------------------------------------
@@ -139,6 +341,71 @@ void TestScheme::testBasic(long logN, long logQ, long logp, long logSlots) {
 	StringUtils::showcompare(mvecCMult, dvecCMult, slots, "mult");
 }
 
+void TestScheme::testKeySwitchDigits(long logN, long logQ, long logp, long logSlots, long dnum) {
+	cout << "!!! START TEST KEY SWITCH DIGITS !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Context context(logN, logQ, 3.2, 64, dnum);
+	SecretKey secretKey(logN);
+	timeutils.start("Keys generation");
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKey(secretKey, 1);
+	timeutils.stop("Keys generation");
+	cout << "logP: " << context.logP << ", rotation key bytes: " << scheme.rotKeyBytes() << endl;
+
+	timeutils.start("Keys writing and reading");
+	stringstream buffer;
+	SerializationUtils::writeContextBinary(context, buffer);
+	SerializationUtils::writeSchemeKeysBinary(scheme, buffer);
+	Context newcontext = SerializationUtils::readContextBinary(buffer);
+	Scheme newscheme(newcontext);
+	SerializationUtils::readSchemeKeysBinary(newscheme, buffer);
+	timeutils.stop("Keys writing and reading");
+	cout << "dnum of read context: " << newcontext.dnum << endl;
+	//-----------------------------------------
+	srand(time(NULL));
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	complex<double>* mvec1 = EvaluatorUtils::randomComplexArray(slots);
+	complex<double>* mvec2 = EvaluatorUtils::randomComplexArray(slots);
+
+	complex<double>* mvecMult = new complex<double>[slots];
+	complex<double>* mvecRot = new complex<double>[slots];
+	complex<double>* mvecConj = new complex<double>[slots];
+	for(long i = 0; i < slots; i++) {
+		mvecMult[i] = mvec1[i] * mvec2[i];
+		mvecRot[i] = mvec1[(i + 1) % slots];
+		mvecConj[i] = conj(mvec1[i]);
+	}
+
+	Ciphertext cipher1 = newscheme.encrypt(mvec1, slots, logp, logQ);
+	Ciphertext cipher2 = newscheme.encrypt(mvec2, slots, logp, logQ);
+
+	timeutils.start("Homomorphic Multiplication");
+	Ciphertext multCipher = newscheme.mult(cipher1, cipher2);
+	newscheme.reScaleByAndEqual(multCipher, logp);
+	timeutils.stop("Homomorphic Multiplication");
+
+	timeutils.start("Left rotation");
+	Ciphertext rotCipher = newscheme.leftRotateFast(cipher1, 1);
+	timeutils.stop("Left rotation");
+
+	timeutils.start("Conjugation");
+	Ciphertext conjCipher = newscheme.conjugate(cipher1);
+	timeutils.stop("Conjugation");
+
+	complex<double>* dvecMult = newscheme.decrypt(secretKey, multCipher);
+	complex<double>* dvecRot = newscheme.decrypt(secretKey, rotCipher);
+	complex<double>* dvecConj = newscheme.decrypt(secretKey, conjCipher);
+
+	StringUtils::showcompare(mvecMult, dvecMult, slots, "mult");
+	StringUtils::showcompare(mvecRot, dvecRot, slots, "rot");
+	StringUtils::showcompare(mvecConj, dvecConj, slots, "conj");
+
+	cout << "!!! END TEST KEY SWITCH DIGITS !!!" << endl;
+}
+
 //-----------------------------------------
 
 void TestScheme::testConjugateBatch(long logN, long logQ, long logp, long logSlots) {
@@ -279,6 +546,56 @@ void TestScheme::testRotateBatch(long logN, long logQ, long logp, long rotSlots,
 	cout << "!!! END TEST ROTATE BATCH !!!" << endl;
 }
 
+void TestScheme::testRotatePlanned(long logN, long logQ, long logp, long logSlots, long numRots, long maxKeys) {
+	cout << "!!! START TEST ROTATE PLANNED !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Context context(logN, logQ);
+	SecretKey secretKey(logN);
+	Scheme scheme(secretKey, context);
+	//-----------------------------------------
+	srand(time(NULL));
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	vector<long> rots;
+	for (long i = 0; i < numRots; ++i) {
+		rots.push_back(rand() % (2 * slots) - slots);
+	}
+
+	timeutils.start("Planned keys");
+	scheme.addPlannedRotKeys(secretKey, rots, maxKeys * scheme.rotKeyBytes());
+	timeutils.stop("Planned keys");
+
+	long switches = 0, binarySwitches = 0;
+	for (long rot : rots) {
+		long left = ((rot % slots) + slots) % slots;
+		switches += scheme.rotPlan->cost(left, slots);
+		for (; left != 0; left &= left - 1) {
+			binarySwitches++;
+		}
+	}
+	cout << "keys: " << scheme.rotPlan->keys.size() << " of " << maxKeys << endl;
+	cout << "key switches: " << switches << ", with power-of-two keys: " << binarySwitches << endl;
+
+	complex<double>* mvec = EvaluatorUtils::randomComplexArray(slots);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logp, logQ);
+
+	timeutils.start("Planned rotations");
+	for (long rot : rots) {
+		scheme.leftRotateAndEqual(cipher, ((rot % slots) + slots) % slots);
+	}
+	timeutils.stop("Planned rotations");
+
+	complex<double>* dvec = scheme.decrypt(secretKey, cipher);
+	for (long rot : rots) {
+		EvaluatorUtils::leftRotateAndEqual(mvec, slots, ((rot % slots) + slots) % slots);
+	}
+
+	StringUtils::showcompare(mvec, dvec, slots, "rot");
+
+	cout << "!!! END TEST ROTATE PLANNED !!!" << endl;
+}
+
 void TestScheme::testSlotsSum(long logN, long logQ, long logp, long logSlots) {
 	cout << "!!! START TEST SLOTS SUM !!!" << endl;
 	//-----------------------------------------
@@ -951,8 +1268,14 @@ void TestScheme::testWriteAndRead(long logN, long logQ, long logp, long logSlots
 
 	if(newcipher.ax != cipher.ax || newcipher.bx != cipher.bx || newcipher.logq != cipher.logq || newcipher.slots != cipher.slots || newcipher.logp != cipher.logp) {
 		cerr << "Write and Read for ciphertext does not work" << endl;
-		cout << "difference ax = " << newcipher.ax - cipher.ax << endl;
-		cout << "difference bx = " << newcipher.ax - cipher.bx << endl;
+		FlatPoly diff;
+		ZZX diffx;
+		Ring2Utils::sub(diff, newcipher.ax, cipher.ax, cipher.logq, context.N);
+		diff.toZZX(diffx);
+		cout << "difference ax = " << diffx << endl;
+		Ring2Utils::sub(diff, newcipher.bx, cipher.bx, cipher.logq, context.N);
+		diff.toZZX(diffx);
+		cout << "difference bx = " << diffx << endl;
 	} else {
 		cout << "Write and Read for ciphertext works well" << endl;
 	}
@@ -999,11 +1322,162 @@ void TestScheme::testWriteAndRead(long logN, long logQ, long logp, long logSlots
 
 	StringUtils::showcompare(dvec, newdvec, slots, "r&w");
 
+	Ciphertext cconj = scheme.conjugate(cipher);
+	Ciphertext newcconj = newscheme.conjugate(newcipher);
+
+	complex<double>* dconj = scheme.decrypt(secretKey, cconj);
+	complex<double>* newdconj = newscheme.decrypt(newsecretKey, newcconj);
+
+	StringUtils::showcompare(dconj, newdconj, slots, "r&w conj");
+
 	cout << "!!! END TEST WRITE AND READ !!!" << endl;
 }
 
 
-void TestScheme::testBootstrap(long logN, long logp, long logq, long logQ, long logSlots, long logT) {
+void TestScheme::testWriteAndReadBinary(long logN, long logQ, long logp, long logSlots) {
+	cout << "!!! START TEST WRITE AND READ BINARY !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Context context(logN, logQ);
+	SecretKey secretKey(logN);
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	//-----------------------------------------
+	srand(time(NULL));
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	complex<double>* mvec = EvaluatorUtils::randomComplexArray(slots);
+
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logp, logQ);
+
+	stringstream buffer;
+	timeutils.start("Write Ciphertext to buffer");
+	SerializationUtils::writeCiphertextBinary(cipher, buffer);
+	timeutils.stop("Write Ciphertext to buffer");
+	cout << "Ciphertext bytes: " << buffer.str().size() << endl;
+
+	timeutils.start("Read Ciphertext from buffer");
+	Ciphertext newcipher = SerializationUtils::readCiphertextBinary(buffer);
+	timeutils.stop("Read Ciphertext from buffer");
+
+	if(newcipher.ax != cipher.ax || newcipher.bx != cipher.bx || newcipher.logq != cipher.logq || newcipher.slots != cipher.slots || newcipher.logp != cipher.logp) {
+		cout << "Binary Write and Read for ciphertext does not work" << endl;
+	} else {
+		cout << "Binary Write and Read for ciphertext works well" << endl;
+	}
+
+	string contextPath = "testContext.bin";
+	string schemeKeysPath = "testSchemeKeys.bin";
+	ofstream contextOut(contextPath, ios::binary);
+	SerializationUtils::writeContextBinary(context, contextOut);
+	contextOut.close();
+
+	timeutils.start("Write Scheme");
+	ofstream keysOut(schemeKeysPath, ios::binary);
+	SerializationUtils::writeSchemeKeysBinary(scheme, keysOut);
+	keysOut.close();
+	timeutils.stop("Write Scheme");
+
+	ifstream contextIn(contextPath, ios::binary);
+	Context newcontext = SerializationUtils::readContextBinary(contextIn);
+	Scheme newscheme(newcontext);
+
+	timeutils.start("Read Scheme");
+	ifstream keysIn(schemeKeysPath, ios::binary);
+	SerializationUtils::readSchemeKeysBinary(newscheme, keysIn);
+	timeutils.stop("Read Scheme");
+
+	Ciphertext cconj = scheme.conjugate(cipher);
+	Ciphertext newcconj = newscheme.conjugate(newcipher);
+
+	complex<double>* dconj = scheme.decrypt(secretKey, cconj);
+	complex<double>* newdconj = newscheme.decrypt(secretKey, newcconj);
+
+	StringUtils::showcompare(dconj, newdconj, slots, "r&w conj");
+
+	cout << "!!! END TEST WRITE AND READ BINARY !!!" << endl;
+}
+
+
+void TestScheme::testRotationKeyStore(long logN, long logQ, long logp, long logSlots, long maxResident) {
+	cout << "!!! START TEST ROTATION KEY STORE !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Context context(logN, logQ);
+	SecretKey secretKey(logN);
+	Scheme scheme(secretKey, context);
+	//-----------------------------------------
+	timeutils.start("Left rotation keys generating");
+	scheme.addLeftRotKeys(secretKey);
+	timeutils.stop("Left rotation keys generated");
+
+	string storePath = "testRotationKeys.bin";
+	timeutils.start("Write rotation key store");
+	SerializationUtils::writeRotationKeyStore(scheme, storePath);
+	timeutils.stop("Write rotation key store");
+	//-----------------------------------------
+	srand(time(NULL));
+	//-----------------------------------------
+	Scheme storescheme(context);
+	timeutils.start("Open rotation key store");
+	storescheme.openRotationKeyStore(storePath, maxResident);
+	timeutils.stop("Open rotation key store");
+
+	long slots = (1 << logSlots);
+	complex<double>* mvec = EvaluatorUtils::randomComplexArray(slots);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logp, logQ);
+
+	for (long i = 0; i < logSlots; ++i) {
+		timeutils.start("Left rotate by 2^" + to_string(i) + " from store");
+		Ciphertext rot = storescheme.leftRotateByPo2(cipher, i);
+		timeutils.stop("Left rotate by 2^" + to_string(i) + " from store");
+
+		Ciphertext rotmap = scheme.leftRotateByPo2(cipher, i);
+
+		complex<double>* dvec = scheme.decrypt(secretKey, rotmap);
+		complex<double>* dstore = scheme.decrypt(secretKey, rot);
+		StringUtils::showcompare(dvec, dstore, slots, "store");
+		delete[] dvec;
+		delete[] dstore;
+	}
+	cout << "resident keys: " << storescheme.rotKeyStore->resident() << endl;
+
+	cout << "!!! END TEST ROTATION KEY STORE !!!" << endl;
+}
+
+
+void TestScheme::testBootContextCache(long logN, long logQ, long logSlots, long logp) {
+	cout << "!!! START TEST BOOT CONTEXT CACHE !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Context context(logN, logQ);
+	Context cachedcontext(logN, logQ);
+	//-----------------------------------------
+	timeutils.start("BootContext computing and caching");
+	SerializationUtils::addBootContextCached(context, logSlots, logp, ".");
+	timeutils.stop("BootContext computing and caching");
+
+	timeutils.start("BootContext reading from cache");
+	SerializationUtils::addBootContextCached(cachedcontext, logSlots, logp, ".");
+	timeutils.stop("BootContext reading from cache");
+
+	BootContext& bootContext = context.bootContextMap.at(logSlots);
+	BootContext& cachedBootContext = cachedcontext.bootContextMap.at(logSlots);
+	bool equal = bootContext.logp == cachedBootContext.logp && bootContext.p1 == cachedBootContext.p1 && bootContext.p2 == cachedBootContext.p2;
+	for (long i = 0; i < (1 << logSlots); ++i) {
+		equal = equal && bootContext.pvec[i] == cachedBootContext.pvec[i] && bootContext.pvecInv[i] == cachedBootContext.pvecInv[i];
+	}
+	if(equal) {
+		cout << "Cached BootContext works well" << endl;
+	} else {
+		cout << "Cached BootContext does not work" << endl;
+	}
+
+	cout << "!!! END TEST BOOT CONTEXT CACHE !!!" << endl;
+}
+
+
+void TestScheme::testBootstrap(long logN, long logp, long logq, long logQ, long logSlots, long logT, long numThreads) {
 	cout << "!!! START TEST BOOTSTRAP !!!" << endl;
 	//-----------------------------------------
 	TimeUtils timeutils;
@@ -1015,7 +1489,7 @@ void TestScheme::testBootstrap(long logN, long logp, long logq, long logQ, long
 	scheme.addBootKey(secretKey, logSlots, logq + 4);
 	timeutils.stop("Key generated");
 	//-----------------------------------------
-	SetNumThreads(1);
+	SetNumThreads(numThreads);
 	//-----------------------------------------
 	srand(time(NULL));
 	//-----------------------------------------
@@ -1110,3 +1584,113 @@ void TestScheme::testBootstrapSingleReal(long logN, long logp, long logq, long l
 	cout << "!!! END TEST BOOTSRTAP SINGLE REAL !!!" << endl;
 }
 
+
+
+//----------------------------------------------------------------------------------
+//   RNS TESTS
+//----------------------------------------------------------------------------------
+
+
+void TestScheme::testRNSBasic(long logN, long logq0, long logp, long L, long logSlots) {
+	cout << "!!! START TEST RNS BASIC !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	RNSContext context(logN, logq0, logp, L);
+	SecretKey secretKey(logN);
+	RNSScheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKeys(secretKey);
+	//-----------------------------------------
+	SetNumThreads(1);
+	//-----------------------------------------
+	srand(time(NULL));
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	long rotSlots = slots / 2 + 1;
+	complex<double>* mvec1 = EvaluatorUtils::randomComplexArray(slots);
+	complex<double>* mvec2 = EvaluatorUtils::randomComplexArray(slots);
+
+	complex<double>* mvecAdd = new complex<double>[slots];
+	complex<double>* mvecMult = new complex<double>[slots];
+	complex<double>* mvecConj = new complex<double>[slots];
+	complex<double>* mvecRot = new complex<double>[slots];
+	for(long i = 0; i < slots; i++) {
+		mvecAdd[i] = mvec1[i] + mvec2[i];
+		mvecMult[i] = mvec1[i] * mvec2[i];
+		mvecConj[i] = conj(mvec1[i]);
+		mvecRot[i] = mvec2[i];
+	}
+	EvaluatorUtils::leftRotateAndEqual(mvecRot, slots, rotSlots);
+
+	timeutils.start("Encrypt two batch");
+	RNSCiphertext cipher1 = scheme.encrypt(mvec1, slots, logp, L);
+	RNSCiphertext cipher2 = scheme.encrypt(mvec2, slots, logp, L);
+	timeutils.stop("Encrypt two batch");
+
+	timeutils.start("Homomorphic Addition");
+	RNSCiphertext addCipher = scheme.add(cipher1, cipher2);
+	timeutils.stop("Homomorphic Addition");
+
+	timeutils.start("Homomorphic Multiplication");
+	RNSCiphertext multCipher = scheme.mult(cipher1, cipher2);
+	scheme.reScaleByAndEqual(multCipher, 1);
+	timeutils.stop("Homomorphic Multiplication");
+
+	timeutils.start("Homomorphic Conjugation");
+	RNSCiphertext conjCipher = scheme.conjugate(cipher1);
+	timeutils.stop("Homomorphic Conjugation");
+
+	timeutils.start("Homomorphic Rotation");
+	RNSCiphertext rotCipher = scheme.leftRotate(cipher2, rotSlots);
+	timeutils.stop("Homomorphic Rotation");
+
+	timeutils.start("Decrypt batch");
+	complex<double>* dvecAdd = scheme.decrypt(secretKey, addCipher);
+	complex<double>* dvecMult = scheme.decrypt(secretKey, multCipher);
+	complex<double>* dvecConj = scheme.decrypt(secretKey, conjCipher);
+	complex<double>* dvecRot = scheme.decrypt(secretKey, rotCipher);
+	timeutils.stop("Decrypt batch");
+
+	StringUtils::showcompare(mvecAdd, dvecAdd, slots, "add");
+	StringUtils::showcompare(mvecMult, dvecMult, slots, "mult");
+	StringUtils::showcompare(mvecConj, dvecConj, slots, "conj");
+	StringUtils::showcompare(mvecRot, dvecRot, slots, "rot");
+
+	cout << "!!! END TEST RNS BASIC !!!" << endl;
+}
+
+void TestScheme::testRNSBootstrap(long logN, long logq0, long logp, long L, long logSlots, long nu, long logT, long numThreads) {
+	cout << "!!! START TEST RNS BOOTSTRAP !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	RNSContext context(logN, logq0, logp, L);
+	SecretKey secretKey(logN);
+	RNSScheme scheme(secretKey, context);
+	//-----------------------------------------
+	timeutils.start("Key generating");
+	scheme.addBootKey(secretKey, logSlots);
+	timeutils.stop("Key generated");
+	//-----------------------------------------
+	SetNumThreads(numThreads);
+	//-----------------------------------------
+	srand(time(NULL));
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	complex<double>* mvec = EvaluatorUtils::randomComplexArray(slots);
+
+	RNSCiphertext cipher = scheme.encrypt(mvec, slots, logq0 - nu, 1);
+
+	cout << "cipher l before: " << cipher.l << endl;
+
+	timeutils.start("Bootstrapping");
+	scheme.bootstrapAndEqual(cipher, logT);
+	timeutils.stop("Bootstrapping");
+
+	cout << "cipher l after: " << cipher.l << endl;
+
+	complex<double>* dvec = scheme.decrypt(secretKey, cipher);
+
+	StringUtils::showcompare(mvec, dvec, slots, "boot");
+
+	cout << "!!! END TEST RNS BOOTSTRAP !!!" << endl;
+}
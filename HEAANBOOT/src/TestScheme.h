@@ -37,6 +37,50 @@ public:
 	 */
 	static void testEncodeSingle(long logN, long logQ, long logp);
 
+	/**
+	 * Testing encryption timing with a pool of precomputed encryptions of zero
+	 * c(m_1, ..., m_slots)
+	 * number of modulus bits down: 0
+	 * @param[in] logN: input parameter for Params class
+	 * @param[in] logQ: input parameter for Params class
+	 * @param[in] logp: log of precision
+	 * @param[in] logSlots: log of number of slots
+	 * @param[in] poolSize: number of pooled encryptions
+	 * @param[in] poolThreads: number of refill threads
+	 */
+	static void testEncryptionPool(long logN, long logQ, long logp, long logSlots, long poolSize, long poolThreads);
+
+	/**
+	 * Testing encoding and decoding timing of many arrays at once against one at a time
+	 * number of modulus bits down: 0
+	 * @param[in] logN: input parameter for Params class
+	 * @param[in] logQ: input parameter for Params class
+	 * @param[in] logp: log of precision
+	 * @param[in] logSlots: log of number of slots
+	 * @param[in] count: number of arrays
+	 * @param[in] numThreads: number of threads
+	 */
+	static void testEncodeMany(long logN, long logQ, long logp, long logSlots, long count, long numThreads);
+
+	/**
+	 * Testing timing, statistics and reproducibility of samplers
+	 * @param[in] logN: input parameter for Params class
+	 * @param[in] logQ: input parameter for Params class
+	 * @param[in] numThreads: number of threads
+	 */
+	static void testSampler(long logN, long logQ, long numThreads);
+
+	/**
+	 * Testing secret key encryption with seeded ax and its compact serialization
+	 * c(m_1, ..., m_slots)
+	 * number of modulus bits down: 0
+	 * @param[in] logN: input parameter for Params class
+	 * @param[in] logQ: input parameter for Params class
+	 * @param[in] logp: log of precision
+	 * @param[in] logSlots: log of number of slots
+	 */
+	static void testEncryptSymmetric(long logN, long logQ, long logp, long logSlots);
+
 	/**
 	 * Testing encoding, decoding, add, and mult timing of the ciphertext
 	 * c(m_1, ..., m_slots)
@@ -47,6 +91,17 @@ public:
 	 */
 	static void testBasic(long logN, long logQ, long logp, long logSlot);
 
+	/**
+	 * Testing mult, rotation and conjugation timing with key switching over dnum digits,
+	 * with context and keys written and read back in binary format
+	 * @param[in] logN: input parameter for Params class
+	 * @param[in] logQ: input parameter for Params class
+	 * @param[in] logp: log of precision
+	 * @param[in] logSlots: log of number of slots
+	 * @param[in] dnum: number of digits in key switching
+	 */
+	static void testKeySwitchDigits(long logN, long logQ, long logp, long logSlots, long dnum);
+
 	/**
 	 * Testing conjugation timing of the ciphertext
 	 * c(m_1, ..., m_slots) -> c(conjugate(m_1), ...,conjugate(m_slots))
@@ -95,6 +150,19 @@ public:
 	 */
 	static void testRotateBatch(long logN, long logQ, long logp, long rotSlots, long logSlots, bool isLeft);
 
+	/**
+	 * Testing rotations by random amounts with planned keys,
+	 * compared with the power-of-two keys in number of key switches
+	 * number of modulus bits down: 0
+	 * @param[in] logN: input parameter for Params class
+	 * @param[in] logQ: input parameter for Params class
+	 * @param[in] logp: log of precision
+	 * @param[in] logSlots: log of number of slots
+	 * @param[in] numRots: number of rotation amounts
+	 * @param[in] maxKeys: memory budget in rotation keys
+	 */
+	static void testRotatePlanned(long logN, long logQ, long logp, long logSlots, long numRots, long maxKeys);
+
 	/**
 	 * Testing slot summation timing in the ciphertext
 	 * c(m_1, ..., m_slots) -> c(sum(m_i), sum(m_i), ..., sum(m_i))
@@ -290,12 +358,40 @@ public:
 	 */
 	static void testWriteAndRead(long logN, long logQ, long logp, long logSlots);
 
+	/**
+	 * Testing binary Write and Read functions for Ciphertext, Context and Scheme keys
+	 * @param[in] logN: input parameter for Params class
+	 * @param[in] logQ: input parameter for Params class
+	 * @param[in] logp: log of precision
+	 * @param[in] logSlots: log of number of slots
+	 */
+	static void testWriteAndReadBinary(long logN, long logQ, long logp, long logSlots);
+
+	/**
+	 * Testing left rotations with keys loaded on first use from a rotation key store
+	 * @param[in] logN: input parameter for Params class
+	 * @param[in] logQ: input parameter for Params class
+	 * @param[in] logp: log of precision
+	 * @param[in] logSlots: log of number of slots
+	 * @param[in] maxResident: maximum number of loaded keys, 0 for no bound
+	 */
+	static void testRotationKeyStore(long logN, long logQ, long logp, long logSlots, long maxResident);
+
 
 	//----------------------------------------------------------------------------------
 	//   BOOTSTRAPPING TESTS
 	//----------------------------------------------------------------------------------
 
 
+	/**
+	 * Testing BootContext computed once and then read from file cache in working directory
+	 * @param[in] logN: input parameter for Params class
+	 * @param[in] logQ: input parameter for Params class
+	 * @param[in] logSlots: log of number of slots
+	 * @param[in] logp: log of precision of encoded diagonals
+	 */
+	static void testBootContextCache(long logN, long logQ, long logSlots, long logp);
+
 	/**
 	 * Testing bootstrapping procedure
 	 * number of modulus bits up: depends on parameters
@@ -305,8 +401,9 @@ public:
 	 * @param[in] logSlots: log of number of slots
 	 * @param[in] nu: auxiliary parameter, corresonds to message bits (message bits is logq - nu)
 	 * @param[in] logT: auxiliary parameter, corresponds to number of iterations in removeIpart (num of iterations is logI + logT)
+	 * @param[in] numThreads: number of threads of bootstrapping after key generation
 	 */
-	static void testBootstrap(long logN, long logq, long logQ, long logSlots, long nu, long logT);
+	static void testBootstrap(long logN, long logq, long logQ, long logSlots, long nu, long logT, long numThreads);
 
 	/**
 	 * Testing bootstrapping procedure for single real value
@@ -319,6 +416,35 @@ public:
 	 */
 	static void testBootstrapSingleReal(long logN, long logq, long logQ, long nu, long logT);
 
+
+	//----------------------------------------------------------------------------------
+	//   RNS TESTS
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * Testing encoding, decoding, add, mult, rotate and conjugate timing of the RNS backend
+	 * @param[in] logN: log of ring dimension
+	 * @param[in] logq0: bit size of base prime
+	 * @param[in] logp: bit size of rescaling primes
+	 * @param[in] L: number of primes in the chain
+	 * @param[in] logSlots: log of number of slots
+	 */
+	static void testRNSBasic(long logN, long logq0, long logp, long L, long logSlots);
+
+	/**
+	 * Testing bootstrapping procedure of the RNS backend
+	 * @param[in] logN: log of ring dimension
+	 * @param[in] logq0: bit size of base prime
+	 * @param[in] logp: bit size of rescaling primes
+	 * @param[in] L: number of primes in the chain
+	 * @param[in] logSlots: log of number of slots
+	 * @param[in] nu: auxiliary parameter, corresonds to message bits (message bits is logq0 - nu)
+	 * @param[in] logT: auxiliary parameter, corresponds to number of iterations in removeIpart (num of iterations is logI + logT)
+	 * @param[in] numThreads: number of threads of bootstrapping after key generation
+	 */
+	static void testRNSBootstrap(long logN, long logq0, long logp, long L, long logSlots, long nu, long logT, long numThreads);
+
 };
 
 #endif
@@ -0,0 +1,271 @@
+/*
+* Copyright (c) by CryptoLab inc.
+* This program is licensed under a
+* Creative Commons Attribution-NonCommercial 3.0 Unported License.
+* You should have received a copy of the license along with this
+* work.  If not, see <http://creativecommons.org/licenses/by-nc/3.0/>.
+*/
+#ifndef HEAAN_WORDUTILS_H_
+#define HEAAN_WORDUTILS_H_
+
+#include <NTL/ZZ.h>
+#include <cstdint>
+
+using namespace std;
+using namespace NTL;
+
+/**
+ * number of 64-bit limbs for coefficients of given bit size, e.g. limbsFor(logQQ)
+ */
+constexpr long limbsFor(const long bits) {
+	return (bits + 63) / 64;
+}
+
+/**
+ * Kernels on a single coefficient of limbs 64-bit words, least significant word first,
+ * in two's complement mod 2^(64 limbs), as stored in FlatPoly.
+ */
+class WordUtils {
+public:
+
+
+	//----------------------------------------------------------------------------------
+	//   ADDITION & SUBSTRACTION
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * r = a + b mod 2^(64 limbs), r may alias a or b
+	 */
+	static inline void addWords(uint64_t* r, const uint64_t* a, const uint64_t* b, const long limbs) {
+		uint64_t carry = 0;
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t s = a[k] + carry;
+			carry = s < carry;
+			uint64_t t = s + b[k];
+			carry += t < s;
+			r[k] = t;
+		}
+	}
+
+	/**
+	 * r = a - b mod 2^(64 limbs), r may alias a or b
+	 */
+	static inline void subWords(uint64_t* r, const uint64_t* a, const uint64_t* b, const long limbs) {
+		uint64_t borrow = 0;
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t s = a[k] - borrow;
+			borrow = a[k] < borrow;
+			borrow += s < b[k];
+			r[k] = s - b[k];
+		}
+	}
+
+	/**
+	 * r = -a mod 2^(64 limbs), r may alias a
+	 */
+	static inline void negateWords(uint64_t* r, const uint64_t* a, const long limbs) {
+		uint64_t borrow = 0;
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t s = 0 - a[k] - borrow;
+			borrow = (a[k] | borrow) != 0;
+			r[k] = s;
+		}
+	}
+
+
+	//----------------------------------------------------------------------------------
+	//   MODULUS & SHIFTS
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * r = r mod 2^logq
+	 */
+	static inline void maskWords(uint64_t* r, const long logq, const long limbs) {
+		long k = logq >> 6;
+		if(k >= limbs) return;
+		long b = logq & 63;
+		r[k] &= b ? ((uint64_t) 1 << b) - 1 : 0;
+		for (++k; k < limbs; ++k) {
+			r[k] = 0;
+		}
+	}
+
+	/**
+	 * r = r as signed number of given bit size, extended to 64 limbs bits
+	 */
+	static inline void signExtendWords(uint64_t* r, const long bits, const long limbs) {
+		long k = (bits - 1) >> 6;
+		if(k >= limbs) return;
+		long b = (bits - 1) & 63;
+		if((r[k] >> b) & 1) {
+			r[k] |= b == 63 ? 0 : ~(((uint64_t) 1 << (b + 1)) - 1);
+			for (++k; k < limbs; ++k) {
+				r[k] = ~((uint64_t) 0);
+			}
+		}
+	}
+
+	/**
+	 * r = a with alimbs words truncated or zero-extended to rlimbs words
+	 */
+	static inline void copyWords(uint64_t* r, const long rlimbs, const uint64_t* a, const long alimbs) {
+		long k = 0;
+		for (; k < rlimbs && k < alimbs; ++k) {
+			r[k] = a[k];
+		}
+		for (; k < rlimbs; ++k) {
+			r[k] = 0;
+		}
+	}
+
+	/**
+	 * r = a << bits mod 2^(64 limbs), r may alias a
+	 */
+	static inline void leftShiftWords(uint64_t* r, const uint64_t* a, const long bits, const long limbs) {
+		long ws = bits >> 6;
+		long bs = bits & 63;
+		for (long k = limbs - 1; k >= 0; --k) {
+			long src = k - ws;
+			uint64_t hi = src >= 0 ? a[src] << bs : 0;
+			uint64_t lo = (bs && src >= 1) ? a[src - 1] >> (64 - bs) : 0;
+			r[k] = hi | lo;
+		}
+	}
+
+	/**
+	 * r = a >> bits for unsigned a of alimbs words, truncated to rlimbs words, r may alias a
+	 */
+	static inline void rightShiftWords(uint64_t* r, const long rlimbs, const uint64_t* a, const long alimbs, const long bits) {
+		long ws = bits >> 6;
+		long bs = bits & 63;
+		for (long k = 0; k < rlimbs; ++k) {
+			long src = k + ws;
+			uint64_t lo = src < alimbs ? a[src] >> bs : 0;
+			uint64_t hi = (bs && src + 1 < alimbs) ? a[src + 1] << (64 - bs) : 0;
+			r[k] = lo | hi;
+		}
+	}
+
+
+	//----------------------------------------------------------------------------------
+	//   MULTIPLICATION
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * r = r + a * w mod 2^(64 rlimbs) for a of alimbs words
+	 */
+	static inline void mulAddWord(uint64_t* r, const long rlimbs, const uint64_t* a, const long alimbs, const uint64_t w) {
+		uint64_t carry = 0;
+		long len = alimbs < rlimbs ? alimbs : rlimbs;
+		long k = 0;
+		for (; k < len; ++k) {
+			unsigned __int128 t = (unsigned __int128) a[k] * w + r[k] + carry;
+			r[k] = (uint64_t) t;
+			carry = (uint64_t) (t >> 64);
+		}
+		for (; carry && k < rlimbs; ++k) {
+			r[k] += carry;
+			carry = r[k] < carry;
+		}
+	}
+
+	/**
+	 * r = r - a * w mod 2^(64 rlimbs) for a of alimbs words
+	 */
+	static inline void mulSubWord(uint64_t* r, const long rlimbs, const uint64_t* a, const long alimbs, const uint64_t w) {
+		uint64_t borrow = 0;
+		long len = alimbs < rlimbs ? alimbs : rlimbs;
+		long k = 0;
+		for (; k < len; ++k) {
+			unsigned __int128 t = (unsigned __int128) a[k] * w + borrow;
+			uint64_t lo = (uint64_t) t;
+			borrow = (uint64_t) (t >> 64) + (r[k] < lo);
+			r[k] -= lo;
+		}
+		for (; borrow && k < rlimbs; ++k) {
+			uint64_t s = r[k];
+			r[k] = s - borrow;
+			borrow = s < borrow;
+		}
+	}
+
+	/**
+	 * r = a * b mod 2^(64 limbs), r must not alias a or b
+	 */
+	static inline void mulWords(uint64_t* r, const uint64_t* a, const uint64_t* b, const long limbs) {
+		for (long k = 0; k < limbs; ++k) {
+			r[k] = 0;
+		}
+		for (long k = 0; k < limbs; ++k) {
+			if(b[k]) {
+				mulAddWord(r + k, limbs - k, a, limbs - k, b[k]);
+			}
+		}
+	}
+
+
+	//----------------------------------------------------------------------------------
+	//   CONVERSIONS
+	//----------------------------------------------------------------------------------
+
+
+	/**
+	 * sign of a in two's complement
+	 */
+	static inline bool isNegative(const uint64_t* a, const long limbs) {
+		return limbs > 0 && (a[limbs - 1] >> 63);
+	}
+
+	/**
+	 * bit size of |a| for a in two's complement, may exceed it by one for negative a
+	 */
+	static inline long bitLength(const uint64_t* a, const long limbs) {
+		uint64_t mask = isNegative(a, limbs) ? ~((uint64_t) 0) : 0;
+		for (long k = limbs - 1; k >= 0; --k) {
+			uint64_t w = a[k] ^ mask;
+			if(w) {
+				return 64 * k + 64 - __builtin_clzll(w) + (mask & 1);
+			}
+		}
+		return mask & 1;
+	}
+
+	/**
+	 * r = x mod 2^(64 limbs) in two's complement
+	 */
+	static inline void fromZZ(uint64_t* r, const ZZ& x, const long limbs) {
+		unsigned char* bytes = (unsigned char*) r;
+		BytesFromZZ(bytes, x, 8 * limbs);
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t w = 0;
+			for (long b = 7; b >= 0; --b) {
+				w = (w << 8) | bytes[8 * k + b];
+			}
+			r[k] = w;
+		}
+		if(sign(x) < 0) {
+			negateWords(r, r, limbs);
+		}
+	}
+
+	/**
+	 * x = a as unsigned number
+	 * @param[in] bytes: scratch of 8 limbs bytes
+	 */
+	static inline void toZZ(ZZ& x, const uint64_t* a, const long limbs, unsigned char* bytes) {
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t w = a[k];
+			for (long b = 0; b < 8; ++b) {
+				bytes[8 * k + b] = (unsigned char) w;
+				w >>= 8;
+			}
+		}
+		ZZFromBytes(x, bytes, 8 * limbs);
+	}
+
+};
+
+#endif